@@ -0,0 +1,254 @@
+#ifndef ADJACENCY_RANGES_H
+#define ADJACENCY_RANGES_H
+
+#include <iterator> // std::forward_iterator_tag
+#include <utility>  // std::pair
+#include <stddef.h> // ptrdiff_t
+#include <stdint.h> // uint64_t
+
+/**
+ * @file adjacency_ranges.h
+ * @brief Iteratori e intervalli sugli archi delle politiche di memorizzazione
+ */
+
+/**
+ * @brief Intervallo [begin, end) utilizzabile in un range-based for
+ *
+ * @tparam Iterator Tipo degli iteratori
+ */
+template <typename Iterator>
+class iterator_range
+{
+    Iterator _begin;
+    Iterator _end;
+
+public:
+    typedef Iterator iterator;
+
+    iterator_range(const Iterator &begin, const Iterator &end) : _begin(begin), _end(end){};
+
+    Iterator begin() const
+    {
+        return _begin;
+    };
+
+    Iterator end() const
+    {
+        return _end;
+    };
+
+    bool empty() const
+    {
+        return _begin == _end;
+    };
+};
+
+/**
+ * @brief Iteratore sulle posizioni dei bit a 1 di una sequenza di parole
+ *
+ * Salta le parole a zero e trova il bit successivo con count-trailing-zeros,
+ * quindi visitare una riga costa O(parole + bit a 1).
+ */
+class bit_iterator
+{
+    const uint64_t *_words; ///< Parole da visitare
+    unsigned int _word;     ///< Parola corrente
+    unsigned int _count;    ///< Numero di parole
+    uint64_t _bits;         ///< Bit ancora da visitare nella parola corrente
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef unsigned int value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const unsigned int *pointer;
+    typedef unsigned int reference;
+
+    /**
+     * @brief Costruttore di default (iteratore di fine vuoto)
+     */
+    bit_iterator() : _words(nullptr), _word(0), _count(0), _bits(0){};
+
+    /**
+     * @brief Costruttore di inizializzazione
+     *
+     * @param words Parole da visitare
+     * @param count Numero di parole
+     * @param end true per ottenere l'iteratore di fine
+     */
+    bit_iterator(const uint64_t *words, unsigned int count, bool end = false)
+        : _words(words), _word(end ? count : 0), _count(count), _bits(0)
+    {
+        if (!end && count != 0)
+        {
+            _bits = words[0];
+            skipEmpty();
+        }
+    };
+
+    /**
+     * @brief Posizione del bit corrente
+     */
+    unsigned int operator*() const
+    {
+        return _word * 64 + countTrailingZeros(_bits);
+    };
+
+    bit_iterator &operator++()
+    {
+        _bits &= _bits - 1;
+        skipEmpty();
+        return *this;
+    };
+
+    bit_iterator operator++(int)
+    {
+        bit_iterator tmp(*this);
+        ++*this;
+        return tmp;
+    };
+
+    bool operator==(const bit_iterator &other) const
+    {
+        return _word == other._word && _bits == other._bits;
+    };
+
+    bool operator!=(const bit_iterator &other) const
+    {
+        return !(*this == other);
+    };
+
+    /**
+     * @brief Posizione del bit meno significativo a 1
+     *
+     * @pre word != 0
+     */
+    static unsigned int countTrailingZeros(uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        unsigned int count = 0;
+        while ((word & 1) == 0)
+        {
+            word >>= 1;
+            count++;
+        }
+        return count;
+#endif
+    };
+
+private:
+    /**
+     * @brief Passa alla prima parola non vuota se la corrente è esaurita
+     */
+    void skipEmpty()
+    {
+        while (_bits == 0 && ++_word < _count)
+        {
+            _bits = _words[_word];
+        }
+        if (_bits == 0)
+        {
+            _word = _count;
+        }
+    };
+};
+
+/**
+ * @brief Iteratore su tutti gli archi di una politica di memorizzazione
+ *
+ * Visita le righe in ordine e, per ognuna, i successori restituiti da
+ * Storage::successors. Il valore è la coppia (origine, destinazione).
+ *
+ * @tparam Storage Politica di memorizzazione (dense_bitset, sparse_adjacency)
+ */
+template <typename Storage>
+class edge_iterator
+{
+    typedef typename Storage::successor_range::iterator inner_iterator;
+
+    const Storage *_storage; ///< Archi da visitare
+    unsigned int _row;       ///< Riga corrente
+    inner_iterator _it;      ///< Successore corrente nella riga
+    inner_iterator _end;     ///< Fine della riga corrente
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::pair<unsigned int, unsigned int> value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const value_type *pointer;
+    typedef value_type reference;
+
+    /**
+     * @brief Costruttore di default
+     */
+    edge_iterator() : _storage(nullptr), _row(0), _it(), _end(){};
+
+    /**
+     * @brief Costruttore di inizializzazione
+     *
+     * @param storage Archi da visitare
+     * @param row Riga di partenza (storage->size() per la fine)
+     */
+    edge_iterator(const Storage *storage, unsigned int row) : _storage(storage), _row(row), _it(), _end()
+    {
+        if (_row < _storage->size())
+        {
+            _it = _storage->successors(_row).begin();
+            _end = _storage->successors(_row).end();
+            skipEmpty();
+        }
+    };
+
+    value_type operator*() const
+    {
+        return value_type(_row, *_it);
+    };
+
+    edge_iterator &operator++()
+    {
+        ++_it;
+        skipEmpty();
+        return *this;
+    };
+
+    edge_iterator operator++(int)
+    {
+        edge_iterator tmp(*this);
+        ++*this;
+        return tmp;
+    };
+
+    bool operator==(const edge_iterator &other) const
+    {
+        if (_row != other._row)
+        {
+            return false;
+        }
+        return _row == _storage->size() || _it == other._it;
+    };
+
+    bool operator!=(const edge_iterator &other) const
+    {
+        return !(*this == other);
+    };
+
+private:
+    /**
+     * @brief Passa alla prima riga non vuota se la corrente è esaurita
+     */
+    void skipEmpty()
+    {
+        while (_it == _end)
+        {
+            if (++_row == _storage->size())
+            {
+                return;
+            }
+            _it = _storage->successors(_row).begin();
+            _end = _storage->successors(_row).end();
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,300 @@
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include <mutex>
+#include <new>         // std::bad_alloc
+#include <type_traits> // std::true_type
+#include <stddef.h>    // size_t
+#include <stdint.h>    // uintptr_t
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+
+/**
+ * @file arena_allocator.h
+ * @brief Arena a crescita monotona e allocatore standard che la usa
+ *
+ * Pensata per i graph di breve durata: tutta la memoria di un graph (nodi,
+ * matrice, indice dei nomi) e dei suoi temporanei viene presa da un'unica
+ * regione, con un incremento di puntatore per allocazione e nessuna
+ * chiamata a malloc finché il blocco corrente basta. La memoria viene
+ * restituita tutta insieme da release() o dal distruttore dell'arena.
+ *
+ * Con C++17 arena è anche una std::pmr::memory_resource, quindi si può
+ * passare a un std::pmr::polymorphic_allocator.
+ */
+
+/**
+ * @brief Regione di memoria a crescita monotona
+ *
+ * Le allocazioni avanzano un cursore nel blocco corrente; quando il blocco
+ * è esaurito ne viene chiesto uno nuovo, almeno doppio del precedente, a
+ * operator new. deallocate recupera lo spazio solo se il blocco liberato è
+ * l'ultimo allocato (come in una pila): così i temporanei e le
+ * riallocazioni per raddoppio non consumano la regione.
+ *
+ * Le operazioni sono protette da un mutex, perché alcune strutture
+ * allocano anche in lettura (per esempio la vista trasposta di
+ * dense_bitset); per evitare contesa conviene un'arena per thread o per
+ * richiesta. Non è copiabile e deve sopravvivere a tutto ciò che vi alloca.
+ */
+class arena
+#if __cplusplus >= 201703L
+    : public std::pmr::memory_resource
+#endif
+{
+    /**
+     * @brief Intestazione di un blocco ottenuto da operator new
+     */
+    struct block
+    {
+        block *next; ///< Blocco precedente
+        size_t size; ///< Byte del blocco, intestazione compresa
+    };
+
+    block *_blocks;        ///< Ultimo blocco ottenuto da operator new
+    char *_cursor;         ///< Primo byte libero del blocco corrente
+    char *_end;            ///< Fine del blocco corrente
+    char *_last;           ///< Inizio dell'ultima allocazione, per deallocate
+    char *_buffer;         ///< Buffer esterno iniziale, nullptr se assente
+    size_t _bufferSize;    ///< Byte del buffer esterno
+    size_t _nextBlockSize; ///< Byte del prossimo blocco da chiedere
+    size_t _used;          ///< Byte consegnati e non recuperati
+    mutable std::mutex _mutex;  ///< Serializza le operazioni
+
+    arena(const arena &);
+    arena &operator=(const arena &);
+
+public:
+    /**
+     * @brief Costruttore
+     *
+     * Nessuna memoria viene chiesta finché non serve
+     *
+     * @param blockSize Byte del primo blocco
+     */
+    explicit arena(size_t blockSize = 64 * 1024)
+        : _blocks(nullptr), _cursor(nullptr), _end(nullptr), _last(nullptr), _buffer(nullptr),
+          _bufferSize(0), _nextBlockSize(blockSize < 256 ? 256 : blockSize), _used(0), _mutex(){};
+
+    /**
+     * @brief Costruttore con buffer esterno
+     *
+     * Le prime allocazioni usano buffer (per esempio un array sullo stack);
+     * quando non basta si passa a blocchi chiesti a operator new. Il buffer
+     * non viene mai liberato dall'arena.
+     *
+     * @param buffer Memoria da usare per prima
+     * @param size Byte di buffer
+     */
+    arena(void *buffer, size_t size)
+        : _blocks(nullptr), _cursor(static_cast<char *>(buffer)),
+          _end(static_cast<char *>(buffer) + size), _last(nullptr), _buffer(static_cast<char *>(buffer)),
+          _bufferSize(size), _nextBlockSize(size < 256 ? 512 : size * 2), _used(0), _mutex(){};
+
+    /**
+     * @brief Distruttore della classe
+     *
+     * Libera tutti i blocchi chiesti a operator new
+     */
+    ~arena()
+    {
+        freeBlocks();
+    };
+
+    /**
+     * @brief Alloca bytes byte allineati ad alignment
+     *
+     * @param bytes Byte da allocare
+     * @param alignment Allineamento, potenza di 2
+     *
+     * @return Puntatore alla memoria allocata
+     */
+    void *allocate(size_t bytes, size_t alignment = alignof(max_align_t))
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        char *p = align(_cursor, alignment);
+        if (_cursor == nullptr || p + bytes > _end || p + bytes < p)
+        {
+            grow(bytes + alignment);
+            p = align(_cursor, alignment);
+        }
+        _cursor = p + bytes;
+        _last = p;
+        _used += bytes;
+        return p;
+    };
+
+    /**
+     * @brief Restituisce la memoria di un'allocazione
+     *
+     * Lo spazio viene recuperato solo se p è l'ultima allocazione;
+     * altrimenti resta occupato fino a release()
+     *
+     * @param p Puntatore restituito da allocate
+     * @param bytes Byte richiesti ad allocate
+     */
+    void deallocate(void *p, size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (p != nullptr && static_cast<char *>(p) == _last && _last + bytes == _cursor)
+        {
+            _cursor = _last;
+            _last = nullptr;
+            _used -= bytes;
+        }
+    };
+
+    /**
+     * @brief Libera tutta la memoria dell'arena
+     *
+     * Tutto ciò che vi era allocato diventa non valido; l'arena torna a
+     * usare il buffer esterno, se c'è, altrimenti il prossimo blocco.
+     */
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        freeBlocks();
+        _cursor = _buffer;
+        _end = _buffer == nullptr ? nullptr : _buffer + _bufferSize;
+        _last = nullptr;
+        _used = 0;
+    };
+
+    /**
+     * @brief Byte consegnati dalle allocazioni e non ancora recuperati
+     */
+    size_t used() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _used;
+    };
+
+#if __cplusplus >= 201703L
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        return allocate(bytes, alignment);
+    };
+
+    void do_deallocate(void *p, size_t bytes, size_t) override
+    {
+        deallocate(p, bytes);
+    };
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    };
+#endif
+
+private:
+    static char *align(char *p, size_t alignment)
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char *>((address + alignment - 1) & ~(uintptr_t(alignment) - 1));
+    };
+
+    /**
+     * @brief Passa a un nuovo blocco di almeno bytes byte utili
+     */
+    void grow(size_t bytes)
+    {
+        size_t size = _nextBlockSize;
+        while (size < bytes + sizeof(block))
+        {
+            size *= 2;
+        }
+        block *b = static_cast<block *>(::operator new(size));
+        b->next = _blocks;
+        b->size = size;
+        _blocks = b;
+        _cursor = reinterpret_cast<char *>(b + 1);
+        _end = reinterpret_cast<char *>(b) + size;
+        _last = nullptr;
+        _nextBlockSize = size * 2;
+    };
+
+    void freeBlocks()
+    {
+        while (_blocks != nullptr)
+        {
+            block *next = _blocks->next;
+            ::operator delete(_blocks);
+            _blocks = next;
+        }
+    };
+};
+
+/**
+ * @brief Allocatore standard che prende la memoria da un'arena
+ *
+ * Tutte le copie, anche con altro value_type, usano la stessa arena e si
+ * propagano con i contenitori (copia, spostamento e swap), così un graph e
+ * le sue copie restano nella regione da cui sono partiti.
+ *
+ * @tparam T Tipo degli oggetti allocati
+ */
+template <typename T>
+class arena_allocator
+{
+    arena *_arena; ///< Arena da cui allocare
+
+    template <typename U>
+    friend class arena_allocator;
+
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    /**
+     * @brief Costruttore
+     *
+     * @param region Arena da cui allocare
+     */
+    arena_allocator(arena &region) : _arena(&region){};
+
+    /**
+     * @brief Costruttore di conversione da un allocatore di altro tipo
+     */
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &other) : _arena(other._arena){};
+
+    T *allocate(size_t n)
+    {
+        if (n > size_t(-1) / sizeof(T))
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(_arena->allocate(n * sizeof(T), alignof(T)));
+    };
+
+    void deallocate(T *p, size_t n)
+    {
+        _arena->deallocate(p, n * sizeof(T));
+    };
+
+    /**
+     * @brief Arena usata dall'allocatore
+     */
+    arena &region() const
+    {
+        return *_arena;
+    };
+
+    template <typename U>
+    bool operator==(const arena_allocator<U> &other) const
+    {
+        return _arena == other._arena;
+    };
+
+    template <typename U>
+    bool operator!=(const arena_allocator<U> &other) const
+    {
+        return _arena != other._arena;
+    };
+};
+
+#endif
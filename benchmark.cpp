@@ -0,0 +1,439 @@
+/**
+ * @file benchmark.cpp
+ * @brief Misura delle prestazioni delle operazioni di graph
+ *
+ * Per ogni tipo di nome (int, std::string, struct), per ogni storage
+ * (dense_bitset, sparse_adjacency) e per N da 10^2 a 10^5 misura addNode,
+ * addEdge, hasEdge, exists, l'iterazione su nodi e archi, la copia, la
+ * conversione verso l'altro storage e removeNode, più la conversione di
+ * graph<char> in graph<int>. Ogni configurazione gira in un processo figlio, così il picco
+ * di memoria (RSS) è solo il suo e un'allocazione fallita non ferma le
+ * altre misure.
+ *
+ * L'uscita è CSV su stdout, una riga per operazione:
+ *
+ *     type,storage,n,op,ops,ns_per_op,allocs_per_op,bytes_per_op,peak_rss_kb
+ *
+ * Uso: bench.exe [N massimo] [MB massimi della matrice densa]
+ * Le configurazioni dense con una matrice più grande del limite (default
+ * 256 MB, cioè circa N = 46000) vengono saltate.
+ */
+
+#include "graph.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <stddef.h>       // size_t
+#include <sys/resource.h> // getrusage
+#include <sys/wait.h>     // waitpid
+#include <unistd.h>       // fork
+
+static unsigned long long allocations = 0;     ///< Chiamate a operator new
+static unsigned long long allocated_bytes = 0; ///< Byte richiesti a operator new
+
+/**
+ * @brief Allocazione contata, usata da tutte le forme di operator new
+ */
+static void *countedAllocate(size_t size)
+{
+    allocations++;
+    allocated_bytes += size;
+    void *p = std::malloc(size != 0 ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// Le sostituzioni non vanno espanse nel chiamante: GCC vedrebbe malloc e
+// free accoppiati a new e delete e segnalerebbe -Wmismatched-new-delete.
+// Tutte le forme, singole e array, con e senza dimensione, sono sostituite
+// esplicitamente, così nessuna passa dall'allocatore della libreria
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    return countedAllocate(size);
+}
+
+__attribute__((noinline)) void *operator new[](size_t size)
+{
+    return countedAllocate(size);
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief Nome di nodo con due campi, come obj_test in main.cpp
+ */
+struct bench_node
+{
+    int i;
+    double d;
+};
+
+/**
+ * @brief Funtore di hash per bench_node
+ */
+struct bench_node_hash
+{
+    size_t operator()(const bench_node &node) const
+    {
+        return std::hash<int>()(node.i) ^ (std::hash<double>()(node.d) << 1);
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza per bench_node
+ */
+struct bench_node_equal
+{
+    bool operator()(const bench_node &first, const bench_node &second) const
+    {
+        return first.i == second.i && first.d == second.d;
+    }
+};
+
+/**
+ * @brief Nome dell'i-esimo nodo
+ *
+ * Le stringhe sono più lunghe del buffer interno di std::string, così ogni
+ * nome alloca come nei casi reali
+ */
+static void makeName(unsigned int i, int &name)
+{
+    name = static_cast<int>(i);
+}
+
+static void makeName(unsigned int i, std::string &name)
+{
+    name = "vertice_numero_" + std::to_string(i);
+}
+
+static void makeName(unsigned int i, bench_node &name)
+{
+    name.i = static_cast<int>(i);
+    name.d = i * 0.5;
+}
+
+/**
+ * @brief Misure accumulate di un'operazione
+ */
+struct measure
+{
+    const char *op;                 ///< Nome dell'operazione
+    unsigned long long ops;         ///< Operazioni eseguite
+    unsigned long long ns;          ///< Tempo totale
+    unsigned long long allocations; ///< Chiamate a operator new
+    unsigned long long bytes;       ///< Byte allocati
+};
+
+/**
+ * @brief Esegue f, che conta come ops operazioni, e ne accumula le misure in m
+ */
+template <typename F>
+void timed(measure &m, unsigned long long ops, F f)
+{
+    unsigned long long a = allocations;
+    unsigned long long b = allocated_bytes;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    m.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+    m.allocations += allocations - a;
+    m.bytes += allocated_bytes - b;
+    m.ops += ops;
+}
+
+/**
+ * @brief Sequenza pseudo-casuale riproducibile (LCG)
+ */
+static unsigned int nextRandom(unsigned int &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static volatile unsigned long long sink; ///< Impedisce al compilatore di togliere le letture
+
+/**
+ * @brief Storage di destinazione della conversione: l'altro dei due
+ */
+template <typename Storage>
+struct other_storage
+{
+    typedef dense_bitset type;
+};
+
+template <>
+struct other_storage<dense_bitset>
+{
+    typedef sparse_adjacency type;
+};
+
+/**
+ * @brief Misura tutte le operazioni su graph<T, Storage> con n nodi
+ *
+ * @param n Numero di nodi
+ * @param convert_fits false se la conversione verso dense_bitset supera il
+ * limite di memoria e va saltata
+ *
+ * @return Misure, una per operazione
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual>
+std::vector<measure> run(unsigned int n, bool convert_fits)
+{
+    typedef graph<T, Storage, Hash, KeyEqual> graph_type;
+
+    const unsigned int edges_per_node = 4;
+    const unsigned int max_removals = 2000;
+    enum { add_node, add_edge, has_edge, exists, iterate_nodes, iterate_edges, copy, convert, remove_node, count };
+    static const char *names[count] = {"addNode", "addEdge", "hasEdge", "exists", "iterateNodes",
+                                       "iterateEdges", "copy", "convert", "removeNode"};
+    std::vector<measure> m(count);
+    for (unsigned int k = 0; k < count; k++)
+    {
+        measure empty = {names[k], 0, 0, 0, 0};
+        m[k] = empty;
+    }
+
+    // Nomi e coppie preparati fuori dalle misure; i nomi oltre n non esistono
+    std::vector<T> nodes(2 * n);
+    for (unsigned int i = 0; i < 2 * n; i++)
+    {
+        makeName(i, nodes[i]);
+    }
+    std::vector<unsigned int> pairs(2 * edges_per_node * n);
+    unsigned int state = n;
+    for (size_t p = 0; p < pairs.size(); p++)
+    {
+        pairs[p] = nextRandom(state) % n;
+    }
+    std::vector<unsigned int> order(n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        order[i] = i;
+    }
+    for (unsigned int i = n; i > 1; i--)
+    {
+        std::swap(order[i - 1], order[nextRandom(state) % i]);
+    }
+
+    // Con N piccoli ripeto lo scenario per avere tempi misurabili
+    unsigned int rounds = n < 20000 ? 20000 / n : 1;
+    for (unsigned int r = 0; r < rounds; r++)
+    {
+        graph_type g;
+        timed(m[add_node], n, [&]() {
+            for (unsigned int i = 0; i < n; i++)
+            {
+                g.addNode(nodes[i]);
+            }
+        });
+        timed(m[add_edge], edges_per_node * n, [&]() {
+            for (size_t p = 0; p < edges_per_node * n; p++)
+            {
+                g.addEdge(nodes[pairs[2 * p]], nodes[pairs[2 * p + 1]]);
+            }
+        });
+        timed(m[has_edge], edges_per_node * n, [&]() {
+            unsigned long long found = 0;
+            // Coppie sfasate di una posizione: quasi tutte assenti
+            for (size_t p = 0; p < edges_per_node * n; p++)
+            {
+                found += g.hasEdge(nodes[pairs[2 * p + 1]], nodes[pairs[(2 * p + 2) % pairs.size()]]);
+            }
+            sink = found;
+        });
+        timed(m[exists], 2 * n, [&]() {
+            unsigned long long found = 0;
+            for (unsigned int i = 0; i < 2 * n; i++)
+            {
+                found += g.exists(nodes[i]);
+            }
+            sink = found;
+        });
+        timed(m[iterate_nodes], n, [&]() {
+            unsigned long long visited = 0;
+            for (typename graph_type::const_iterator it = g.begin(); it != g.end(); ++it)
+            {
+                visited += *reinterpret_cast<const unsigned char *>(&it->name);
+            }
+            sink = visited;
+        });
+        unsigned long long edge_count = 0;
+        timed(m[iterate_edges], 0, [&]() {
+            typename graph_type::edge_range edges = g.edges();
+            for (typename graph_type::edge_range::iterator it = edges.begin(); it != edges.end(); ++it)
+            {
+                edge_count += (*it).second != ~0u;
+            }
+            sink = edge_count;
+        });
+        m[iterate_edges].ops += edge_count;
+        timed(m[copy], 1, [&]() {
+            graph_type c(g);
+            sink = c.size();
+        });
+        if (convert_fits)
+        {
+            timed(m[convert], 1, [&]() {
+                graph<T, typename other_storage<Storage>::type, Hash, KeyEqual> c(g);
+                sink = c.size();
+            });
+        }
+        // removeNode costa O(N): ne misuro al più max_removals
+        unsigned int removals = n < max_removals ? n : max_removals;
+        timed(m[remove_node], removals, [&]() {
+            for (unsigned int i = 0; i < removals; i++)
+            {
+                g.removeNode(nodes[order[i]]);
+            }
+        });
+    }
+    return m;
+}
+
+/**
+ * @brief Misura la conversione graph<int> da graph<char>
+ *
+ * I nomi char sono al più 256, quindi n viene limitato a 256
+ */
+template <typename Storage>
+std::vector<measure> runCharToInt(unsigned int n)
+{
+    measure m = {"convertFromChar", 0, 0, 0, 0};
+    graph<char, Storage> source;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        source.addNode(static_cast<char>(i));
+    }
+    for (unsigned int i = 0; i < n; i++)
+    {
+        source.addEdge(static_cast<char>(i), static_cast<char>((i * 7 + 1) % n));
+    }
+    for (unsigned int r = 0; r < 20000 / n; r++)
+    {
+        timed(m, 1, [&]() {
+            graph<int, Storage> converted(source);
+            sink = converted.size();
+        });
+    }
+    return std::vector<measure>(1, m);
+}
+
+/**
+ * @brief Esegue una configurazione in un processo figlio e ne stampa le righe
+ *
+ * @param type Nome del tipo dei nodi
+ * @param storage Nome dello storage
+ * @param n Numero di nodi
+ * @param f Funzione che restituisce le misure
+ */
+template <typename F>
+void child(const char *type, const char *storage, unsigned int n, F f)
+{
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::perror("fork");
+        return;
+    }
+    if (pid > 0)
+    {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::fprintf(stderr, "%s,%s,%u: configurazione fallita\n", type, storage, n);
+        }
+        return;
+    }
+
+    int code = 0;
+    try
+    {
+        std::vector<measure> m = f();
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        for (size_t k = 0; k < m.size(); k++)
+        {
+            if (m[k].ops == 0)
+            {
+                continue;
+            }
+            double ops = static_cast<double>(m[k].ops);
+            std::printf("%s,%s,%u,%s,%llu,%.2f,%.3f,%.1f,%ld\n", type, storage, n, m[k].op, m[k].ops,
+                        m[k].ns / ops, m[k].allocations / ops, m[k].bytes / ops, usage.ru_maxrss);
+        }
+    }
+    catch (...)
+    {
+        code = 1;
+    }
+    std::fflush(stdout);
+    _exit(code);
+}
+
+/**
+ * @brief Misura una combinazione di tipo e storage per tutti gli N
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual>
+void sweep(const char *type, const char *storage, unsigned int max_n, unsigned long long max_bytes)
+{
+    for (unsigned int n = 100; n <= max_n; n *= 10)
+    {
+        bool fits = static_cast<unsigned long long>(n) * n / 8 <= max_bytes;
+        if (!fits && std::string(storage) == "dense_bitset")
+        {
+            std::fprintf(stderr, "%s,%s,%u: matrice oltre il limite, saltata\n", type, storage, n);
+            continue;
+        }
+        child(type, storage, n, [n, fits]() { return run<T, Storage, Hash, KeyEqual>(n, fits); });
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int max_n = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 100000;
+    unsigned long long max_bytes = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256) << 20;
+
+    std::printf("type,storage,n,op,ops,ns_per_op,allocs_per_op,bytes_per_op,peak_rss_kb\n");
+
+    sweep<int, dense_bitset, std::hash<int>, std::equal_to<int> >("int", "dense_bitset", max_n, max_bytes);
+    sweep<int, sparse_adjacency, std::hash<int>, std::equal_to<int> >("int", "sparse_adjacency", max_n, max_bytes);
+    sweep<std::string, dense_bitset, std::hash<std::string>, std::equal_to<std::string> >(
+        "string", "dense_bitset", max_n, max_bytes);
+    sweep<std::string, sparse_adjacency, std::hash<std::string>, std::equal_to<std::string> >(
+        "string", "sparse_adjacency", max_n, max_bytes);
+    sweep<bench_node, dense_bitset, bench_node_hash, bench_node_equal>("struct", "dense_bitset", max_n, max_bytes);
+    sweep<bench_node, sparse_adjacency, bench_node_hash, bench_node_equal>("struct", "sparse_adjacency", max_n,
+                                                                           max_bytes);
+
+    unsigned int chars = max_n < 256 ? max_n : 256;
+    child("char_to_int", "dense_bitset", chars, [chars]() { return runCharToInt<dense_bitset>(chars); });
+    child("char_to_int", "sparse_adjacency", chars, [chars]() { return runCharToInt<sparse_adjacency>(chars); });
+
+    return 0;
+}
@@ -0,0 +1,281 @@
+#ifndef BITSET_KERNELS_H
+#define BITSET_KERNELS_H
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BITSET_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @file bitset_kernels.h
+ * @brief Operazioni parola per parola su righe di bit, vettorizzate
+ *
+ * Le funzioni lavorano su sequenze di parole da 64 bit, come le righe di
+ * dense_bitset. Ogni operazione ha una versione scalare e, sui processori
+ * x86 con GCC o Clang, versioni AVX2 e AVX-512 compilate con l'attributo
+ * target: la versione da usare viene scelta una volta sola, alla prima
+ * chiamata di bitset_kernels::get(), in base alla CPU su cui gira il
+ * programma. Non servono quindi flag di compilazione come -mavx2.
+ */
+
+/**
+ * @brief Tabella delle operazioni su righe di bit
+ *
+ * In tutte le operazioni count è il numero di parole; dst può coincidere
+ * con a o con b.
+ */
+struct bitset_kernels
+{
+    typedef uint64_t word_type;
+
+    void (*andRows)(word_type *dst, const word_type *a, const word_type *b, size_t count);    ///< dst = a & b
+    void (*orRows)(word_type *dst, const word_type *a, const word_type *b, size_t count);     ///< dst = a | b
+    void (*andNotRows)(word_type *dst, const word_type *a, const word_type *b, size_t count); ///< dst = a & ~b
+    size_t (*popcount)(const word_type *a, size_t count);                                     ///< Bit a 1 di a
+    size_t (*andPopcount)(const word_type *a, const word_type *b, size_t count);              ///< Bit a 1 di a & b
+    const char *name;                                                                         ///< Versione scelta
+
+    /**
+     * @brief Tabella adatta alla CPU corrente
+     *
+     * Viene scelta alla prima chiamata; le chiamate successive, anche da
+     * più thread, restituiscono la stessa tabella.
+     */
+    static const bitset_kernels &get()
+    {
+        static const bitset_kernels kernels = select();
+        return kernels;
+    };
+
+    /**
+     * @brief Tabella scalare, disponibile ovunque
+     */
+    static bitset_kernels scalar()
+    {
+        bitset_kernels k = {&scalarAnd, &scalarOr, &scalarAndNot, &scalarPopcount, &scalarAndPopcount, "scalar"};
+        return k;
+    };
+
+private:
+    static bitset_kernels select()
+    {
+        bitset_kernels k = scalar();
+#ifdef BITSET_KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("popcnt"))
+        {
+            k.popcount = &popcntPopcount;
+            k.andPopcount = &popcntAndPopcount;
+            k.name = "popcnt";
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            k.andRows = &avx2And;
+            k.orRows = &avx2Or;
+            k.andNotRows = &avx2AndNot;
+            k.name = "avx2";
+        }
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            k.andRows = &avx512And;
+            k.orRows = &avx512Or;
+            k.andNotRows = &avx512AndNot;
+            k.name = "avx512";
+        }
+        if (__builtin_cpu_supports("avx512vpopcntdq"))
+        {
+            k.popcount = &avx512Popcount;
+            k.andPopcount = &avx512AndPopcount;
+        }
+#endif
+        return k;
+    };
+
+    static unsigned int popcountWord(word_type word)
+    {
+#ifdef __GNUC__
+        return static_cast<unsigned int>(__builtin_popcountll(word));
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        return static_cast<unsigned int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+    };
+
+    static void scalarAnd(word_type *dst, const word_type *a, const word_type *b, size_t count)
+    {
+        for (size_t w = 0; w < count; w++)
+        {
+            dst[w] = a[w] & b[w];
+        }
+    };
+
+    static void scalarOr(word_type *dst, const word_type *a, const word_type *b, size_t count)
+    {
+        for (size_t w = 0; w < count; w++)
+        {
+            dst[w] = a[w] | b[w];
+        }
+    };
+
+    static void scalarAndNot(word_type *dst, const word_type *a, const word_type *b, size_t count)
+    {
+        for (size_t w = 0; w < count; w++)
+        {
+            dst[w] = a[w] & ~b[w];
+        }
+    };
+
+    static size_t scalarPopcount(const word_type *a, size_t count)
+    {
+        size_t total = 0;
+        for (size_t w = 0; w < count; w++)
+        {
+            total += popcountWord(a[w]);
+        }
+        return total;
+    };
+
+    static size_t scalarAndPopcount(const word_type *a, const word_type *b, size_t count)
+    {
+        size_t total = 0;
+        for (size_t w = 0; w < count; w++)
+        {
+            total += popcountWord(a[w] & b[w]);
+        }
+        return total;
+    };
+
+#ifdef BITSET_KERNELS_X86
+    __attribute__((target("popcnt"))) static size_t popcntPopcount(const word_type *a, size_t count)
+    {
+        size_t total = 0;
+        for (size_t w = 0; w < count; w++)
+        {
+            total += __builtin_popcountll(a[w]);
+        }
+        return total;
+    };
+
+    __attribute__((target("popcnt"))) static size_t popcntAndPopcount(const word_type *a, const word_type *b,
+                                                                       size_t count)
+    {
+        size_t total = 0;
+        for (size_t w = 0; w < count; w++)
+        {
+            total += __builtin_popcountll(a[w] & b[w]);
+        }
+        return total;
+    };
+
+    __attribute__((target("avx2"))) static void avx2And(word_type *dst, const word_type *a, const word_type *b,
+                                                         size_t count)
+    {
+        size_t w = 0;
+        for (; w + 4 <= count; w += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + w));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + w));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + w), _mm256_and_si256(x, y));
+        }
+        scalarAnd(dst + w, a + w, b + w, count - w);
+    };
+
+    __attribute__((target("avx2"))) static void avx2Or(word_type *dst, const word_type *a, const word_type *b,
+                                                        size_t count)
+    {
+        size_t w = 0;
+        for (; w + 4 <= count; w += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + w));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + w));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + w), _mm256_or_si256(x, y));
+        }
+        scalarOr(dst + w, a + w, b + w, count - w);
+    };
+
+    __attribute__((target("avx2"))) static void avx2AndNot(word_type *dst, const word_type *a, const word_type *b,
+                                                            size_t count)
+    {
+        size_t w = 0;
+        for (; w + 4 <= count; w += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + w));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + w));
+            // andnot nega il primo operando
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + w), _mm256_andnot_si256(y, x));
+        }
+        scalarAndNot(dst + w, a + w, b + w, count - w);
+    };
+
+    __attribute__((target("avx512f"))) static void avx512And(word_type *dst, const word_type *a, const word_type *b,
+                                                              size_t count)
+    {
+        size_t w = 0;
+        for (; w + 8 <= count; w += 8)
+        {
+            __m512i x = _mm512_loadu_si512(a + w);
+            __m512i y = _mm512_loadu_si512(b + w);
+            _mm512_storeu_si512(dst + w, _mm512_and_si512(x, y));
+        }
+        scalarAnd(dst + w, a + w, b + w, count - w);
+    };
+
+    __attribute__((target("avx512f"))) static void avx512Or(word_type *dst, const word_type *a, const word_type *b,
+                                                             size_t count)
+    {
+        size_t w = 0;
+        for (; w + 8 <= count; w += 8)
+        {
+            __m512i x = _mm512_loadu_si512(a + w);
+            __m512i y = _mm512_loadu_si512(b + w);
+            _mm512_storeu_si512(dst + w, _mm512_or_si512(x, y));
+        }
+        scalarOr(dst + w, a + w, b + w, count - w);
+    };
+
+    __attribute__((target("avx512f"))) static void avx512AndNot(word_type *dst, const word_type *a,
+                                                                 const word_type *b, size_t count)
+    {
+        size_t w = 0;
+        for (; w + 8 <= count; w += 8)
+        {
+            __m512i x = _mm512_loadu_si512(a + w);
+            __m512i y = _mm512_loadu_si512(b + w);
+            _mm512_storeu_si512(dst + w, _mm512_andnot_si512(y, x));
+        }
+        scalarAndNot(dst + w, a + w, b + w, count - w);
+    };
+
+    __attribute__((target("avx512f,avx512vpopcntdq"))) static size_t avx512Popcount(const word_type *a, size_t count)
+    {
+        __m512i acc = _mm512_setzero_si512();
+        size_t w = 0;
+        for (; w + 8 <= count; w += 8)
+        {
+            acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(a + w)));
+        }
+        return static_cast<size_t>(_mm512_reduce_add_epi64(acc)) + scalarPopcount(a + w, count - w);
+    };
+
+    __attribute__((target("avx512f,avx512vpopcntdq"))) static size_t avx512AndPopcount(const word_type *a,
+                                                                                       const word_type *b,
+                                                                                       size_t count)
+    {
+        __m512i acc = _mm512_setzero_si512();
+        size_t w = 0;
+        for (; w + 8 <= count; w += 8)
+        {
+            __m512i x = _mm512_and_si512(_mm512_loadu_si512(a + w), _mm512_loadu_si512(b + w));
+            acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+        }
+        return static_cast<size_t>(_mm512_reduce_add_epi64(acc)) + scalarAndPopcount(a + w, b + w, count - w);
+    };
+#endif
+};
+
+#endif
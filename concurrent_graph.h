@@ -0,0 +1,645 @@
+#ifndef CONCURRENT_GRAPH_H
+#define CONCURRENT_GRAPH_H
+
+#include <atomic>
+#include <functional> // std::hash, std::equal_to
+#include <mutex>
+#include <thread>     // std::this_thread
+#include <vector>
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+#include "dense_bitset.h"
+#include "node_index.h"
+
+/**
+ * @file concurrent_graph.h
+ * @brief Dichiarazione della classe concurrent_graph
+ *
+ * Modello di memoria
+ *
+ * - Le modifiche sono serializzate da un mutex: c'è un solo scrittore alla
+ *   volta. I lettori non prendono mai il mutex e non aspettano lo scrittore.
+ * - Lo stato è contenuto in una versione a capacità fissa (nomi, flag di
+ *   vita, indice hash e matrice di parole atomiche), pubblicata da un
+ *   puntatore atomico.
+ * - addEdge e removeEdge cambiano un bit della versione corrente con
+ *   fetch_or / fetch_and (release); i lettori leggono le parole con acquire.
+ * - addNode entro la capacità scrive il nome in una posizione mai usata e
+ *   solo dopo la pubblica, prima nel bucket dell'indice e poi nel numero di
+ *   posizioni, entrambi con release: chi trova la posizione (acquire) vede
+ *   il nome completo. Dentro una versione i nomi non cambiano più.
+ * - removeNode marca la posizione come morta (release) e ne azzera riga e
+ *   colonna; i lettori ignorano le posizioni morte.
+ * - Quando la capacità è esaurita lo scrittore copia i nodi vivi in una
+ *   nuova versione, la pubblica e ritira la vecchia. Durante la copia tiene
+ *   il mutex, quindi nessun bit cambia.
+ * - Le versioni ritirate sono liberate a epoche: un lettore annuncia in uno
+ *   slot l'epoca globale prima di leggere il puntatore alla versione e la
+ *   cancella alla fine; una versione ritirata all'epoca e viene liberata
+ *   quando nessuno slot attivo ha epoca <= e. Slot, epoca e puntatore sono
+ *   acceduti in modo seq_cst.
+ *
+ * Ogni lettura è atomica rispetto a ogni singola modifica, ma letture
+ * successive con lo stesso reader possono vedere modifiche avvenute nel
+ * frattempo: un reader non è una fotografia del graph.
+ */
+
+/**
+ * @brief Graph con uno scrittore e lettori che non si bloccano
+ *
+ * Versione concorrente del graph con dense_bitset: un thread (o più thread
+ * serializzati dal mutex interno) modifica nodi e archi mentre altri thread
+ * leggono tramite reader. Le posizioni dei nodi rimossi vengono recuperate
+ * quando la capacità è esaurita.
+ *
+ * @tparam T Tipo del nome dei nodi
+ * @tparam Hash Funtore di hash su T
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ */
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T> >
+class concurrent_graph
+{
+public:
+    typedef dense_bitset::word_type word_type;
+
+    static const unsigned int readerSlots = 64; ///< Lettori contemporanei che non aspettano mai
+
+private:
+    typedef node_index<T, Hash, KeyEqual> index_type;
+
+    /**
+     * @brief Stato del graph con capacità fissa
+     */
+    struct version
+    {
+        unsigned int capacity;                ///< Posizioni disponibili
+        unsigned int wordsPerRow;             ///< Parole per riga della matrice
+        unsigned int bucketCount;             ///< Bucket dell'indice (potenza di 2)
+        T *names;                             ///< Nome di ogni posizione
+        std::atomic<bool> *alive;             ///< true se la posizione contiene un nodo
+        std::atomic<unsigned int> *buckets;   ///< Indice dei nomi (posizione + 1, 0 se vuoto)
+        std::atomic<word_type> *words;        ///< Matrice di adiacenza, riga per riga
+        std::atomic<unsigned int> slots;      ///< Posizioni pubblicate
+        std::atomic<unsigned int> size;       ///< Nodi vivi
+        uint64_t retiredAt;                   ///< Epoca del ritiro
+        version *nextRetired;                 ///< Versione ritirata successiva
+
+        explicit version(unsigned int cap)
+            : capacity(cap), wordsPerRow(dense_bitset::wordsFor(cap)), bucketCount(index_type::capacityFor(cap)),
+              names(nullptr), alive(nullptr), buckets(nullptr), words(nullptr), slots(0), size(0), retiredAt(0),
+              nextRetired(nullptr)
+        {
+            try
+            {
+                names = new T[cap];
+                alive = new std::atomic<bool>[cap];
+                buckets = new std::atomic<unsigned int>[bucketCount];
+                words = new std::atomic<word_type>[totalWords()];
+            }
+            catch (...)
+            {
+                release();
+                throw;
+            }
+            for (unsigned int i = 0; i < cap; i++)
+            {
+                alive[i].store(false, std::memory_order_relaxed);
+            }
+            for (unsigned int b = 0; b < bucketCount; b++)
+            {
+                buckets[b].store(0, std::memory_order_relaxed);
+            }
+            for (size_t w = 0; w < totalWords(); w++)
+            {
+                words[w].store(0, std::memory_order_relaxed);
+            }
+        };
+
+        ~version()
+        {
+            release();
+        };
+
+        size_t totalWords() const
+        {
+            return static_cast<size_t>(capacity) * wordsPerRow;
+        };
+
+        /**
+         * @brief Parola della matrice che contiene il bit (i, j)
+         */
+        std::atomic<word_type> &word(unsigned int i, unsigned int j) const
+        {
+            return words[static_cast<size_t>(i) * wordsPerRow + j / dense_bitset::bitsPerWord];
+        };
+
+        void release()
+        {
+            delete[] names;
+            delete[] alive;
+            delete[] buckets;
+            delete[] words;
+        };
+
+    private:
+        version(const version &);
+        version &operator=(const version &);
+    };
+
+    /**
+     * @brief Epoca annunciata da un lettore, 0 se lo slot è libero
+     *
+     * Ogni slot occupa una linea di cache, così i lettori non si contendono
+     * la stessa linea
+     */
+    struct reader_slot
+    {
+        std::atomic<uint64_t> epoch;
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    std::atomic<version *> _current;         ///< Versione pubblicata
+    std::atomic<uint64_t> _epoch;            ///< Epoca globale, parte da 1
+    mutable reader_slot _readers[readerSlots]; ///< Epoche dei lettori attivi
+    std::mutex _writer;                      ///< Serializza gli scrittori
+    version *_retired;                       ///< Versioni ritirate non ancora liberate
+    Hash _hash;                              ///< Funtore di hash
+    KeyEqual _equal;                         ///< Funtore di uguaglianza
+
+    concurrent_graph(const concurrent_graph &);
+    concurrent_graph &operator=(const concurrent_graph &);
+
+public:
+    /**
+     * @brief Accesso in lettura al graph
+     *
+     * Finché esiste, la versione che ha letto non viene liberata. Creare un
+     * reader non prende lock: occupa uno slot con un compare-and-swap e
+     * aspetta solo se tutti i readerSlots slot sono occupati. Non va
+     * condiviso tra thread.
+     */
+    class reader
+    {
+        const concurrent_graph &_graph; ///< graph letto
+        unsigned int _slot;             ///< Slot occupato
+        const version *_version;        ///< Versione letta
+
+        reader(const reader &);
+        reader &operator=(const reader &);
+
+    public:
+        /**
+         * @brief Costruttore
+         *
+         * @param gr graph da leggere
+         */
+        explicit reader(const concurrent_graph &gr)
+            : _graph(gr), _slot(gr.enter()), _version(gr._current.load()){};
+
+        /**
+         * @brief Distruttore, libera lo slot
+         */
+        ~reader()
+        {
+            _graph.leave(_slot);
+        };
+
+        /**
+         * @brief Numero di nodi
+         */
+        unsigned int size() const
+        {
+            return _version->size.load(std::memory_order_acquire);
+        };
+
+        /**
+         * @brief Funzione per verificare l'esistenza di un nodo
+         */
+        bool exists(const T &name) const
+        {
+            return _graph.find(*_version, name) != -1;
+        };
+
+        /**
+         * @brief Funzione per verificare l'esistenza di un arco
+         *
+         * Lancia un errore se uno dei due nodi non esiste
+         */
+        bool hasEdge(const T &origin_node, const T &destination_node) const
+        {
+            int i = _graph.find(*_version, origin_node);
+            int j = _graph.find(*_version, destination_node);
+            if (i == -1 || j == -1)
+            {
+                throw 1;
+            }
+            return (_version->word(i, j).load(std::memory_order_acquire) >> (j % dense_bitset::bitsPerWord)) & 1;
+        };
+
+        /**
+         * @brief Chiama f(nome) per ogni nodo, in ordine di posizione
+         */
+        template <typename F>
+        void forEachNode(F f) const
+        {
+            unsigned int slots = _version->slots.load(std::memory_order_acquire);
+            for (unsigned int i = 0; i < slots; i++)
+            {
+                if (_version->alive[i].load(std::memory_order_acquire))
+                {
+                    f(static_cast<const T &>(_version->names[i]));
+                }
+            }
+        };
+
+        /**
+         * @brief Chiama f(nome) per ogni successore di un nodo
+         *
+         * Lancia un errore se il nodo non esiste
+         */
+        template <typename F>
+        void forEachSuccessor(const T &name, F f) const
+        {
+            int i = _graph.find(*_version, name);
+            if (i == -1)
+            {
+                throw 1;
+            }
+            for (unsigned int w = 0; w < _version->wordsPerRow; w++)
+            {
+                word_type bits = _version->word(i, w * dense_bitset::bitsPerWord).load(std::memory_order_acquire);
+                while (bits != 0)
+                {
+                    unsigned int j = w * dense_bitset::bitsPerWord + dense_bitset::countTrailingZeros(bits);
+                    bits &= bits - 1;
+                    if (_version->alive[j].load(std::memory_order_acquire))
+                    {
+                        f(static_cast<const T &>(_version->names[j]));
+                    }
+                }
+            }
+        };
+    };
+
+    /**
+     * @brief Costruttore
+     *
+     * @param hash Funtore di hash
+     * @param equal Funtore di uguaglianza
+     */
+    explicit concurrent_graph(const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual())
+        : _current(nullptr), _epoch(1), _writer(), _retired(nullptr), _hash(hash), _equal(equal)
+    {
+        for (unsigned int s = 0; s < readerSlots; s++)
+        {
+            _readers[s].epoch.store(0, std::memory_order_relaxed);
+        }
+        _current.store(new version(16));
+    };
+
+    /**
+     * @brief Distruttore della classe
+     *
+     * @pre Nessun reader attivo
+     */
+    ~concurrent_graph()
+    {
+        delete _current.load();
+        while (_retired != nullptr)
+        {
+            version *next = _retired->nextRetired;
+            delete _retired;
+            _retired = next;
+        }
+    };
+
+    /**
+     * @brief Funzione per aggiungere un nodo
+     *
+     * Lancia un errore se il nodo esiste già. Se la capacità è esaurita il
+     * graph viene copiato in una nuova versione senza i nodi rimossi.
+     *
+     * @param node_name Nodo da aggiungere
+     */
+    void addNode(const T &node_name)
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        version *v = _current.load(std::memory_order_relaxed);
+        if (find(*v, node_name) != -1)
+        {
+            throw 1;
+        }
+        if (v->slots.load(std::memory_order_relaxed) == v->capacity)
+        {
+            v = rebuild(index_type::capacityFor(v->size.load(std::memory_order_relaxed) + 1));
+        }
+
+        unsigned int pos = v->slots.load(std::memory_order_relaxed);
+        // Finché non è pubblicata la posizione è invisibile ai lettori
+        v->names[pos] = node_name;
+        v->alive[pos].store(true, std::memory_order_relaxed);
+        insertBucket(*v, node_name, pos);
+        v->slots.store(pos + 1, std::memory_order_release);
+        v->size.store(v->size.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    };
+
+    /**
+     * @brief Funzione per rimuovere un nodo
+     *
+     * La posizione resta occupata fino alla prossima nuova versione. Lancia
+     * un errore se il nodo non esiste.
+     *
+     * @param node_name Nodo da rimuovere
+     */
+    void removeNode(const T &node_name)
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        version *v = _current.load(std::memory_order_relaxed);
+        int i = find(*v, node_name);
+        if (i == -1)
+        {
+            throw 1;
+        }
+
+        v->alive[i].store(false, std::memory_order_release);
+        for (unsigned int w = 0; w < v->wordsPerRow; w++)
+        {
+            v->word(i, w * dense_bitset::bitsPerWord).store(0, std::memory_order_release);
+        }
+        word_type mask = ~(word_type(1) << (i % dense_bitset::bitsPerWord));
+        unsigned int slots = v->slots.load(std::memory_order_relaxed);
+        for (unsigned int r = 0; r < slots; r++)
+        {
+            v->word(r, i).fetch_and(mask, std::memory_order_release);
+        }
+        v->size.store(v->size.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+    };
+
+    /**
+     * @brief Funzione per aggiungere archi
+     *
+     * Lancia un errore se uno dei due nodi non esiste
+     */
+    void addEdge(const T &origin_node, const T &destination_node)
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        version *v = _current.load(std::memory_order_relaxed);
+        int i = find(*v, origin_node);
+        int j = find(*v, destination_node);
+        if (i == -1 || j == -1)
+        {
+            throw 1;
+        }
+        v->word(i, j).fetch_or(word_type(1) << (j % dense_bitset::bitsPerWord), std::memory_order_release);
+    };
+
+    /**
+     * @brief Funzione per rimuovere archi
+     *
+     * Lancia un errore se uno dei due nodi non esiste
+     */
+    void removeEdge(const T &origin_node, const T &destination_node)
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        version *v = _current.load(std::memory_order_relaxed);
+        int i = find(*v, origin_node);
+        int j = find(*v, destination_node);
+        if (i == -1 || j == -1)
+        {
+            throw 1;
+        }
+        v->word(i, j).fetch_and(~(word_type(1) << (j % dense_bitset::bitsPerWord)), std::memory_order_release);
+    };
+
+    /**
+     * @brief Garantisce spazio per count nodi senza nuove versioni
+     *
+     * @param count Numero di nodi da poter contenere
+     */
+    void reserve(unsigned int count)
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        version *v = _current.load(std::memory_order_relaxed);
+        unsigned int size = v->size.load(std::memory_order_relaxed);
+        if (count > size && v->capacity - v->slots.load(std::memory_order_relaxed) < count - size)
+        {
+            rebuild(index_type::capacityFor(count));
+        }
+    };
+
+    /**
+     * @brief Copia i nodi vivi in una nuova versione, recuperando le
+     * posizioni dei nodi rimossi
+     */
+    void compact()
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        version *v = _current.load(std::memory_order_relaxed);
+        if (v->slots.load(std::memory_order_relaxed) != v->size.load(std::memory_order_relaxed))
+        {
+            rebuild(v->capacity);
+        }
+    };
+
+    /**
+     * @brief Libera le versioni ritirate che nessun lettore usa più
+     *
+     * Viene chiamata anche a ogni nuova versione; serve quando i lettori
+     * sono usciti dopo l'ultima.
+     */
+    void reclaim()
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        collect();
+    };
+
+    /**
+     * @brief Numero di nodi
+     */
+    unsigned int size() const
+    {
+        return reader(*this).size();
+    };
+
+    /**
+     * @brief Funzione per verificare l'esistenza di un nodo
+     */
+    bool exists(const T &name) const
+    {
+        return reader(*this).exists(name);
+    };
+
+    /**
+     * @brief Funzione per verificare l'esistenza di un arco
+     *
+     * Lancia un errore se uno dei due nodi non esiste
+     */
+    bool hasEdge(const T &origin_node, const T &destination_node) const
+    {
+        return reader(*this).hasEdge(origin_node, destination_node);
+    };
+
+private:
+    /**
+     * @brief Occupa uno slot annunciando l'epoca corrente
+     *
+     * @return Slot occupato
+     */
+    unsigned int enter() const
+    {
+        unsigned int start =
+            static_cast<unsigned int>(std::hash<std::thread::id>()(std::this_thread::get_id()) % readerSlots);
+        for (;;)
+        {
+            for (unsigned int k = 0; k < readerSlots; k++)
+            {
+                unsigned int s = (start + k) % readerSlots;
+                uint64_t expected = 0;
+                if (_readers[s].epoch.load(std::memory_order_relaxed) == 0 &&
+                    _readers[s].epoch.compare_exchange_strong(expected, _epoch.load()))
+                {
+                    return s;
+                }
+            }
+            // Tutti gli slot sono occupati: aspetto che un lettore esca
+            std::this_thread::yield();
+        }
+    };
+
+    /**
+     * @brief Libera uno slot occupato da enter
+     */
+    void leave(unsigned int slot) const
+    {
+        _readers[slot].epoch.store(0, std::memory_order_release);
+    };
+
+    /**
+     * @brief Posizione di un nodo vivo in una versione, -1 se non esiste
+     *
+     * I bucket dei nodi rimossi restano nell'indice e vengono saltati
+     */
+    int find(const version &v, const T &name) const
+    {
+        return index_type::probe(
+            name, v.bucketCount, _hash,
+            [&v](unsigned int b) { return v.buckets[b].load(std::memory_order_acquire); },
+            [&](unsigned int p) { return v.alive[p].load(std::memory_order_acquire) && _equal(v.names[p], name); });
+    };
+
+    /**
+     * @brief Pubblica nell'indice la posizione pos di name
+     */
+    void insertBucket(version &v, const T &name, unsigned int pos)
+    {
+        unsigned int b = index_type::freeBucket(
+            name, v.bucketCount, _hash, [&v](unsigned int b) { return v.buckets[b].load(std::memory_order_relaxed); });
+        v.buckets[b].store(pos + 1, std::memory_order_release);
+    };
+
+    /**
+     * @brief Copia i nodi vivi in una versione di capacità capacity, la
+     * pubblica e ritira quella corrente
+     *
+     * In caso di eccezione la versione corrente resta invariata
+     *
+     * @return Nuova versione
+     */
+    version *rebuild(unsigned int capacity)
+    {
+        version *old = _current.load(std::memory_order_relaxed);
+        unsigned int slots = old->slots.load(std::memory_order_relaxed);
+        version *fresh = new version(capacity);
+        try
+        {
+            std::vector<unsigned int> remap(slots, dense_bitset::discarded);
+            unsigned int next = 0;
+            for (unsigned int i = 0; i < slots; i++)
+            {
+                if (old->alive[i].load(std::memory_order_relaxed))
+                {
+                    fresh->names[next] = old->names[i];
+                    fresh->alive[next].store(true, std::memory_order_relaxed);
+                    insertBucket(*fresh, old->names[i], next);
+                    remap[i] = next++;
+                }
+            }
+            for (unsigned int i = 0; i < slots; i++)
+            {
+                if (remap[i] == dense_bitset::discarded)
+                {
+                    continue;
+                }
+                for (unsigned int w = 0; w < old->wordsPerRow; w++)
+                {
+                    word_type bits = old->word(i, w * dense_bitset::bitsPerWord).load(std::memory_order_relaxed);
+                    while (bits != 0)
+                    {
+                        unsigned int j = w * dense_bitset::bitsPerWord + dense_bitset::countTrailingZeros(bits);
+                        bits &= bits - 1;
+                        fresh->word(remap[i], remap[j])
+                            .fetch_or(word_type(1) << (remap[j] % dense_bitset::bitsPerWord),
+                                      std::memory_order_relaxed);
+                    }
+                }
+            }
+            fresh->slots.store(next, std::memory_order_relaxed);
+            fresh->size.store(next, std::memory_order_relaxed);
+        }
+        catch (...)
+        {
+            delete fresh;
+            throw;
+        }
+
+        _current.store(fresh);
+        retire(old);
+        return fresh;
+    };
+
+    /**
+     * @brief Ritira una versione non più pubblicata
+     */
+    void retire(version *old)
+    {
+        old->retiredAt = _epoch.fetch_add(1);
+        old->nextRetired = _retired;
+        _retired = old;
+        collect();
+    };
+
+    /**
+     * @brief Libera le versioni ritirate prima dell'epoca di ogni lettore attivo
+     */
+    void collect()
+    {
+        uint64_t oldest = ~uint64_t(0);
+        for (unsigned int s = 0; s < readerSlots; s++)
+        {
+            uint64_t epoch = _readers[s].epoch.load();
+            if (epoch != 0 && epoch < oldest)
+            {
+                oldest = epoch;
+            }
+        }
+        version **link = &_retired;
+        while (*link != nullptr)
+        {
+            if ((*link)->retiredAt < oldest)
+            {
+                version *done = *link;
+                *link = done->nextRetired;
+                delete done;
+            }
+            else
+            {
+                link = &(*link)->nextRetired;
+            }
+        }
+    };
+};
+
+template <typename T, typename Hash, typename KeyEqual>
+const unsigned int concurrent_graph<T, Hash, KeyEqual>::readerSlots;
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef COW_ARRAY_H
+#define COW_ARRAY_H
+
+#include <atomic>  // std::atomic_thread_fence
+#include <memory>  // std::shared_ptr, std::make_shared
+#include <utility> // std::swap
+#include <vector>
+#include <stddef.h> // size_t
+
+/**
+ * @file cow_array.h
+ * @brief Dichiarazione della classe cow_array
+ */
+
+/**
+ * @brief Array a blocchi condivisi con copia alla scrittura
+ *
+ * Gli elementi sono divisi in blocchi di BlockSize elementi, ciascuno
+ * tenuto da uno shared_ptr; la tabella dei blocchi è a sua volta condivisa.
+ * Copiare un cow_array costa O(1) e la copia condivide tutti i blocchi; la
+ * prima scrittura dopo una copia duplica la tabella (O(size / BlockSize)
+ * puntatori) e poi solo i blocchi effettivamente modificati. Un blocco
+ * viene liberato quando l'ultimo cow_array che lo usa lo lascia.
+ *
+ * Copie diverse possono essere usate da thread diversi (anche una in
+ * scrittura e le altre in lettura); lo stesso cow_array non può essere
+ * copiato o letto da un thread mentre un altro lo modifica.
+ *
+ * @tparam V Tipo degli elementi, copiabile (non bool, per std::vector<bool>)
+ * @tparam BlockSize Elementi per blocco
+ */
+template <typename V, unsigned int BlockSize = 512>
+class cow_array
+{
+    typedef std::vector<V> block;
+    typedef std::vector<std::shared_ptr<block> > table;
+
+    std::shared_ptr<table> _table; ///< Blocchi, condivisi tra le copie
+    size_t _size;                  ///< Numero di elementi
+
+public:
+    /**
+     * @brief Costruttore
+     *
+     * @param size Numero di elementi
+     * @param value Valore iniziale degli elementi
+     */
+    explicit cow_array(size_t size = 0, const V &value = V()) : _table(std::make_shared<table>()), _size(0)
+    {
+        resize(size, value);
+    };
+
+    /**
+     * @brief Scambia lo stato interno con un altro cow_array
+     */
+    void swap(cow_array &other) noexcept
+    {
+        _table.swap(other._table);
+        std::swap(_size, other._size);
+    };
+
+    /**
+     * @brief Numero di elementi
+     */
+    size_t size() const
+    {
+        return _size;
+    };
+
+    /**
+     * @brief Elemento i-esimo in lettura
+     *
+     * @pre i < size()
+     */
+    const V &operator[](size_t i) const
+    {
+        return (*(*_table)[i / BlockSize])[i % BlockSize];
+    };
+
+    /**
+     * @brief Elemento i-esimo in scrittura
+     *
+     * Rende privati la tabella e il blocco dell'elemento se sono condivisi
+     * con altre copie
+     *
+     * @pre i < size()
+     */
+    V &mutate(size_t i)
+    {
+        ownTable();
+        std::shared_ptr<block> &b = (*_table)[i / BlockSize];
+        if (!unique(b))
+        {
+            b = std::make_shared<block>(*b);
+        }
+        return (*b)[i % BlockSize];
+    };
+
+    /**
+     * @brief Cambia il numero di elementi
+     *
+     * I nuovi elementi valgono value; i blocchi tolti vengono lasciati
+     *
+     * @param size Nuovo numero di elementi
+     * @param value Valore dei nuovi elementi
+     */
+    void resize(size_t size, const V &value = V())
+    {
+        ownTable();
+        size_t blocks = (size + BlockSize - 1) / BlockSize;
+        for (size_t i = _size; i < size && i < _table->size() * BlockSize; i++)
+        {
+            mutate(i) = value;
+        }
+        _table->resize(blocks);
+        for (size_t b = 0; b < blocks; b++)
+        {
+            if (!(*_table)[b])
+            {
+                (*_table)[b] = std::make_shared<block>(BlockSize, value);
+            }
+        }
+        _size = size;
+    };
+
+    /**
+     * @brief Numero di blocchi condivisi con almeno un'altra copia
+     */
+    size_t sharedBlocks() const
+    {
+        size_t shared = 0;
+        for (size_t b = 0; b < _table->size(); b++)
+        {
+            shared += (*_table)[b].use_count() > 1 || _table.use_count() > 1;
+        }
+        return shared;
+    };
+
+private:
+    /**
+     * @brief true se p non è condiviso
+     *
+     * La barriera acquire si accoppia con il decremento del contatore fatto
+     * da un'altra copia che lascia il puntatore, così le sue letture
+     * precedono le scritture di questo thread
+     */
+    template <typename P>
+    static bool unique(const std::shared_ptr<P> &p)
+    {
+        if (p.use_count() == 1)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+        return false;
+    };
+
+    /**
+     * @brief Rende privata la tabella; i blocchi restano condivisi
+     */
+    void ownTable()
+    {
+        if (!unique(_table))
+        {
+            _table = std::make_shared<table>(*_table);
+        }
+    };
+};
+
+#endif
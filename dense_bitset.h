@@ -0,0 +1,993 @@
+#ifndef DENSE_BITSET_H
+#define DENSE_BITSET_H
+
+#include <algorithm> // std::swap, std::fill
+#include <atomic>
+#include <memory>    // std::allocator, std::allocator_traits
+#include <type_traits> // std::integral_constant
+#include <cstring>   // std::memcpy, std::memmove
+#include <stdint.h>  // uint64_t
+#include <vector>
+#include "adjacency_ranges.h"
+#include "bitset_kernels.h"
+
+/**
+ * @file dense_bitset.h
+ * @brief Dichiarazione della classe dense_bitset
+ */
+
+/**
+ * @brief Matrice di adiacenza compatta
+ *
+ * Matrice quadrata di bit memorizzata in un unico blocco contiguo di parole
+ * da 64 bit. Lo spazio è allocato per capacity() righe, ognuna allineata a
+ * parola e lunga wordsPerRow() parole, così da poter crescere senza
+ * riallocare. Tutti i bit fuori dal quadrato size() x size() sono sempre a
+ * zero: aggiungere una riga e una colonna entro la capacità non richiede
+ * quindi alcuna scrittura.
+ *
+ * I predecessori di un nodo stanno in una colonna, sparsa su tutte le
+ * righe: alla prima richiesta viene quindi costruita una vista trasposta
+ * (una seconda matrice con gli archi entranti per riga), poi mantenuta da
+ * set, reset e dalle altre modifiche. La vista raddoppia la memoria; si
+ * libera con releaseTransposed() o shrink_to_fit().
+ *
+ * È la politica di memorizzazione di default di graph; sparse_adjacency
+ * offre la stessa interfaccia per grafi sparsi. dense_bitset è la versione
+ * con std::allocator.
+ *
+ * @tparam Allocator Allocatore per le parole della matrice e per la vista
+ *         trasposta
+ */
+template <typename Allocator = std::allocator<uint64_t> >
+class basic_dense_bitset
+{
+public:
+    typedef uint64_t word_type;
+    typedef word_type row_type; ///< Una riga è una sequenza di parole
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<word_type> allocator_type;
+
+    /**
+     * @brief La stessa politica con un altro allocatore
+     */
+    template <typename OtherAllocator>
+    struct rebind
+    {
+        typedef basic_dense_bitset<typename std::allocator_traits<OtherAllocator>::template rebind_alloc<word_type> >
+            other;
+    };
+
+    static const unsigned int bitsPerWord = 64;  ///< Bit contenuti in una parola
+    static const unsigned int discarded = ~0u;   ///< Valore di remap per le righe da togliere
+
+private:
+    typedef std::allocator_traits<allocator_type> word_traits;
+    typedef typename word_traits::template rebind_alloc<basic_dense_bitset> view_allocator;
+    typedef std::allocator_traits<view_allocator> view_traits;
+
+    allocator_type _alloc;     ///< Allocatore delle parole
+    word_type *_words;         ///< Puntatore al blocco contiguo di parole
+    unsigned int _size;        ///< Numero di righe (e di colonne)
+    unsigned int _capacity;    ///< Numero di righe (e di colonne) allocate
+    unsigned int _wordsPerRow; ///< Parole occupate da ogni riga
+    mutable std::atomic<basic_dense_bitset *> _transposed; ///< Vista trasposta, nullptr finché non serve
+
+public:
+    /**
+     * @brief Numero di parole necessarie per contenere bits bit
+     *
+     * @param bits Numero di bit
+     *
+     * @return Numero di parole da 64 bit
+     */
+    static unsigned int wordsFor(unsigned int bits)
+    {
+        return (bits + bitsPerWord - 1) / bitsPerWord;
+    }
+
+    /**
+     * @brief Posizione del bit meno significativo a 1
+     *
+     * @param word Parola da esaminare
+     *
+     * @pre word != 0
+     *
+     * @return Numero di zeri finali di word
+     */
+    static unsigned int countTrailingZeros(word_type word)
+    {
+        return bit_iterator::countTrailingZeros(word);
+    }
+
+    typedef iterator_range<bit_iterator> successor_range;   ///< Successori di un nodo
+    typedef iterator_range<bit_iterator> predecessor_range; ///< Predecessori di un nodo
+
+    /**
+     * @brief Costruttore di default
+     *
+     * @post _words == nullptr
+     * @post _size == 0
+     * @post _capacity == 0
+     */
+    basic_dense_bitset()
+        : _alloc(), _words(nullptr), _size(0), _capacity(0), _wordsPerRow(0), _transposed(nullptr){};
+
+    /**
+     * @brief Costruttore con allocatore
+     *
+     * Crea una matrice vuota che allocherà con alloc
+     *
+     * @param alloc Allocatore da usare
+     */
+    explicit basic_dense_bitset(const allocator_type &alloc)
+        : _alloc(alloc), _words(nullptr), _size(0), _capacity(0), _wordsPerRow(0), _transposed(nullptr){};
+
+    /**
+     * @brief Costruttore secondario
+     *
+     * Crea una matrice size x size con tutti i bit a false
+     *
+     * @param size Numero di righe e colonne
+     * @param capacity Numero di righe e colonne da allocare (almeno size)
+     * @param alloc Allocatore da usare
+     */
+    explicit basic_dense_bitset(unsigned int size, unsigned int capacity = 0,
+                                const allocator_type &alloc = allocator_type())
+        : _alloc(alloc), _words(nullptr), _size(size), _capacity(std::max(size, capacity)),
+          _wordsPerRow(wordsFor(_capacity)), _transposed(nullptr)
+    {
+        _words = word_traits::allocate(_alloc, totalWords());
+        std::fill(_words, _words + totalWords(), word_type(0));
+    };
+
+    /**
+     * @brief Copy constructor
+     *
+     * La copia ha capacità pari alla dimensione dell'originale e non
+     * copia la vista trasposta
+     *
+     * @param other dense_bitset da copiare
+     */
+    basic_dense_bitset(const basic_dense_bitset &other)
+        : _alloc(word_traits::select_on_container_copy_construction(other._alloc)), _words(nullptr), _size(0),
+          _capacity(0), _wordsPerRow(0), _transposed(nullptr)
+    {
+        basic_dense_bitset tmp(other._size, 0, _alloc);
+        tmp.copyRows(other);
+
+        tmp.swap(*this);
+    };
+
+    /**
+     * @brief Copy constructor con allocatore
+     *
+     * @param other dense_bitset da copiare
+     * @param alloc Allocatore della copia
+     */
+    basic_dense_bitset(const basic_dense_bitset &other, const allocator_type &alloc)
+        : _alloc(alloc), _words(nullptr), _size(0), _capacity(0), _wordsPerRow(0), _transposed(nullptr)
+    {
+        basic_dense_bitset tmp(other._size, 0, _alloc);
+        tmp.copyRows(other);
+
+        tmp.swap(*this);
+    };
+
+    /**
+     * @brief Operatore di assegnamento
+     *
+     * @param other dense_bitset da copiare
+     *
+     * @return reference a dense_bitset
+     */
+    basic_dense_bitset &operator=(const basic_dense_bitset &other)
+    {
+        if (this != &other)
+        {
+            basic_dense_bitset tmp(other, word_traits::propagate_on_container_copy_assignment::value ? other._alloc
+                                                                                                      : _alloc);
+
+            tmp.swap(*this);
+        }
+
+        return *this;
+    };
+
+    /**
+     * @brief Distruttore della classe
+     */
+    ~basic_dense_bitset()
+    {
+        destroyView(_transposed.load(std::memory_order_relaxed));
+        if (_words != nullptr)
+        {
+            word_traits::deallocate(_alloc, _words, totalWords());
+        }
+        _words = nullptr;
+        _size = 0;
+        _capacity = 0;
+        _wordsPerRow = 0;
+    };
+
+    /**
+     * @brief Scambia lo stato interno con un altro dense_bitset
+     *
+     * Scambia anche gli allocatori
+     *
+     * @param other dense_bitset sorgente
+     */
+    void swap(basic_dense_bitset &other) noexcept
+    {
+        swapAllocators(_alloc, other._alloc);
+        std::swap(_words, other._words);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        std::swap(_wordsPerRow, other._wordsPerRow);
+        basic_dense_bitset *transposed = _transposed.load(std::memory_order_relaxed);
+        _transposed.store(other._transposed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other._transposed.store(transposed, std::memory_order_relaxed);
+    };
+
+    /**
+     * @brief Getter dell'allocatore
+     */
+    allocator_type get_allocator() const
+    {
+        return _alloc;
+    };
+
+    /**
+     * @brief Getter del numero di righe
+     *
+     * @return Numero di righe (e colonne) della matrice
+     */
+    unsigned int size() const
+    {
+        return _size;
+    };
+
+    /**
+     * @brief Getter della capacità
+     *
+     * @return Numero di righe (e colonne) allocate
+     */
+    unsigned int capacity() const
+    {
+        return _capacity;
+    };
+
+    /**
+     * @brief Getter delle parole per riga
+     *
+     * @return Numero di parole da 64 bit occupate da ogni riga
+     */
+    unsigned int wordsPerRow() const
+    {
+        return _wordsPerRow;
+    };
+
+    /**
+     * @brief Getter della riga index-esima
+     *
+     * @param index Indice della riga
+     *
+     * @pre index < capacity()
+     *
+     * @return Puntatore alla prima parola della riga
+     */
+    const word_type *row(unsigned int index) const
+    {
+        return _words + static_cast<size_t>(index) * _wordsPerRow;
+    };
+
+    /**
+     * @brief Getter della riga index-esima (modificabile)
+     *
+     * @param index Indice della riga
+     *
+     * Le scritture sulla riga non possono aggiornare la vista trasposta,
+     * che viene quindi scartata
+     *
+     * @pre index < capacity()
+     *
+     * @return Puntatore alla prima parola della riga
+     */
+    word_type *row(unsigned int index)
+    {
+        releaseTransposed();
+        return rowData(index);
+    };
+
+    /**
+     * @brief Legge il bit (i, j)
+     *
+     * @pre i < size() && j < size()
+     *
+     * @return true se il bit è impostato
+     */
+    bool test(unsigned int i, unsigned int j) const
+    {
+        return (row(i)[j / bitsPerWord] >> (j % bitsPerWord)) & 1;
+    };
+
+    /**
+     * @brief Imposta a true il bit (i, j)
+     *
+     * @pre i < size() && j < size()
+     */
+    void set(unsigned int i, unsigned int j)
+    {
+        setBit(i, j);
+        if (basic_dense_bitset *transposed = _transposed.load(std::memory_order_relaxed))
+        {
+            transposed->setBit(j, i);
+        }
+    };
+
+    /**
+     * @brief Imposta a false il bit (i, j)
+     *
+     * @pre i < size() && j < size()
+     */
+    void reset(unsigned int i, unsigned int j)
+    {
+        resetBit(i, j);
+        if (basic_dense_bitset *transposed = _transposed.load(std::memory_order_relaxed))
+        {
+            transposed->resetBit(j, i);
+        }
+    };
+
+    /**
+     * @brief Alloca spazio per almeno capacity righe e colonne
+     *
+     * In caso di eccezione la matrice resta invariata.
+     *
+     * @param capacity Numero di righe e colonne da poter contenere
+     */
+    void reserve(unsigned int capacity)
+    {
+        if (capacity <= _capacity)
+        {
+            return;
+        }
+        basic_dense_bitset tmp(_size, capacity, _alloc);
+        tmp.copyRows(*this);
+
+        tmp.swap(*this);
+        // La vista trasposta è rimasta a tmp: la faccio crescere e la riprendo
+        basic_dense_bitset *transposed = tmp._transposed.exchange(nullptr, std::memory_order_relaxed);
+        updateTransposed(transposed, [capacity](basic_dense_bitset &t) { t.reserve(capacity); });
+    };
+
+    /**
+     * @brief Riduce la capacità alla dimensione attuale
+     *
+     * Libera anche la vista trasposta. In caso di eccezione la matrice
+     * resta invariata.
+     */
+    void shrink_to_fit()
+    {
+        releaseTransposed();
+        if (_capacity == _size)
+        {
+            return;
+        }
+        basic_dense_bitset tmp(*this, _alloc);
+
+        tmp.swap(*this);
+    };
+
+    /**
+     * @brief true se la vista trasposta è già stata costruita
+     *
+     * Con la vista presente set e reset scrivono anche sulla colonna,
+     * quindi non possono avvenire da più thread su righe diverse
+     */
+    bool hasTransposed() const
+    {
+        return _transposed.load(std::memory_order_acquire) != nullptr;
+    };
+
+    /**
+     * @brief Libera la vista trasposta
+     *
+     * Verrà ricostruita alla prossima richiesta dei predecessori
+     */
+    void releaseTransposed()
+    {
+        destroyView(_transposed.exchange(nullptr, std::memory_order_relaxed));
+    };
+
+    /**
+     * @brief Ridimensiona la matrice
+     *
+     * Mantiene i bit comuni alle due dimensioni; i nuovi bit sono a false.
+     * Entro la capacità non alloca e non lancia eccezioni; oltre la capacità
+     * rialloca almeno raddoppiandola e in caso di eccezione la matrice resta
+     * invariata.
+     *
+     * @param newSize Nuovo numero di righe e colonne
+     */
+    void resize(unsigned int newSize)
+    {
+        if (newSize > _capacity)
+        {
+            reserve(std::max(newSize, _capacity * 2));
+        }
+        // Azzero righe e colonne che escono dal quadrato
+        for (unsigned int i = newSize; i < _size; i++)
+        {
+            std::fill(rowData(i), rowData(i) + _wordsPerRow, word_type(0));
+        }
+        for (unsigned int j = newSize; j < _size; j++)
+        {
+            for (unsigned int i = 0; i < newSize; i++)
+            {
+                resetBit(i, j);
+            }
+        }
+        _size = newSize;
+        updateTransposed(_transposed.exchange(nullptr, std::memory_order_relaxed),
+                         [newSize](basic_dense_bitset &t) { t.resize(newSize); });
+    };
+
+    /**
+     * @brief Rimuove una riga e la rispettiva colonna
+     *
+     * Le righe e colonne successive a index scalano di una posizione.
+     * Lavora sul posto: non alloca e non lancia eccezioni.
+     *
+     * @param index Indice della riga e colonna da rimuovere
+     *
+     * @pre index < size()
+     */
+    void erase(unsigned int index)
+    {
+        // Sposto in su le righe successive
+        if (index + 1 < _size)
+        {
+            std::memmove(rowData(index), rowData(index + 1),
+                         static_cast<size_t>(_size - index - 1) * _wordsPerRow * sizeof(word_type));
+        }
+        std::fill(rowData(_size - 1), rowData(_size - 1) + _wordsPerRow, word_type(0));
+        _size--;
+
+        // Tolgo la colonna da ogni riga rimasta
+        for (unsigned int i = 0; i < _size; i++)
+        {
+            eraseBit(rowData(i), index);
+        }
+        if (basic_dense_bitset *transposed = _transposed.load(std::memory_order_relaxed))
+        {
+            transposed->erase(index);
+        }
+    };
+
+    /**
+     * @brief Azzera una riga e la rispettiva colonna
+     *
+     * Toglie tutti gli archi entranti e uscenti da index senza spostare
+     * le altre righe e colonne. Non alloca e non lancia eccezioni.
+     *
+     * @param index Indice della riga e colonna da azzerare
+     *
+     * @pre index < size()
+     */
+    void clear(unsigned int index)
+    {
+        std::fill(rowData(index), rowData(index) + _wordsPerRow, word_type(0));
+        for (unsigned int i = 0; i < _size; i++)
+        {
+            resetBit(i, index);
+        }
+        if (basic_dense_bitset *transposed = _transposed.load(std::memory_order_relaxed))
+        {
+            transposed->clear(index);
+        }
+    };
+
+    /**
+     * @brief Compatta la matrice togliendo le righe e colonne scartate
+     *
+     * La riga e la colonna i finiscono in posizione remap[i]; quelle con
+     * remap[i] == discarded vengono tolte e devono essere già azzerate.
+     * La rinumerazione deve conservare l'ordine. Costa O(size()^2 / 64)
+     * più il numero di archi. In caso di eccezione la matrice resta
+     * invariata.
+     *
+     * @param remap Nuova posizione di ogni riga, discarded se da togliere
+     * @param newSize Numero di righe che restano
+     */
+    void compact(const unsigned int *remap, unsigned int newSize)
+    {
+        word_type *buffer = word_traits::allocate(_alloc, _wordsPerRow);
+
+        for (unsigned int i = 0; i < _size; i++)
+        {
+            if (remap[i] == discarded)
+            {
+                continue;
+            }
+            // Raccolgo i bit della riga nelle nuove colonne
+            std::fill(buffer, buffer + _wordsPerRow, word_type(0));
+            const word_type *src = rowData(i);
+            for (unsigned int w = 0; w < _wordsPerRow; w++)
+            {
+                for (word_type bits = src[w]; bits != 0; bits &= bits - 1)
+                {
+                    unsigned int j = remap[w * bitsPerWord + countTrailingZeros(bits)];
+                    buffer[j / bitsPerWord] |= word_type(1) << (j % bitsPerWord);
+                }
+            }
+            std::memcpy(rowData(remap[i]), buffer, _wordsPerRow * sizeof(word_type));
+        }
+        for (unsigned int i = newSize; i < _size; i++)
+        {
+            std::fill(rowData(i), rowData(i) + _wordsPerRow, word_type(0));
+        }
+        _size = newSize;
+
+        word_traits::deallocate(_alloc, buffer, _wordsPerRow);
+        updateTransposed(_transposed.exchange(nullptr, std::memory_order_relaxed),
+                         [remap, newSize](basic_dense_bitset &t) { t.compact(remap, newSize); });
+    };
+
+    /**
+     * @brief Chiama f(j) per ogni successore j di index, in ordine
+     *
+     * Salta le parole vuote e trova i bit a 1 con countTrailingZeros.
+     *
+     * @pre index < size()
+     */
+    template <typename F>
+    void forEachSuccessor(unsigned int index, F f) const
+    {
+        const word_type *words = row(index);
+        for (unsigned int w = 0; w < wordsFor(_size); w++)
+        {
+            for (word_type bits = words[w]; bits != 0; bits &= bits - 1)
+            {
+                f(w * bitsPerWord + countTrailingZeros(bits));
+            }
+        }
+    };
+
+    /**
+     * @brief Successori del nodo index-esimo, in ordine crescente
+     *
+     * Visita i bit a 1 della riga saltando le parole vuote
+     *
+     * @pre index < size()
+     */
+    successor_range successors(unsigned int index) const
+    {
+        return successor_range(bit_iterator(row(index), wordsFor(_size)),
+                               bit_iterator(row(index), wordsFor(_size), true));
+    };
+
+    /**
+     * @brief Predecessori del nodo index-esimo, in ordine crescente
+     *
+     * Visita la riga index della vista trasposta, costruita alla prima
+     * chiamata (vedi transposed()), quindi costa quanto i successori
+     *
+     * @pre index < size()
+     */
+    predecessor_range predecessors(unsigned int index) const
+    {
+        const basic_dense_bitset &reverse = transposed();
+        return predecessor_range(bit_iterator(reverse.row(index), wordsFor(_size)),
+                                 bit_iterator(reverse.row(index), wordsFor(_size), true));
+    };
+
+    /**
+     * @brief Matrice trasposta
+     *
+     * Il bit (j, i) del risultato vale 1 se e solo se vale 1 il bit (i, j).
+     * La matrice viene scandita per blocchi di 64 x 64 bit: ogni blocco
+     * viene letto (64 parole da 64 righe consecutive), trasposto nei
+     * registri e scritto nel blocco simmetrico, così da leggere e scrivere
+     * solo 512 byte per volta invece di una riga intera per ogni bit.
+     * Costa O(size()^2 / 64).
+     *
+     * @return Matrice trasposta, con la stessa capacità
+     */
+    basic_dense_bitset transpose() const
+    {
+        basic_dense_bitset result(_size, _capacity, _alloc);
+        transposeInto(result);
+        return result;
+    };
+
+    /**
+     * @brief Vista trasposta, mantenuta insieme alla matrice
+     *
+     * La riga j della vista contiene i predecessori di j. Viene costruita
+     * con transpose() alla prima chiamata e da lì aggiornata da ogni
+     * modifica. Più thread possono chiamarla insieme: se la costruiscono
+     * contemporaneamente ne viene tenuta una sola.
+     */
+    const basic_dense_bitset &transposed() const
+    {
+        basic_dense_bitset *reverse = _transposed.load(std::memory_order_acquire);
+        if (reverse == nullptr)
+        {
+            basic_dense_bitset *built = createView();
+            transposeInto(*built);
+            if (_transposed.compare_exchange_strong(reverse, built, std::memory_order_acq_rel))
+            {
+                reverse = built;
+            }
+            else
+            {
+                destroyView(built);
+            }
+        }
+        return *reverse;
+    };
+
+    /**
+     * @brief Numero di successori del nodo index-esimo
+     *
+     * Popcount vettorizzato della riga (vedi bitset_kernels)
+     *
+     * @pre index < size()
+     */
+    unsigned int outDegree(unsigned int index) const
+    {
+        return static_cast<unsigned int>(bitset_kernels::get().popcount(row(index), wordsFor(_size)));
+    };
+
+    /**
+     * @brief Numero di predecessori del nodo index-esimo
+     *
+     * Conta i bit a 1 della riga della vista trasposta, se già costruita;
+     * altrimenti somma direttamente il bit della colonna di ogni riga, senza
+     * allocare: una parola letta per riga, come per column()
+     *
+     * @pre index < size()
+     */
+    unsigned int inDegree(unsigned int index) const
+    {
+        if (const basic_dense_bitset *reverse = _transposed.load(std::memory_order_acquire))
+        {
+            return reverse->outDegree(index);
+        }
+        const word_type *word = _words + index / bitsPerWord;
+        const unsigned int shift = index % bitsPerWord;
+        unsigned int degree = 0;
+        for (unsigned int i = 0; i < _size; i++, word += _wordsPerRow)
+        {
+            degree += static_cast<unsigned int>((*word >> shift) & 1);
+        }
+        return degree;
+    };
+
+    /**
+     * @brief Estrae la colonna index come sequenza di bit
+     *
+     * Il bit i di out vale 1 se esiste l'arco (i, index)
+     *
+     * @param index Indice della colonna
+     * @param out Destinazione, di almeno wordsFor(size()) parole
+     *
+     * @pre index < size()
+     */
+    void column(unsigned int index, word_type *out) const
+    {
+        for (unsigned int first = 0; first < _size; first += bitsPerWord)
+        {
+            out[first / bitsPerWord] = columnWord(index, first);
+        }
+    };
+
+    /**
+     * @brief Successori comuni a due nodi, in ordine crescente
+     *
+     * AND vettorizzato delle due righe, poi enumerazione dei bit a 1
+     *
+     * @param out Riceve gli indici dei successori comuni
+     *
+     * @pre i < size() && j < size()
+     */
+    void commonSuccessors(unsigned int i, unsigned int j, std::vector<unsigned int> &out) const
+    {
+        const unsigned int words = wordsFor(_size);
+        std::vector<word_type, allocator_type> common(words, word_type(0), _alloc);
+        bitset_kernels::get().andRows(common.data(), row(i), row(j), words);
+        out.clear();
+        out.reserve(bitset_kernels::get().popcount(common.data(), words));
+        for (unsigned int w = 0; w < words; w++)
+        {
+            for (word_type bits = common[w]; bits != 0; bits &= bits - 1)
+            {
+                out.push_back(w * bitsPerWord + countTrailingZeros(bits));
+            }
+        }
+    };
+
+    /**
+     * @brief Aggiunge gli archi di other (unione)
+     *
+     * @pre other.size() == size()
+     */
+    void uniteWith(const basic_dense_bitset &other)
+    {
+        combine(other, bitset_kernels::get().orRows);
+    };
+
+    /**
+     * @brief Tiene solo gli archi presenti anche in other (intersezione)
+     *
+     * @pre other.size() == size()
+     */
+    void intersectWith(const basic_dense_bitset &other)
+    {
+        combine(other, bitset_kernels::get().andRows);
+    };
+
+    /**
+     * @brief Toglie gli archi presenti in other (differenza)
+     *
+     * @pre other.size() == size()
+     */
+    void subtract(const basic_dense_bitset &other)
+    {
+        combine(other, bitset_kernels::get().andNotRows);
+    };
+
+private:
+
+    /**
+     * @brief Scambia gli allocatori se il loro tipo si propaga
+     *
+     * Gli allocatori che non si propagano mai (come
+     * std::pmr::polymorphic_allocator) restano al loro posto: in quel caso
+     * swap richiede allocatori uguali
+     */
+    static void swapAllocators(allocator_type &first, allocator_type &second) noexcept
+    {
+        swapAllocators(first, second,
+                       std::integral_constant<bool, word_traits::propagate_on_container_copy_assignment::value ||
+                                                        word_traits::propagate_on_container_move_assignment::value ||
+                                                        word_traits::propagate_on_container_swap::value>());
+    };
+
+    static void swapAllocators(allocator_type &first, allocator_type &second, std::true_type) noexcept
+    {
+        std::swap(first, second);
+    };
+
+    static void swapAllocators(allocator_type &, allocator_type &, std::false_type) noexcept {};
+    /**
+     * @brief Riga index-esima, senza toccare la vista trasposta
+     */
+    word_type *rowData(unsigned int index)
+    {
+        return _words + static_cast<size_t>(index) * _wordsPerRow;
+    };
+
+    /**
+     * @brief Imposta a true il bit (i, j), senza toccare la vista trasposta
+     */
+    void setBit(unsigned int i, unsigned int j)
+    {
+        rowData(i)[j / bitsPerWord] |= word_type(1) << (j % bitsPerWord);
+    };
+
+    /**
+     * @brief Imposta a false il bit (i, j), senza toccare la vista trasposta
+     */
+    void resetBit(unsigned int i, unsigned int j)
+    {
+        rowData(i)[j / bitsPerWord] &= ~(word_type(1) << (j % bitsPerWord));
+    };
+
+    /**
+     * @brief Applica update alla vista trasposta e la rimette al suo posto
+     *
+     * La vista è solo una cache: se update lancia un'eccezione viene
+     * scartata e sarà ricostruita alla prossima richiesta.
+     *
+     * @param transposed Vista tolta dalla matrice, può essere nullptr
+     */
+    template <typename F>
+    void updateTransposed(basic_dense_bitset *transposed, F update)
+    {
+        if (transposed == nullptr)
+        {
+            return;
+        }
+        try
+        {
+            update(*transposed);
+        }
+        catch (...)
+        {
+            destroyView(transposed);
+            return;
+        }
+        _transposed.store(transposed, std::memory_order_relaxed);
+    };
+
+    /**
+     * @brief Alloca con _alloc una vista vuota della stessa dimensione
+     */
+    basic_dense_bitset *createView() const
+    {
+        view_allocator alloc(_alloc);
+        basic_dense_bitset *view = view_traits::allocate(alloc, 1);
+        try
+        {
+            view_traits::construct(alloc, view, _size, _capacity, _alloc);
+        }
+        catch (...)
+        {
+            view_traits::deallocate(alloc, view, 1);
+            throw;
+        }
+        return view;
+    };
+
+    /**
+     * @brief Distrugge una vista creata da createView, può essere nullptr
+     */
+    void destroyView(basic_dense_bitset *view) const
+    {
+        if (view != nullptr)
+        {
+            view_allocator alloc(_alloc);
+            view_traits::destroy(alloc, view);
+            view_traits::deallocate(alloc, view, 1);
+        }
+    };
+
+    /**
+     * @brief Scrive la trasposta in out, che è vuoto e della stessa dimensione
+     */
+    void transposeInto(basic_dense_bitset &out) const
+    {
+        const unsigned int blocks = wordsFor(_size);
+        word_type block[bitsPerWord];
+        for (unsigned int bi = 0; bi < blocks; bi++)
+        {
+            const unsigned int rows = _size - bi * bitsPerWord < bitsPerWord ? _size - bi * bitsPerWord : bitsPerWord;
+            for (unsigned int bj = 0; bj < blocks; bj++)
+            {
+                for (unsigned int r = 0; r < rows; r++)
+                {
+                    block[r] = row(bi * bitsPerWord + r)[bj];
+                }
+                std::fill(block + rows, block + bitsPerWord, word_type(0));
+                transposeBlock(block);
+                const unsigned int columns =
+                    _size - bj * bitsPerWord < bitsPerWord ? _size - bj * bitsPerWord : bitsPerWord;
+                for (unsigned int c = 0; c < columns; c++)
+                {
+                    out.rowData(bj * bitsPerWord + c)[bi] = block[c];
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Traspone sul posto un blocco di 64 x 64 bit
+     *
+     * Il bit c della parola r finisce nel bit r della parola c. Scambia
+     * ricorsivamente i quadranti fuori diagonale, prima di 32 x 32 bit e poi
+     * via via più piccoli, con 6 passate di maschere e shift.
+     */
+    static void transposeBlock(word_type *block)
+    {
+        word_type mask = 0x00000000FFFFFFFFULL;
+        for (unsigned int width = 32; width != 0; width >>= 1, mask ^= mask << width)
+        {
+            for (unsigned int k = 0; k < bitsPerWord; k = ((k | width) + 1) & ~width)
+            {
+                word_type t = ((block[k] >> width) ^ block[k | width]) & mask;
+                block[k] ^= t << width;
+                block[k | width] ^= t;
+            }
+        }
+    };
+
+    /**
+     * @brief Applica op riga per riga con other
+     */
+    void combine(const basic_dense_bitset &other,
+                 void (*op)(word_type *, const word_type *, const word_type *, size_t))
+    {
+        const unsigned int words = wordsFor(_size);
+        releaseTransposed();
+        for (unsigned int i = 0; i < _size; i++)
+        {
+            op(rowData(i), rowData(i), other.row(i), words);
+        }
+    };
+
+    /**
+     * @brief Bit della colonna index nelle righe [first, first + 64)
+     *
+     * Il bit k del risultato vale 1 se esiste l'arco (first + k, index)
+     */
+    word_type columnWord(unsigned int index, unsigned int first) const
+    {
+        const unsigned int last = std::min(_size, first + bitsPerWord);
+        const unsigned int w = index / bitsPerWord;
+        const unsigned int shift = index % bitsPerWord;
+        word_type packed = 0;
+        for (unsigned int i = first; i < last; i++)
+        {
+            packed |= ((row(i)[w] >> shift) & 1) << (i - first);
+        }
+        return packed;
+    };
+
+    /**
+     * @brief Numero totale di parole allocate
+     */
+    size_t totalWords() const
+    {
+        return static_cast<size_t>(_capacity) * _wordsPerRow;
+    };
+
+    /**
+     * @brief Copia le righe di other, che ha la stessa dimensione
+     *
+     * @pre other.size() == size()
+     */
+    void copyRows(const basic_dense_bitset &other)
+    {
+        unsigned int words = std::min(_wordsPerRow, other._wordsPerRow);
+        for (unsigned int i = 0; i < _size; i++)
+        {
+            std::memcpy(rowData(i), other.row(i), words * sizeof(word_type));
+        }
+    };
+
+    /**
+     * @brief Toglie da una riga il bit in posizione bit
+     *
+     * I bit successivi a quello rimosso scalano di una posizione verso il
+     * basso, anche a cavallo tra due parole. Lavora sul posto.
+     *
+     * @param words Riga da modificare
+     * @param bit Posizione del bit da togliere
+     */
+    void eraseBit(word_type *words, unsigned int bit) const
+    {
+        unsigned int first = bit / bitsPerWord;
+        word_type low = (word_type(1) << (bit % bitsPerWord)) - 1;
+        for (unsigned int w = first; w < _wordsPerRow; w++)
+        {
+            word_type shifted = words[w] >> 1;
+            if (w + 1 < _wordsPerRow)
+            {
+                shifted |= words[w + 1] << (bitsPerWord - 1);
+            }
+
+            if (w == first)
+            {
+                words[w] = (words[w] & low) | (shifted & ~low);
+            }
+            else
+            {
+                words[w] = shifted;
+            }
+        }
+    };
+};
+
+template <typename Allocator>
+const unsigned int basic_dense_bitset<Allocator>::bitsPerWord;
+
+template <typename Allocator>
+const unsigned int basic_dense_bitset<Allocator>::discarded;
+
+/**
+ * @brief Matrice di adiacenza compatta con std::allocator
+ */
+typedef basic_dense_bitset<> dense_bitset;
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef EDGE_LIST_LOADER_H
+#define EDGE_LIST_LOADER_H
+
+#include <algorithm> // std::min
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <type_traits> // std::is_trivially_copyable
+#include <unordered_set>
+#include <utility> // std::pair
+#include <vector>
+#include <stddef.h> // size_t
+#include "graph.h"
+#include "thread_pool.h"
+
+/**
+ * @file edge_list_loader.h
+ * @brief Caricamento in blocco di liste di archi
+ *
+ * Due formati:
+ * - testo: coppie "origine destinazione" separate da spazi o a capo, lette
+ *   con operator>> su T;
+ * - binario: coppie di T scritte byte per byte una dopo l'altra (T deve
+ *   essere trivially copyable).
+ *
+ * Lo stream viene letto a blocchi; ogni gruppo di blocchi viene
+ * interpretato in parallelo sul thread_pool. Solo dopo aver letto tutto lo
+ * stream il graph viene modificato:
+ * 1. i nomi nuovi vengono raccolti in ordine di prima apparizione e il
+ *    graph viene fatto crescere una volta sola (graph::reserve);
+ * 2. le coppie vengono tradotte in posizioni in parallelo, ordinate per
+ *    origine con un counting sort e applicate riga per riga, in parallelo
+ *    con dense_bitset.
+ *
+ * Se lo stream contiene un errore viene lanciato un errore e il graph resta
+ * invariato.
+ */
+
+/**
+ * @brief Caricatore di liste di archi in un graph
+ *
+ * @tparam T Tipo del nome dei nodi
+ * @tparam Storage Politica di memorizzazione del graph
+ * @tparam Hash Funtore di hash su T
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ * @tparam Allocator Allocatore del graph
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+class edge_list_loader
+{
+public:
+    typedef graph<T, Storage, Hash, KeyEqual, Allocator> graph_type;
+    typedef std::pair<T, T> edge_type;
+
+    static const size_t chunkBytes = 1 << 20; ///< Byte letti per ogni blocco
+    static const size_t chunksPerRound = 8;   ///< Blocchi per thread interpretati insieme
+
+private:
+    graph_type &_graph;                         ///< graph da riempire
+    thread_pool *_pool;                         ///< thread_pool, nullptr per il caricamento seriale
+    std::vector<std::vector<edge_type> > _chunks; ///< Coppie lette, un vettore per blocco
+
+public:
+    /**
+     * @brief Costruttore
+     *
+     * @param gr graph da riempire
+     * @param pool thread_pool da usare, nullptr per il caricamento seriale
+     */
+    edge_list_loader(graph_type &gr, thread_pool *pool) : _graph(gr), _pool(pool), _chunks(){};
+
+    /**
+     * @brief Legge coppie in formato testo fino alla fine dello stream
+     */
+    void readText(std::istream &in)
+    {
+        std::vector<std::string> texts;
+        while (in)
+        {
+            texts.clear();
+            for (size_t c = 0; c < roundSize() && in; c++)
+            {
+                std::string text(chunkBytes, '\0');
+                in.read(&text[0], chunkBytes);
+                text.resize(static_cast<size_t>(in.gcount()));
+                if (text.size() == chunkBytes)
+                {
+                    // Completo l'ultima riga per non spezzare una coppia
+                    std::string rest;
+                    std::getline(in, rest);
+                    text += rest;
+                    text += '\n';
+                }
+                texts.push_back(text);
+            }
+
+            size_t first = _chunks.size();
+            _chunks.resize(first + texts.size());
+            parallelFor(_pool, texts.size(), [&](size_t c) { parseText(texts[c], _chunks[first + c]); });
+        }
+    };
+
+    /**
+     * @brief Legge coppie in formato binario fino alla fine dello stream
+     */
+    void readBinary(std::istream &in)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "il formato binario richiede T trivially copyable");
+        const size_t pairsPerChunk = chunkBytes / (2 * sizeof(T)) + 1;
+        std::vector<T> raw(2 * pairsPerChunk);
+        while (in)
+        {
+            in.read(reinterpret_cast<char *>(raw.data()), raw.size() * sizeof(T));
+            size_t bytes = static_cast<size_t>(in.gcount());
+            if (bytes % (2 * sizeof(T)) != 0)
+            {
+                // Coppia troncata
+                throw 1;
+            }
+            // Nessun testo da interpretare: basta una copia seriale
+            _chunks.push_back(std::vector<edge_type>(bytes / (2 * sizeof(T))));
+            std::vector<edge_type> &pairs = _chunks.back();
+            for (size_t k = 0; k < pairs.size(); k++)
+            {
+                pairs[k].first = raw[2 * k];
+                pairs[k].second = raw[2 * k + 1];
+            }
+        }
+    };
+
+    /**
+     * @brief Aggiunge al graph i nodi e gli archi letti
+     */
+    void apply()
+    {
+        addNewNodes();
+
+        // Traduco i nomi in posizioni, un blocco per iterazione
+        std::vector<std::vector<std::pair<unsigned int, unsigned int> > > resolved(_chunks.size());
+        const graph_type &gr = _graph;
+        parallelFor(_pool, _chunks.size(), [&](size_t c) {
+            resolved[c].reserve(_chunks[c].size());
+            for (size_t k = 0; k < _chunks[c].size(); k++)
+            {
+                resolved[c].push_back(std::make_pair(static_cast<unsigned int>(gr.indexOf(_chunks[c][k].first)),
+                                                     static_cast<unsigned int>(gr.indexOf(_chunks[c][k].second))));
+            }
+            std::vector<edge_type>().swap(_chunks[c]);
+        });
+
+        // Counting sort per origine
+        const unsigned int n = _graph.slots();
+        std::vector<size_t> offsets(n + 1, 0);
+        for (size_t c = 0; c < resolved.size(); c++)
+        {
+            for (size_t k = 0; k < resolved[c].size(); k++)
+            {
+                offsets[resolved[c][k].first + 1]++;
+            }
+        }
+        for (unsigned int i = 0; i < n; i++)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<unsigned int> targets(offsets[n]);
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for (size_t c = 0; c < resolved.size(); c++)
+        {
+            for (size_t k = 0; k < resolved[c].size(); k++)
+            {
+                targets[next[resolved[c][k].first]++] = resolved[c][k].second;
+            }
+            std::vector<std::pair<unsigned int, unsigned int> >().swap(resolved[c]);
+        }
+
+        applyRows(_graph.adjacency(), offsets, targets);
+    };
+
+private:
+    /**
+     * @brief Blocchi da leggere prima di interpretarli in parallelo
+     */
+    size_t roundSize() const
+    {
+        return _pool == nullptr ? 1 : chunksPerRound * _pool->size();
+    };
+
+    /**
+     * @brief Interpreta un blocco di testo
+     */
+    static void parseText(const std::string &text, std::vector<edge_type> &pairs)
+    {
+        std::istringstream in(text);
+        T origin, destination;
+        while (in >> origin)
+        {
+            if (!(in >> destination))
+            {
+                throw 1;
+            }
+            pairs.push_back(edge_type(origin, destination));
+        }
+        if (!in.eof())
+        {
+            // Un nome non interpretabile come T
+            throw 1;
+        }
+    };
+
+    /**
+     * @brief Aggiunge i nomi nuovi, in ordine di prima apparizione
+     *
+     * Il graph viene fatto crescere una volta sola
+     */
+    void addNewNodes()
+    {
+        std::unordered_set<T, Hash, KeyEqual> seen(16, _graph.hashFunction(), _graph.keyEqual());
+        std::vector<T> names;
+        for (size_t c = 0; c < _chunks.size(); c++)
+        {
+            for (size_t k = 0; k < _chunks[c].size(); k++)
+            {
+                const T *ends[2] = {&_chunks[c][k].first, &_chunks[c][k].second};
+                for (int e = 0; e < 2; e++)
+                {
+                    if (!_graph.exists(*ends[e]) && seen.insert(*ends[e]).second)
+                    {
+                        names.push_back(*ends[e]);
+                    }
+                }
+            }
+        }
+
+        _graph.reserve(_graph.slots() + static_cast<unsigned int>(names.size()));
+        for (size_t k = 0; k < names.size(); k++)
+        {
+            _graph.addNode(names[k]);
+        }
+    };
+
+    /**
+     * @brief Applica gli archi con dense_bitset, in parallelo per righe
+     *
+     * Ogni iterazione possiede un intervallo di origini e quindi di righe.
+     * Con la vista trasposta o con un journal gli archi vanno applicati in
+     * serie.
+     */
+    template <typename A>
+    void applyRows(const basic_dense_bitset<A> &matrix, const std::vector<size_t> &offsets,
+                   const std::vector<unsigned int> &targets)
+    {
+        if (matrix.hasTransposed() || _graph.journal() != nullptr)
+        {
+            applyRowsSerial(offsets, targets);
+            return;
+        }
+        const unsigned int n = _graph.slots();
+        const size_t rowsPerChunk = 1024;
+        parallelFor(_pool, (n + rowsPerChunk - 1) / rowsPerChunk, [&](size_t c) {
+            unsigned int last = static_cast<unsigned int>(std::min<size_t>(n, (c + 1) * rowsPerChunk));
+            for (unsigned int i = static_cast<unsigned int>(c * rowsPerChunk); i < last; i++)
+            {
+                for (size_t k = offsets[i]; k < offsets[i + 1]; k++)
+                {
+                    _graph.addEdgeAt(i, targets[k]);
+                }
+            }
+        });
+    };
+
+    /**
+     * @brief Politiche senza righe indipendenti: archi in ordine di origine
+     *
+     * Con sparse_adjacency l'ordine per origine fa sì che ogni inserimento
+     * nelle liste dei predecessori avvenga in fondo
+     */
+    template <typename Other>
+    void applyRows(const Other &, const std::vector<size_t> &offsets, const std::vector<unsigned int> &targets)
+    {
+        applyRowsSerial(offsets, targets);
+    };
+
+    void applyRowsSerial(const std::vector<size_t> &offsets, const std::vector<unsigned int> &targets)
+    {
+        for (unsigned int i = 0; i + 1 < offsets.size(); i++)
+        {
+            for (size_t k = offsets[i]; k < offsets[i + 1]; k++)
+            {
+                _graph.addEdgeAt(i, targets[k]);
+            }
+        }
+    };
+};
+
+/**
+ * @brief Carica archi in formato testo da uno stream
+ *
+ * @param gr graph a cui aggiungere nodi e archi
+ * @param in Stream di coppie "origine destinazione"
+ * @param pool thread_pool da usare, nullptr per il caricamento seriale
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+void loadEdgeList(graph<T, Storage, Hash, KeyEqual, Allocator> &gr, std::istream &in, thread_pool *pool = nullptr)
+{
+    edge_list_loader<T, Storage, Hash, KeyEqual, Allocator> loader(gr, pool);
+    loader.readText(in);
+    loader.apply();
+}
+
+/**
+ * @brief Carica archi in formato testo da un file
+ *
+ * Lancia un errore se il file non può essere aperto
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+void loadEdgeListFile(graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const char *path, thread_pool *pool = nullptr)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw 1;
+    }
+    loadEdgeList(gr, in, pool);
+}
+
+/**
+ * @brief Carica archi in formato binario da uno stream
+ *
+ * @param gr graph a cui aggiungere nodi e archi
+ * @param in Stream binario di coppie di T
+ * @param pool thread_pool da usare, nullptr per il caricamento seriale
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+void loadBinaryEdgeList(graph<T, Storage, Hash, KeyEqual, Allocator> &gr, std::istream &in, thread_pool *pool = nullptr)
+{
+    edge_list_loader<T, Storage, Hash, KeyEqual, Allocator> loader(gr, pool);
+    loader.readBinary(in);
+    loader.apply();
+}
+
+/**
+ * @brief Carica archi in formato binario da un file
+ *
+ * Lancia un errore se il file non può essere aperto
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+void loadBinaryEdgeListFile(graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const char *path, thread_pool *pool = nullptr)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        throw 1;
+    }
+    loadBinaryEdgeList(gr, in, pool);
+}
+
+#endif
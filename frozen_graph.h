@@ -0,0 +1,282 @@
+#ifndef FROZEN_GRAPH_H
+#define FROZEN_GRAPH_H
+
+#include <cassert>
+#include <memory> // std::shared_ptr
+#include <vector>
+#include <algorithm>  // std::lower_bound
+#include <functional> // std::hash, std::equal_to
+#include <stddef.h>   // size_t
+#include "node_index.h"
+#include "adjacency_ranges.h"
+
+/**
+ * @file frozen_graph.h
+ * @brief Dichiarazione della classe frozen_graph
+ */
+
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+class graph;
+
+/**
+ * @brief Fotografia immutabile di un graph in formato CSR
+ *
+ * Si ottiene con graph::freeze(). Gli archi sono memorizzati in formato CSR
+ * (compressed sparse row): per ogni nodo i i successori sono
+ * targets[offsets[i] .. offsets[i + 1]) in ordine crescente, e allo stesso
+ * modo i predecessori in sources[reverseOffsets[i] .. reverseOffsets[i + 1]).
+ * I nodi rimossi del graph di partenza non compaiono e gli indici sono
+ * contigui da 0 a size() - 1.
+ *
+ * I dati non cambiano mai dopo la costruzione e sono condivisi tra le copie
+ * tramite shared_ptr: copiare un frozen_graph costa O(1) e più thread
+ * possono interrogarlo contemporaneamente senza lock.
+ *
+ * @tparam T Tipo del nome dei nodi
+ * @tparam Hash Funtore di hash su T
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ */
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T> >
+class frozen_graph
+{
+public:
+    struct node
+    {
+        T name;
+    };
+
+    typedef iterator_range<const unsigned int *> index_range; ///< Intervallo in uno degli array CSR
+
+private:
+    /**
+     * @brief Dati condivisi e immutabili della fotografia
+     */
+    struct data
+    {
+        std::vector<node> nodes;                ///< Nomi dei nodi
+        node_index<T, Hash, KeyEqual> index;    ///< Indice nome -> posizione
+        std::vector<size_t> offsets;            ///< Inizio dei successori di ogni nodo (N + 1)
+        std::vector<unsigned int> targets;      ///< Successori, concatenati
+        std::vector<size_t> reverseOffsets;     ///< Inizio dei predecessori di ogni nodo (N + 1)
+        std::vector<unsigned int> sources;      ///< Predecessori, concatenati
+
+        data(const Hash &hash, const KeyEqual &equal) : index(hash, equal){};
+    };
+
+    std::shared_ptr<const data> _data; ///< Dati condivisi tra le copie
+
+public:
+    /**
+     * @brief Costruttore di default
+     *
+     * Crea una fotografia vuota
+     */
+    frozen_graph() : _data(std::make_shared<data>(Hash(), KeyEqual())){};
+
+    /**
+     * @brief Costruttore da graph
+     *
+     * Costruisce la fotografia con una sola passata sugli archi del graph:
+     * i successori vengono enumerati una volta, i predecessori sono ricavati
+     * dall'array dei successori con un counting sort. Costa O(N + E) più la
+     * scansione delle righe con dense_bitset (O(N^2 / 64)).
+     *
+     * @param gr graph da fotografare
+     */
+    template <typename Storage, typename Allocator>
+    explicit frozen_graph(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr) : _data()
+    {
+        std::shared_ptr<data> d = std::make_shared<data>(gr.hashFunction(), gr.keyEqual());
+
+        // Nuova posizione di ogni nodo vivo
+        std::vector<unsigned int> remap(gr.slots());
+        d->nodes.reserve(gr.size());
+        for (unsigned int i = 0; i < gr.slots(); i++)
+        {
+            if (gr.isAlive(i))
+            {
+                remap[i] = static_cast<unsigned int>(d->nodes.size());
+                node nd = {gr.nodeFromIndex(i).name};
+                d->nodes.push_back(nd);
+            }
+        }
+        unsigned int n = static_cast<unsigned int>(d->nodes.size());
+        d->index.reserve(n, d->nodes.data());
+        for (unsigned int i = 0; i < n; i++)
+        {
+            d->index.insert(d->nodes[i].name, i, d->nodes.data());
+        }
+
+        // Successori, già in ordine crescente perché remap conserva l'ordine
+        std::vector<size_t> inDegree(n + 1, 0);
+        d->offsets.reserve(n + 1);
+        d->offsets.push_back(0);
+        for (unsigned int i = 0; i < gr.slots(); i++)
+        {
+            if (!gr.isAlive(i))
+            {
+                continue;
+            }
+            std::vector<unsigned int> &targets = d->targets;
+            gr.adjacency().forEachSuccessor(i, [&](unsigned int j) {
+                targets.push_back(remap[j]);
+                inDegree[remap[j] + 1]++;
+            });
+            d->offsets.push_back(targets.size());
+        }
+
+        // Predecessori con counting sort sugli archi
+        for (unsigned int i = 0; i < n; i++)
+        {
+            inDegree[i + 1] += inDegree[i];
+        }
+        d->reverseOffsets = inDegree;
+        d->sources.resize(d->targets.size());
+        for (unsigned int i = 0; i < n; i++)
+        {
+            for (size_t k = d->offsets[i]; k < d->offsets[i + 1]; k++)
+            {
+                d->sources[inDegree[d->targets[k]]++] = i;
+            }
+        }
+
+        _data = d;
+    };
+
+    /**
+     * @brief Getter del numero di nodi
+     */
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(_data->nodes.size());
+    };
+
+    /**
+     * @brief Getter del numero di archi
+     */
+    size_t edges() const
+    {
+        return _data->targets.size();
+    };
+
+    /**
+     * @brief Getter del nodo index-esimo
+     *
+     * @pre index < size()
+     */
+    const node &nodeFromIndex(unsigned int index) const
+    {
+        assert(index < size());
+
+        return _data->nodes[index];
+    };
+
+    /**
+     * @brief Posizione di un nodo dato il nome
+     *
+     * @return Indice del nodo, -1 se non esiste
+     */
+    int indexOf(const T &nodeName) const
+    {
+        return _data->index.find(nodeName, _data->nodes.data());
+    };
+
+    /**
+     * @brief Verifica l'esistenza di un nodo
+     */
+    bool exists(const T &nodeName) const
+    {
+        return indexOf(nodeName) != -1;
+    };
+
+    /**
+     * @brief Verifica l'esistenza di un arco tra due nodi
+     *
+     * Lancia un errore se uno dei due nodi non esiste, come graph::hasEdge
+     *
+     * @param origin_node Nome del nodo di origine
+     * @param destination_node Nome del nodo di destinazione
+     *
+     * @return bool per l'esistenza dell'arco
+     */
+    bool hasEdge(const T &origin_node, const T &destination_node) const
+    {
+        int origin_index = indexOf(origin_node);
+        int destination_index = indexOf(destination_node);
+        if (origin_index == -1 || destination_index == -1)
+        {
+            throw 1;
+        }
+        return hasEdgeAt(origin_index, destination_index);
+    };
+
+    /**
+     * @brief Verifica l'esistenza di un arco tra due indici
+     *
+     * Ricerca binaria tra i successori di origin
+     *
+     * @pre origin < size() && destination < size()
+     */
+    bool hasEdgeAt(unsigned int origin, unsigned int destination) const
+    {
+        index_range out = successors(origin);
+        const unsigned int *it = std::lower_bound(out.begin(), out.end(), destination);
+        return it != out.end() && *it == destination;
+    };
+
+    /**
+     * @brief Successori del nodo index-esimo, in ordine crescente
+     *
+     * @pre index < size()
+     */
+    index_range successors(unsigned int index) const
+    {
+        const unsigned int *targets = _data->targets.data();
+        return index_range(targets + _data->offsets[index], targets + _data->offsets[index + 1]);
+    };
+
+    /**
+     * @brief Predecessori del nodo index-esimo, in ordine crescente
+     *
+     * @pre index < size()
+     */
+    index_range predecessors(unsigned int index) const
+    {
+        const unsigned int *sources = _data->sources.data();
+        return index_range(sources + _data->reverseOffsets[index], sources + _data->reverseOffsets[index + 1]);
+    };
+
+    /**
+     * @brief Numero di archi uscenti dal nodo index-esimo
+     */
+    size_t outDegree(unsigned int index) const
+    {
+        return _data->offsets[index + 1] - _data->offsets[index];
+    };
+
+    /**
+     * @brief Numero di archi entranti nel nodo index-esimo
+     */
+    size_t inDegree(unsigned int index) const
+    {
+        return _data->reverseOffsets[index + 1] - _data->reverseOffsets[index];
+    };
+
+    /**
+     * @brief Array degli offset CSR dei successori (size() + 1 elementi)
+     */
+    const size_t *offsets() const
+    {
+        return _data->offsets.data();
+    };
+
+    /**
+     * @brief Array CSR dei successori (edges() elementi)
+     */
+    const unsigned int *targets() const
+    {
+        return _data->targets.data();
+    };
+};
+
+#endif
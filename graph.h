@@ -1,10 +1,23 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-#include <iostream>
+#include <ostream>
 #include <cassert>
-#include <algorithm> // std::swap
+#include <algorithm> // std::swap, std::sort, std::max
 #include <stddef.h>  // ptrdiff_t
+#include <functional> // std::hash, std::equal_to
+#include <vector>
+#include <unordered_set>
+#include <utility> // std::pair, std::move, std::forward
+#include <type_traits> // std::is_nothrow_move_assignable
+#include "dense_bitset.h"
+#include "sparse_adjacency.h"
+#include "weighted_adjacency.h"
+#include "node_index.h"
+#include "frozen_graph.h"
+#include "graph_journal.h"
+#include "graph_stats.h"
+#include "node_columns.h"
 
 /**
  * @file graph.h
@@ -15,21 +28,73 @@
  * @brief Grafo orientato
  * 
  * Classe che rappresenta un Grafo orientato
+ * 
+ * @tparam T Tipo del nome dei nodi
+ * @tparam Storage Politica di memorizzazione degli archi: dense_bitset
+ *         (matrice di bit, default) o sparse_adjacency (liste ordinate,
+ *         memoria O(N + E)); dense_weights<W> e sparse_weights<W> aggiungono
+ *         un peso per arco (vedi weighted_adjacency.h)
+ * @tparam Hash Funtore di hash su T, usato per l'indice dei nomi
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ * @tparam Allocator Allocatore per nodi, archi e indice dei nomi (anche
+ *         dei temporanei): la politica Storage viene adattata a usarlo
  */
-template <typename T>
+template <typename T, typename Storage = dense_bitset, typename Hash = std::hash<T>,
+          typename KeyEqual = std::equal_to<T>, typename Allocator = std::allocator<T> >
 class graph
 {
 public:
+    typedef Allocator allocator_type;
+    typedef typename Storage::template rebind<Allocator>::other storage_type; ///< Storage con Allocator
+    typedef graph_journal<T, typename edge_weight_of<storage_type>::type> journal_type; ///< Journal, con i pesi se storage_type li ha
+    typedef typename storage_type::successor_range successor_range;     ///< Successori di un nodo
+    typedef typename storage_type::predecessor_range predecessor_range; ///< Predecessori di un nodo
+    typedef iterator_range<edge_iterator<storage_type> > edge_range;    ///< Tutti gli archi
+
+    /**
+     * @brief Nodo, visto dall'esterno
+     *
+     * L'array di nodi contiene solo i nomi, uno dopo l'altro: le ricerche e
+     * gli iteratori non caricano altro. Se un nodo è vivo lo dice isAlive,
+     * da un array di bit a parte; gli altri dati per nodo stanno in colonne
+     * separate (vedi addColumn).
+     */
     struct node
     {
         T name;
-        bool *matrixRowPtr;
     };
 
 private:
-    node *_nodes;       ///< Puntatore all'array dinamico di nodi
-    unsigned int _size; ///< Numero di nodi
-    bool **_matrix;     ///< Puntatore alla matrice dinamica di bool
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<node> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned int> index_allocator;
+    typedef node_index<T, Hash, KeyEqual, index_allocator> index_type;
+    typedef std::vector<unsigned int, index_allocator> index_buffer; ///< Posizioni temporanee
+    typedef std::pair<unsigned int, unsigned int> edge_position;
+    typedef std::vector<edge_position, typename std::allocator_traits<Allocator>::template rebind_alloc<edge_position> >
+        edge_buffer; ///< Coppie di posizioni temporanee
+    typedef dense_bitset::word_type word_type;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<word_type> alive_allocator;
+    typedef std::vector<word_type, alive_allocator> alive_bits; ///< Un bit per posizione
+    typedef basic_node_column<Allocator> column_type;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<column_type *> column_allocator;
+    typedef std::vector<column_type *, column_allocator> column_list; ///< Colonne di dati per nodo
+
+    node_allocator _alloc;  ///< Allocatore dell'array di nodi
+    node *_nodes;           ///< Puntatore all'array dinamico di nodi (solo i nomi)
+    alive_bits _alive;      ///< Bit a 1 per i nodi non rimossi, almeno _capacity bit
+    unsigned int _size;     ///< Numero di nodi
+    unsigned int _slots;    ///< Posizioni occupate, compresi i nodi rimossi
+    unsigned int _capacity; ///< Numero di nodi per cui è allocato spazio
+    storage_type _matrix;   ///< Archi, memorizzati secondo la politica Storage
+    index_type _index;      ///< Indice hash nome -> posizione
+    double _compactionThreshold;          ///< Frazione di posizioni rimosse oltre cui compattare
+    journal_type *_journal;           ///< Registro delle modifiche, nullptr se assente
+    column_list _columns;                 ///< Colonne di dati per nodo, almeno _capacity valori
+    uint64_t _modifications;              ///< Modifiche di nodi, archi o posizioni, vedi modifications()
+#ifdef GRAPH_STATS
+    mutable graph_counters _counters;     ///< Contatori delle operazioni, vedi graph_stats.h
+#endif
 
 public:
     /**
@@ -39,9 +104,28 @@ public:
     * 
     * @post _nodes == nullptr
     * @post _size == 0
-    * @post _matrix == nullptr
+    * @post _slots == 0
+    * @post _capacity == 0
+    * @post _matrix.size() == 0
+    * 
+    * @param hash Funtore di hash per l'indice dei nomi
+    * @param equal Funtore di uguaglianza per l'indice dei nomi
+    * @param alloc Allocatore da usare
+    */
+    explicit graph(const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual(), const Allocator &alloc = Allocator())
+        : _alloc(alloc), _nodes(nullptr), _alive(alive_allocator(alloc)), _size(0), _slots(0), _capacity(0),
+          _matrix(typename storage_type::allocator_type(alloc)), _index(hash, equal, index_allocator(alloc)),
+          _compactionThreshold(0), _journal(nullptr), _columns(column_allocator(alloc)), _modifications(0){};
+
+    /**
+    * @brief Costruttore con allocatore
+    * 
+    * Crea un graph vuoto che allocherà con alloc, per esempio un
+    * arena_allocator (vedi arena_allocator.h)
+    * 
+    * @param alloc Allocatore da usare
     */
-    graph() : _nodes(nullptr), _size(0), _matrix(nullptr){};
+    explicit graph(const Allocator &alloc) : graph(Hash(), KeyEqual(), alloc){};
 
     /**
     * @brief Costruttore secondario 
@@ -53,59 +137,43 @@ public:
     * 
     * @param size Numero di nodi da creare
     * @param values Nomi dei nodi
+    * @param hash Funtore di hash per l'indice dei nomi
+    * @param equal Funtore di uguaglianza per l'indice dei nomi
+    * @param alloc Allocatore da usare
     */
-    graph(unsigned int size, const T *values) : _nodes(nullptr), _size(0), _matrix(nullptr)
+    graph(unsigned int size, const T *values, const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual(),
+          const Allocator &alloc = Allocator())
+        : _alloc(alloc), _nodes(nullptr), _alive(alive_allocator(alloc)), _size(0), _slots(0), _capacity(0),
+          _matrix(typename storage_type::allocator_type(alloc)), _index(hash, equal, index_allocator(alloc)),
+          _compactionThreshold(0), _journal(nullptr), _columns(column_allocator(alloc)), _modifications(0)
     {
         try
         {
-            _size = size;
-            _nodes = new node[_size];
-            // _nodes->matrixRowPtr = nullptr;
-            (*_nodes).matrixRowPtr = nullptr;
-            _matrix = new bool *[_size];
-            for (unsigned int i = 0; i < _size; i++)
+            _nodes = newNodeArray(size);
+            _alive.resize(dense_bitset::wordsFor(size));
+            _matrix.resize(size);
+            reserveIndex(size);
+            for (unsigned int i = 0; i < size; i++)
             {
-                _matrix[i] = new bool[_size];
-                node nd = {values[i], _matrix[i]};
-                for (unsigned int k = 0; k < i; k++)
-                {
-                    // Se esiste già un nodo con lo stesso nome
-                    if (_nodes[k].name == nd.name)
-                    {
-                        throw 1;
-                    }
-                }
-                _nodes[i] = nd;
-                for (unsigned int j = 0; j < _size; j++)
+                _nodes[i].name = values[i];
+                // Se esiste già un nodo con lo stesso nome
+                if (_index.find(_nodes[i].name, _nodes) != -1)
                 {
-                    _matrix[i][j] = false;
+                    throw 1;
                 }
+                _index.insert(_nodes[i].name, i, _nodes);
+                setAlive(i);
             }
-        }
-        catch (int e)
-        {
-            delete[] _nodes;
-            for (int i = 0; i < _size; i++)
-            {
-                delete[] _matrix[i];
-            }
-            delete[] _matrix;
-            _nodes = nullptr;
-            _matrix = nullptr;
-            _size = 0;
-            throw;
+            _size = size;
+            _slots = size;
+            _capacity = size;
         }
         catch (...)
         {
-            delete[] _nodes;
-            for (int i = 0; i < _size; i++)
-            {
-                delete[] _matrix[i];
-            }
-            delete[] _matrix;
+            deleteNodeArray(_nodes, size);
             _nodes = nullptr;
-            _matrix = nullptr;
             _size = 0;
+            _slots = 0;
             throw;
         }
     };
@@ -118,81 +186,120 @@ public:
      * @param other altro graph da copiare
      */
     graph(const graph &other)
+        : graph(other, Allocator(node_traits::select_on_container_copy_construction(other._alloc))){};
+
+    /**
+     * @brief Copy constructor con allocatore
+     * 
+     * Come il copy constructor, ma la copia alloca con alloc
+     * 
+     * @param other altro graph da copiare
+     * @param alloc Allocatore della copia
+     */
+    graph(const graph &other, const Allocator &alloc)
+        : _alloc(alloc), _nodes(nullptr),
+          _alive(other._alive.begin(), other._alive.begin() + dense_bitset::wordsFor(other._slots),
+                 alive_allocator(alloc)),
+          _size(0), _slots(0), _capacity(0), _matrix(other._matrix, typename storage_type::allocator_type(alloc)),
+          _index(other._index, index_allocator(alloc)), _compactionThreshold(other._compactionThreshold),
+          _journal(nullptr), _columns(column_allocator(alloc)), _modifications(0)
     {
         try
         {
-            _size = other._size;
-            _nodes = new node[_size];
-            // _nodes->matrixRowPtr = nullptr;
-            (*_nodes).matrixRowPtr = nullptr;
-            _matrix = new bool *[_size];
-            for (unsigned int i = 0; i < _size; i++)
+            _nodes = newNodeArray(other._slots);
+            for (unsigned int i = 0; i < other._slots; i++)
             {
-                _matrix[i] = new bool[_size];
-                T otherName = other.nodeFromIndex(i).name;
-                node nd = {otherName, _matrix[i]};
-                _nodes[i] = nd;
-                for (unsigned int j = 0; j < _size; j++)
-                {
-                    _matrix[i][j] = other._matrix[i][j];
-                }
+                _nodes[i].name = other._nodes[i].name;
+            }
+            _columns.reserve(other._columns.size());
+            for (size_t c = 0; c < other._columns.size(); c++)
+            {
+                _columns.push_back(other._columns[c]->clone(other._slots, alloc));
             }
+            _size = other._size;
+            _slots = other._slots;
+            _capacity = other._slots;
         }
         catch (...)
         {
-            delete[] _nodes;
-            for (int i = 0; i < _size; i++)
-            {
-                delete[] _matrix[i];
-            }
-            delete[] _matrix;
+            deleteNodeArray(_nodes, other._slots);
+            destroyColumns();
             _nodes = nullptr;
-            _matrix = nullptr;
             _size = 0;
+            _slots = 0;
             throw;
         };
     }
 
+    /**
+     * @brief Move constructor
+     * 
+     * Prende i dati e l'allocatore di other senza copiarli; other resta un
+     * graph vuoto con lo stesso allocatore
+     * 
+     * @param other graph da spostare
+     */
+    graph(graph &&other) noexcept
+        : _alloc(other._alloc), _nodes(nullptr), _alive(other._alive.get_allocator()), _size(0), _slots(0),
+          _capacity(0), _matrix(other._matrix.get_allocator()),
+          _index(other._index.hash_function(), other._index.key_eq(), other._index.get_allocator()),
+          _compactionThreshold(0), _journal(nullptr), _columns(other._columns.get_allocator()), _modifications(0)
+    {
+        swap(other);
+        // other è rimasto vuoto
+        other.recordContents();
+    }
+
     /**
      * @brief Costruttore di conversione
      * 
-     * Costruttore di conversione da un graph di tipo O a un graph di tipo T
+     * Costruttore di conversione da un graph di tipo O a un graph di tipo T.
+     * Anche la politica di memorizzazione può essere diversa.
+     * 
+     * @pre I nomi convertiti a T devono essere tutti diversi
      * 
      * @param other graph da copiare di tipo O 
+     * @param alloc Allocatore da usare
      */
-    template <typename O>
-    graph(const graph<O> &other) : _nodes(nullptr), _size(0), _matrix(nullptr)
+    template <typename O, typename OStorage, typename OHash, typename OKeyEqual, typename OAllocator>
+    graph(const graph<O, OStorage, OHash, OKeyEqual, OAllocator> &other, const Allocator &alloc = Allocator())
+        : _alloc(alloc), _nodes(nullptr), _alive(alive_allocator(alloc)), _size(0), _slots(0), _capacity(0),
+          _matrix(typename storage_type::allocator_type(alloc)), _index(Hash(), KeyEqual(), index_allocator(alloc)),
+          _compactionThreshold(other.compactionThreshold()), _journal(nullptr), _columns(column_allocator(alloc)),
+          _modifications(0)
     {
         try
         {
-            _size = other.size();
-            _nodes = new node[size()];
-            // _nodes->matrixRowPtr = nullptr;
-            (*_nodes).matrixRowPtr = nullptr;
-            _matrix = new bool *[size()];
-            for (unsigned int i = 0; i < _size; i++)
+            copyAdjacency(other.adjacency());
+            _nodes = newNodeArray(other.slots());
+            _alive.resize(dense_bitset::wordsFor(other.slots()));
+            reserveIndex(other.size());
+            for (unsigned int i = 0; i < other.slots(); i++)
             {
-                _matrix[i] = new bool[_size];
+                if (!other.isAlive(i))
+                {
+                    continue;
+                }
                 O otherName = other.nodeFromIndex(i).name;
-                node nd = {static_cast<T>(otherName), _matrix[i]};
-                _nodes[i] = nd;
-                for (unsigned int j = 0; j < _size; j++)
+                _nodes[i].name = static_cast<T>(otherName);
+                // La conversione potrebbe rendere uguali due nomi
+                if (_index.find(_nodes[i].name, _nodes) != -1)
                 {
-                    _matrix[i][j] = other.matrix()[i][j];
+                    throw 1;
                 }
+                _index.insert(_nodes[i].name, i, _nodes);
+                setAlive(i);
             }
+            _size = other.size();
+            _slots = other.slots();
+            _capacity = other.slots();
         }
         catch (...)
         {
-            delete[] _nodes;
-            for (int i = 0; i < _size; i++)
-            {
-                delete[] _matrix[i];
-            }
-            delete[] _matrix;
+            deleteNodeArray(_nodes, other.slots());
             _nodes = nullptr;
-            _matrix = nullptr;
             _size = 0;
+            _slots = 0;
             throw;
         };
     };
@@ -211,10 +318,37 @@ public:
     {
         if (this != &other)
         {
-            graph tmp_gr(other);
+            graph tmp_gr(other, node_traits::propagate_on_container_copy_assignment::value ? other.get_allocator()
+                                                                                             : get_allocator());
 
             tmp_gr.swap(*this);
+            recordContents();
+        }
+
+        return *this;
+    };
+
+    /**
+     * @brief Operatore di assegnamento per spostamento
+     * 
+     * Prende i dati di other senza copiarli e libera subito quelli di *this;
+     * other resta un graph vuoto
+     * 
+     * @param other graph da spostare
+     * 
+     * @return reference a graph
+     */
+    graph &operator=(graph &&other) noexcept(node_traits::propagate_on_container_move_assignment::value)
+    {
+        if (!node_traits::propagate_on_container_move_assignment::value && !(_alloc == other._alloc))
+        {
+            // La memoria di other non può passare a *this: la copio
+            return *this = other;
         }
+        graph tmp_gr(std::move(other));
+
+        tmp_gr.swap(*this);
+        recordContents();
 
         return *this;
     };
@@ -222,15 +356,27 @@ public:
     /**
      * @brief methodo Swap che scambia i dati interni con un altro graph
      * 
-     * Funzione che scambia gli stati interni tra i due graph
+     * Funzione che scambia gli stati interni tra i due graph, allocatori
+     * compresi. I journal restano legati ai rispettivi oggetti e lo scambio
+     * non viene registrato: lo registrano gli assegnamenti che lo usano
      * 
      * @param other graph sorgente
      */
-    void swap(graph &other)
+    void swap(graph &other) noexcept
     {
+        swapAllocators(this->_alloc, other._alloc);
         std::swap(this->_nodes, other._nodes);
+        this->_alive.swap(other._alive);
         std::swap(this->_size, other._size);
-        std::swap(this->_matrix, other._matrix);
+        std::swap(this->_slots, other._slots);
+        std::swap(this->_capacity, other._capacity);
+        this->_matrix.swap(other._matrix);
+        this->_index.swap(other._index);
+        std::swap(this->_compactionThreshold, other._compactionThreshold);
+        this->_columns.swap(other._columns);
+        // Come il journal il contatore resta legato all'oggetto
+        ++_modifications;
+        ++other._modifications;
     };
 
     /**
@@ -241,381 +387,1624 @@ public:
      */
     ~graph()
     {
-        delete[] _nodes;
-        std::cout << "Distruttore, _size: " << _size << std::endl;
-        for (int i = 0; i < _size; i++)
-        {
-            delete[] _matrix[i];
-        }
-        delete[] _matrix;
+        deleteNodeArray(_nodes, _capacity);
+        destroyColumns();
         _nodes = nullptr;
-        _matrix = nullptr;
         _size = 0;
+        _slots = 0;
+        _capacity = 0;
     };
 
     /**
      *  * @brief Getter del nodo index-esimo
      * 
-     * Funzione che permette di leggere  il nodo index-esimo
+     * Funzione che permette di leggere  il nodo index-esimo. L'indice è una
+     * posizione: se nel graph ci sono nodi rimossi non ancora compattati
+     * (vedi isAlive) gli indici validi arrivano fino a slots().
      * 
      * @param indice del nodo da leggere
      * 
-     * @pre index < _size
+     * @pre index < slots()
+     * 
+     * @return reference al nodo index-esimo
+     */
+    const node &nodeFromIndex(unsigned int index) const
+    {
+        assert(index < _slots);
+
+        return _nodes[index];
+    };
+
+    /**
+     * @brief Getter della size 
+     * 
+     * Funzione che permette di leggere la dimensione dei nodi, esclusi i
+     * nodi rimossi
+     * 
+     * @return Size di Graph
+     */
+    const unsigned int &size() const
+    {
+        return _size;
+    };
+
+    /**
+     * @brief Getter del numero di posizioni 
+     * 
+     * Funzione che permette di leggere il numero di posizioni occupate,
+     * compresi i nodi rimossi non ancora compattati. Gli indici dei nodi e
+     * delle righe della matrice vanno da 0 a slots() - 1.
+     * 
+     * @return Numero di posizioni
+     */
+    unsigned int slots() const
+    {
+        return _slots;
+    };
+
+    /**
+     * @brief Funzione per sapere se una posizione contiene un nodo
+     * 
+     * @param index Posizione da verificare
+     * 
+     * @pre index < slots()
+     * 
+     * @return false se il nodo in posizione index è stato rimosso
+     */
+    bool isAlive(unsigned int index) const
+    {
+        assert(index < _slots);
+
+        return ((_alive[index / dense_bitset::bitsPerWord] >> (index % dense_bitset::bitsPerWord)) & 1) != 0;
+    };
+
+    /**
+     * @brief Funzione per aggiungere una colonna di dati per nodo
+     * 
+     * Aggiunge un array di valori V, uno per posizione, separato dai nomi
+     * (vedi node_columns.h): pesi, etichette o altri dati che chi scorre i
+     * nomi non deve caricare. Ogni nodo, anche quelli aggiunti dopo, parte
+     * da V(); rimuovendo un nodo il suo valore torna V(). Le copie del graph
+     * copiano anche le colonne, la conversione da un altro tipo di graph no.
+     * 
+     * @tparam V Tipo dei valori, da spostare senza eccezioni
+     * 
+     * @return Handle con cui leggere e scrivere i valori
+     */
+    template <typename V>
+    column_handle<V> addColumn()
+    {
+        typedef node_column<V, Allocator> typed_column;
+        _columns.reserve(_columns.size() + 1);
+        _columns.push_back(typed_column::create(_capacity, get_allocator()));
+        return column_handle<V>(static_cast<unsigned int>(_columns.size() - 1));
+    }
+
+    /**
+     * @brief Getter del numero di colonne
+     */
+    unsigned int columns() const
+    {
+        return static_cast<unsigned int>(_columns.size());
+    }
+
+    /**
+     * @brief Valore di un nodo in una colonna
+     * 
+     * Lancia un errore se il nodo non esiste
+     * 
+     * @param column Colonna restituita da addColumn
+     * @param node_name Nome del nodo
+     * 
+     * @return reference al valore, valida fino alla prossima modifica dei nodi
+     */
+    template <typename V>
+    V &payload(const column_handle<V> &column, const T &node_name)
+    {
+        return columnData(column)[checkedIndexOf(node_name)];
+    }
+
+    template <typename V>
+    const V &payload(const column_handle<V> &column, const T &node_name) const
+    {
+        return columnData(column)[checkedIndexOf(node_name)];
+    }
+
+    /**
+     * @brief Valore della posizione index in una colonna
+     * 
+     * @pre index < slots()
+     */
+    template <typename V>
+    V &payloadAt(const column_handle<V> &column, unsigned int index)
+    {
+        assert(index < _slots);
+        return columnData(column)[index];
+    }
+
+    template <typename V>
+    const V &payloadAt(const column_handle<V> &column, unsigned int index) const
+    {
+        assert(index < _slots);
+        return columnData(column)[index];
+    }
+
+    /**
+     * @brief Array dei valori di una colonna
+     * 
+     * Ha slots() valori validi, nello stesso ordine di nodeFromIndex; i
+     * nodi rimossi valgono V(). Il puntatore cambia con le riallocazioni
+     * 
+     * @param column Colonna restituita da addColumn
+     * 
+     * @return Puntatore al primo valore
+     */
+    template <typename V>
+    V *columnData(const column_handle<V> &column)
+    {
+        assert(column._column < _columns.size());
+        assert((_columns[column._column]->type() == node_column<V, Allocator>::typeTag()));
+        return static_cast<node_column<V, Allocator> *>(_columns[column._column])->data();
+    }
+
+    template <typename V>
+    const V *columnData(const column_handle<V> &column) const
+    {
+        assert(column._column < _columns.size());
+        assert((_columns[column._column]->type() == node_column<V, Allocator>::typeTag()));
+        return static_cast<const node_column<V, Allocator> *>(_columns[column._column])->data();
+    }
+
+    /**
+     * @brief Getter della matrice di adiacenza 
+     * 
+     * Funzione che permette di leggere gli archi così come sono memorizzati.
+     * Con dense_bitset la riga i-esima si ottiene con adjacency().row(i) ed
+     * è lunga adjacency().wordsPerRow() parole da 64 bit; il bit j della
+     * riga indica l'arco dal nodo i al nodo j. Con sparse_adjacency row(i)
+     * è la lista ordinata dei successori di i.
+     * 
+     * @return Reference costante alla matrice
+     */
+    const storage_type &adjacency() const
+    {
+        return _matrix;
+    }
+
+    /**
+     * @brief Getter dell'allocatore
+     */
+    allocator_type get_allocator() const
+    {
+        return allocator_type(_alloc);
+    }
+
+    /**
+     * @brief Getter del funtore di hash dell'indice dei nomi
+     */
+    const Hash &hashFunction() const
+    {
+        return _index.hash_function();
+    }
+
+    /**
+     * @brief Getter del funtore di uguaglianza dell'indice dei nomi
+     */
+    const KeyEqual &keyEqual() const
+    {
+        return _index.key_eq();
+    }
+
+    /**
+     * @brief Funzione per creare una fotografia immutabile
+     * 
+     * Funzione che costruisce, con una sola passata sugli archi, una
+     * fotografia in formato CSR (vedi frozen_graph) adatta a servire
+     * interrogazioni in sola lettura da più thread senza lock. Le modifiche
+     * successive al graph non si riflettono sulla fotografia.
+     * 
+     * @return Fotografia del graph
+     */
+    frozen_graph<T, Hash, KeyEqual> freeze() const
+    {
+        return frozen_graph<T, Hash, KeyEqual>(*this);
+    }
+
+    /**
+     * @brief Funzione per ottenere il graph inverso
+     * 
+     * Funzione che restituisce un graph con gli stessi nodi, nelle stesse
+     * posizioni, e ogni arco invertito. Con dense_bitset la matrice viene
+     * trasposta per blocchi di 64 x 64 bit (vedi dense_bitset::transpose).
+     * 
+     * @return graph con gli archi invertiti
+     */
+    graph transpose() const
+    {
+        graph result(*this);
+        storage_type reversed = _matrix.transpose();
+        result._matrix.swap(reversed);
+        return result;
+    }
+
+    /**
+     * @brief Successori di un nodo
+     * 
+     * Funzione che restituisce gli indici dei nodi raggiunti da un arco
+     * uscente da node_name, in ordine crescente, letti direttamente dagli
+     * archi memorizzati (con dense_bitset le parole vuote vengono saltate).
+     * Per ottenere i nomi usare nodeFromIndex.
+     * 
+     * @param node_name Nome del nodo
+     * 
+     * @return Intervallo di indici
+     */
+    successor_range successors(const T &node_name) const
+    {
+        return successorsAt(checkedIndexOf(node_name));
+    }
+
+    /**
+     * @brief Successori del nodo index-esimo
+     * 
+     * @pre index < slots()
+     * 
+     * @return Intervallo di indici
+     */
+    successor_range successorsAt(unsigned int index) const
+    {
+        assert(index < _slots);
+
+        return _matrix.successors(index);
+    }
+
+    /**
+     * @brief Predecessori di un nodo
+     * 
+     * Funzione che restituisce gli indici dei nodi da cui parte un arco
+     * entrante in node_name, in ordine crescente. Con dense_bitset vengono
+     * letti dalla vista trasposta della matrice, costruita alla prima
+     * richiesta e poi mantenuta da addEdge, removeEdge e dalle altre
+     * modifiche.
+     * 
+     * @param node_name Nome del nodo
+     * 
+     * @return Intervallo di indici
+     */
+    predecessor_range predecessors(const T &node_name) const
+    {
+        return predecessorsAt(checkedIndexOf(node_name));
+    }
+
+    /**
+     * @brief Predecessori del nodo index-esimo
+     * 
+     * @pre index < slots()
+     * 
+     * @return Intervallo di indici
+     */
+    predecessor_range predecessorsAt(unsigned int index) const
+    {
+        assert(index < _slots);
+
+        return _matrix.predecessors(index);
+    }
+
+    /**
+     * @brief Tutti gli archi del graph
+     * 
+     * Funzione che restituisce gli archi come coppie (indice origine,
+     * indice destinazione), ordinate per origine e poi per destinazione
+     * 
+     * @return Intervallo di archi
+     */
+    edge_range edges() const
+    {
+        return edge_range(edge_iterator<storage_type>(&_matrix, 0), edge_iterator<storage_type>(&_matrix, _matrix.size()));
+    }
+
+    /**
+     * @brief Numero di archi uscenti da un nodo
+     * 
+     * Con dense_bitset è il popcount vettorizzato della riga
+     * 
+     * @param node_name Nome del nodo
+     * 
+     * @return Numero di successori
+     */
+    unsigned int outDegree(const T &node_name) const
+    {
+        return _matrix.outDegree(checkedIndexOf(node_name));
+    }
+
+    /**
+     * @brief Numero di archi entranti in un nodo
+     * 
+     * Con dense_bitset la colonna viene estratta 64 righe alla volta e
+     * contata con popcount
+     * 
+     * @param node_name Nome del nodo
+     * 
+     * @return Numero di predecessori
+     */
+    unsigned int inDegree(const T &node_name) const
+    {
+        return _matrix.inDegree(checkedIndexOf(node_name));
+    }
+
+    /**
+     * @brief Successori comuni a due nodi
+     * 
+     * Funzione che restituisce, in ordine crescente, gli indici dei nodi
+     * raggiunti da un arco sia da first_node sia da second_node. Con
+     * dense_bitset le due righe vengono unite con un AND vettorizzato.
+     * 
+     * @param first_node Nome del primo nodo
+     * @param second_node Nome del secondo nodo
+     * 
+     * @return Indici dei successori comuni
+     */
+    std::vector<unsigned int> commonSuccessors(const T &first_node, const T &second_node) const
+    {
+        std::vector<unsigned int> result;
+        _matrix.commonSuccessors(checkedIndexOf(first_node), checkedIndexOf(second_node), result);
+        return result;
+    }
+
+    /**
+     * @brief Unione degli archi con quelli di un graph con gli stessi nodi
+     * 
+     * Se i due graph hanno i nodi nelle stesse posizioni le righe vengono
+     * unite parola per parola con i kernel vettorizzati (vedi
+     * bitset_kernels.h), altrimenti gli archi di other vengono prima
+     * riportati sulle posizioni di *this. Se i nodi non coincidono viene
+     * lanciato un errore e *this resta invariato.
+     * 
+     * @param other graph con gli stessi nodi
+     * 
+     * @return reference a graph
+     */
+    graph &operator|=(const graph &other)
+    {
+        combineWith(other, [](storage_type &matrix, const storage_type &edges) { matrix.uniteWith(edges); });
+        return *this;
+    }
+
+    /**
+     * @brief Intersezione degli archi con quelli di un graph con gli stessi nodi
+     * 
+     * Vedi operator|=
+     * 
+     * @param other graph con gli stessi nodi
+     * 
+     * @return reference a graph
+     */
+    graph &operator&=(const graph &other)
+    {
+        combineWith(other, [](storage_type &matrix, const storage_type &edges) { matrix.intersectWith(edges); });
+        return *this;
+    }
+
+    /**
+     * @brief Differenza degli archi con quelli di un graph con gli stessi nodi
+     * 
+     * Toglie da *this gli archi presenti in other. Vedi operator|=
+     * 
+     * @param other graph con gli stessi nodi
+     * 
+     * @return reference a graph
+     */
+    graph &operator-=(const graph &other)
+    {
+        combineWith(other, [](storage_type &matrix, const storage_type &edges) { matrix.subtract(edges); });
+        return *this;
+    }
+
+    /**
+     * @brief Funzione per aggiungere archi
+     * 
+     * Funzione che permette di aggiungere un arco tra due nodi
+     * 
+     * @param origin_node Reference al primo nodo
+     * @param destination_node Reference al secondo nodo
+     */
+    void addEdge(const T &origin_node, const T &destination_node)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        int origin_index = indexOf(origin_node);
+        int destination_index = indexOf(destination_node);
+        // Se non sono stati trovati nodi corrispondenti lancio un errore
+        if (origin_index == -1 || destination_index == -1)
+        {
+            throw 1;
+        };
+
+        _matrix.set(origin_index, destination_index);
+        count(edge_insertions_counter);
+        ++_modifications;
+        recordEdge(journal_type::add_edge, origin_index, destination_index);
+    };
+
+    /**
+     * @brief Funzione per aggiungere un arco con peso
+     * 
+     * Solo con una politica con pesi (dense_weights, sparse_weights). Se
+     * l'arco esiste già ne cambia il peso. Il journal registra l'arco con il
+     * nuovo peso.
+     * 
+     * @param origin_node Reference al primo nodo
+     * @param destination_node Reference al secondo nodo
+     * @param weight Peso dell'arco
+     */
+    template <typename W>
+    void addEdge(const T &origin_node, const T &destination_node, const W &weight)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        int origin_index = indexOf(origin_node);
+        int destination_index = indexOf(destination_node);
+        // Se non sono stati trovati nodi corrispondenti lancio un errore
+        if (origin_index == -1 || destination_index == -1)
+        {
+            throw 1;
+        };
+
+        _matrix.set(origin_index, destination_index, weight);
+        count(edge_insertions_counter);
+        ++_modifications;
+        recordEdge(journal_type::add_edge, origin_index, destination_index);
+    };
+
+    /**
+     * @brief Funzione per leggere il peso di un arco
+     * 
+     * Solo con una politica con pesi. Lancia un errore se uno dei nodi o
+     * l'arco non esiste
+     * 
+     * @param origin_node Reference al primo nodo
+     * @param destination_node Reference al secondo nodo
+     * 
+     * @return Peso dell'arco
+     */
+    template <typename S = storage_type>
+    typename S::weight_type weight(const T &origin_node, const T &destination_node) const
+    {
+        unsigned int origin = checkedIndexOf(origin_node);
+        unsigned int destination = checkedIndexOf(destination_node);
+        if (!_matrix.test(origin, destination))
+        {
+            throw 1;
+        }
+        return _matrix.weight(origin, destination);
+    };
+
+    /**
+     * @brief Aggiunge l'arco tra due posizioni
+     * 
+     * Come addEdge, ma senza cercare i nomi. Con dense_bitset senza vista
+     * trasposta (vedi dense_bitset::hasTransposed) chiamate su origini
+     * diverse toccano righe diverse e possono avvenire da più thread, se il
+     * graph non ha un journal.
+     * 
+     * @pre origin < slots() && destination < slots(), entrambi nodi presenti
+     */
+    void addEdgeAt(unsigned int origin, unsigned int destination)
+    {
+        assert(origin < _slots && destination < _slots);
+        assert(isAlive(origin) && isAlive(destination));
+
+        _matrix.set(origin, destination);
+        count(edge_insertions_counter);
+        recordEdge(journal_type::add_edge, origin, destination);
+    };
+
+    /**
+     * @brief Funzione per rimuovere archi
+     * 
+     * Funzione che permette di rimuovere un arco tra due nodi
+     * 
+     * @param origin_node Reference al primo nodo
+     * @param destination_node Reference al secondo nodo
+     */
+    void removeEdge(const T &origin_node, const T &destination_node)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        int origin_index = indexOf(origin_node);
+        int destination_index = indexOf(destination_node);
+        // Se non sono stati trovati nodi corrispondenti lancio un errore
+        if (origin_index == -1 || destination_index == -1)
+        {
+            throw 1;
+        };
+
+        const bool existed = _matrix.test(origin_index, destination_index);
+        _matrix.reset(origin_index, destination_index);
+        count(edge_removals_counter);
+        ++_modifications;
+        if (existed)
+        {
+            recordEdge(journal_type::remove_edge, origin_index, destination_index);
+        }
+    };
+
+    /**
+     * @brief Funzione per aggiungere archi in blocco
+     * 
+     * Funzione che aggiunge tutti gli archi dell'intervallo. I nomi vengono
+     * cercati una volta sola e gli archi applicati in ordine di origine. Se
+     * un nodo non esiste o l'applicazione fallisce il graph resta invariato.
+     * 
+     * @param first Inizio dell'intervallo di coppie (first origine, second destinazione)
+     * @param last Fine dell'intervallo
+     */
+    template <typename InputIt>
+    void addEdges(InputIt first, InputIt last)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        edge_buffer edges(_alloc);
+        resolveEdges(first, last, edges);
+
+        // Archi già presenti: l'annullamento non deve toglierli
+        size_t applied = 0;
+        try
+        {
+            for (; applied < edges.size(); applied++)
+            {
+                if (_matrix.test(edges[applied].first, edges[applied].second))
+                {
+                    edges[applied].first = storage_type::discarded;
+                    continue;
+                }
+                _matrix.set(edges[applied].first, edges[applied].second);
+            }
+        }
+        catch (...)
+        {
+            for (size_t k = 0; k < applied; k++)
+            {
+                if (edges[k].first != storage_type::discarded)
+                {
+                    _matrix.reset(edges[k].first, edges[k].second);
+                }
+            }
+            throw;
+        }
+        count(edge_insertions_counter, edges.size());
+        ++_modifications;
+        // Registro solo gli archi nuovi
+        for (size_t k = 0; k < edges.size(); k++)
+        {
+            if (edges[k].first != storage_type::discarded)
+            {
+                recordEdge(journal_type::add_edge, edges[k].first, edges[k].second);
+            }
+        }
+    };
+
+    /**
+     * @brief Funzione per rimuovere archi in blocco
+     * 
+     * Funzione che rimuove tutti gli archi dell'intervallo. Se un nodo non
+     * esiste viene lanciato un errore prima di rimuovere qualsiasi arco.
+     * 
+     * @param first Inizio dell'intervallo di coppie (first origine, second destinazione)
+     * @param last Fine dell'intervallo
+     */
+    template <typename InputIt>
+    void removeEdges(InputIt first, InputIt last)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        edge_buffer edges(_alloc);
+        resolveEdges(first, last, edges);
+        count(edge_removals_counter, edges.size());
+        ++_modifications;
+
+        // reset non lancia eccezioni. Registro solo gli archi che c'erano
+        for (size_t k = 0; k < edges.size(); k++)
+        {
+            if (_matrix.test(edges[k].first, edges[k].second))
+            {
+                _matrix.reset(edges[k].first, edges[k].second);
+                recordEdge(journal_type::remove_edge, edges[k].first, edges[k].second);
+            }
+        }
+    };
+
+    /**
+     * @brief Funzione per aggiungere un nodo
+     * 
+     * Funzione che permette di aggiungere un nodo. Se la capacità è esaurita
+     * viene raddoppiata, quindi l'inserimento costa O(1) ammortizzato per
+     * l'array di nodi e al più O(N) per la matrice.
+     * 
+     * @pre Gli elementi di tipo T devono essere tutti diversi
+     * 
+     * @param node_name Nodo da aggiungere
+     */
+    void addNode(const T &node_name)
+    {
+        insertNode(node_name);
+    };
+
+    /**
+     * @brief Funzione per aggiungere un nodo spostandone il nome
+     * 
+     * Come addNode(const T &), ma il nome viene spostato nel graph invece
+     * che copiato
+     * 
+     * @pre Gli elementi di tipo T devono essere tutti diversi
+     * 
+     * @param node_name Nodo da aggiungere
+     */
+    void addNode(T &&node_name)
+    {
+        insertNode(std::move(node_name));
+    };
+
+    /**
+     * @brief Funzione per aggiungere un nodo costruendone il nome
+     * 
+     * Il nome viene costruito dagli argomenti e poi spostato nel graph
+     * 
+     * @pre Gli elementi di tipo T devono essere tutti diversi
+     * 
+     * @param args Argomenti per il costruttore di T
+     */
+    template <typename... Args>
+    void emplaceNode(Args &&... args)
+    {
+        T node_name(std::forward<Args>(args)...);
+        insertNode(std::move(node_name));
+    };
+
+    /**
+     * @brief Funzione per aggiungere nodi in blocco
+     * 
+     * Funzione che aggiunge tutti i nodi dell'intervallo, nell'ordine dato,
+     * facendo crescere nodi, matrice e indice una volta sola. Se un nome
+     * esiste già o compare due volte, o se una copia fallisce, il graph
+     * resta invariato.
+     * 
+     * @pre Gli elementi di tipo T devono essere tutti diversi
+     * 
+     * @param first Inizio dell'intervallo di nomi
+     * @param last Fine dell'intervallo
+     */
+    template <typename InputIt>
+    void addNodes(InputIt first, InputIt last)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T> name_allocator;
+        std::vector<T, name_allocator> names(first, last, name_allocator(_alloc));
+        std::unordered_set<T, Hash, KeyEqual, name_allocator> batch(names.size(), hashFunction(), keyEqual(),
+                                                                   name_allocator(_alloc));
+        for (size_t k = 0; k < names.size(); k++)
+        {
+            if (exists(names[k]) || !batch.insert(names[k]).second)
+            {
+                // Se esiste già un nodo con lo stesso nome
+                throw 1;
+            }
+        }
+        const unsigned int count = static_cast<unsigned int>(names.size());
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (_slots + count > _capacity)
+        {
+            reserve(std::max(_slots + count, _capacity * 2));
+        }
+        reserveIndex(_size + count);
+
+        // Le posizioni oltre _slots non sono visibili: se una copia fallisce
+        // il graph non è cambiato
+        for (unsigned int k = 0; k < count; k++)
+        {
+            _nodes[_slots + k].name = std::move(names[k]);
+        }
+
+        // Da qui nessuna operazione lancia eccezioni
+        _matrix.resize(_slots + count);
+        for (unsigned int k = 0; k < count; k++)
+        {
+            setAlive(_slots + k);
+            _index.insert(_nodes[_slots + k].name, _slots + k, _nodes);
+            recordNode(journal_type::add_node, _slots + k);
+        }
+        _size += count;
+        _slots += count;
+        this->count(node_insertions_counter, count);
+        ++_modifications;
+    };
+
+    /**
+     * @brief Funzione per rimuovere un nodo
+     * 
+     * Funzione che permette di rimuovere un nodo. La posizione del nodo
+     * viene marcata come rimossa e la sua riga e colonna azzerate sul posto,
+     * in O(N). Le posizioni rimosse vengono eliminate da compact(), chiamata
+     * in automatico quando superano la soglia di compattazione (vedi
+     * setCompactionThreshold): con la soglia di default pari a 0 ogni
+     * rimozione compatta subito e gli indici restano contigui.
+     * 
+     * @param node_name Nodo da rimuovere
+     */
+    void removeNode(const T &node_name)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        int rowToDelete = indexOf(node_name);
+
+        // Controllo se il nodo è valido
+        if (rowToDelete == -1)
+        {
+            throw 1;
+        }
+
+        // Registro e tolgo il nodo dall'indice finché il suo nome è ancora nell'array
+        recordNode(journal_type::remove_node, rowToDelete);
+        _index.erase(node_name, _nodes);
+        _matrix.clear(rowToDelete);
+        _alive[rowToDelete / dense_bitset::bitsPerWord] &= ~(word_type(1) << (rowToDelete % dense_bitset::bitsPerWord));
+        // Libero le risorse del nome e dei dati rimossi
+        _nodes[rowToDelete].name = T();
+        for (size_t c = 0; c < _columns.size(); c++)
+        {
+            _columns[c]->reset(rowToDelete);
+        }
+
+        // Aggiorno _size
+        _size--;
+        count(node_removals_counter);
+        ++_modifications;
+
+        if (_slots - _size > _compactionThreshold * _slots)
+        {
+            try
+            {
+                compact();
+            }
+            catch (...)
+            {
+                // La compattazione è solo un'ottimizzazione: se fallisce
+                // il nodo resta comunque rimosso
+            }
+        }
+    }
+
+    /**
+     * @brief Funzione per compattare i nodi
+     * 
+     * Funzione che elimina le posizioni dei nodi rimossi, spostando i nodi
+     * successivi (e le rispettive righe e colonne) in modo che gli indici
+     * tornino contigui da 0 a size() - 1. Costa O(N^2 / 64) più il numero di
+     * archi. In caso di eccezione il graph resta invariato.
+     */
+    void compact()
+    {
+        if (_size == _slots)
+        {
+            return;
+        }
+
+        index_buffer remap(_slots, 0u, index_allocator(_alloc));
+        unsigned int next = 0;
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            remap[i] = isAlive(i) ? next++ : storage_type::discarded;
+        }
+
+        // In caso di eccezione remap viene liberato e la matrice resta invariata
+        _matrix.compact(remap.data(), _size);
+        _index.remap(remap.data());
+
+        // Sposto i nodi vivi nelle nuove posizioni, che non superano le vecchie
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            if (remap[i] != storage_type::discarded && remap[i] != i)
+            {
+                std::swap(_nodes[remap[i]].name, _nodes[i].name);
+            }
+        }
+        for (size_t c = 0; c < _columns.size(); c++)
+        {
+            _columns[c]->compact(remap.data(), _slots, storage_type::discarded);
+        }
+        // I vivi ora sono le prime _size posizioni
+        std::fill(_alive.begin(), _alive.end(), word_type(0));
+        std::fill(_alive.begin(), _alive.begin() + _size / dense_bitset::bitsPerWord, ~word_type(0));
+        if (_size % dense_bitset::bitsPerWord != 0)
+        {
+            _alive[_size / dense_bitset::bitsPerWord] = (word_type(1) << (_size % dense_bitset::bitsPerWord)) - 1;
+        }
+        _slots = _size;
+        ++_modifications;
+    }
+
+    /**
+     * @brief Funzione per impostare la soglia di compattazione
+     * 
+     * Funzione che imposta la frazione di posizioni rimosse oltre cui
+     * removeNode chiama compact(). Con 0 (default) si compatta a ogni
+     * rimozione; con valori maggiori le rimozioni costano O(N) e la
+     * compattazione viene rimandata; con 1 o più non avviene mai in
+     * automatico.
+     * 
+     * @param ratio Frazione di posizioni rimosse tollerata
+     */
+    void setCompactionThreshold(double ratio)
+    {
+        _compactionThreshold = ratio;
+    }
+
+    /**
+     * @brief Aggancia un journal che registra le modifiche del graph
+     * 
+     * Il journal registra subito uno svuotamento seguito dal contenuto
+     * attuale, quindi chi applica il journal dall'inizio ottiene una copia
+     * del graph. Da qui ogni addNode, removeNode, addEdge, removeEdge (anche
+     * in blocco), gli operatori |=, &=, -= e ogni assegnamento vengono
+     * registrati per nome; compact, reserve e shrink_to_fit non cambiano
+     * nodi e archi e non vengono registrati. Con una politica con pesi
+     * (vedi journal_type) ogni arco aggiunto o ripesato viene registrato con
+     * il suo peso. Il journal non viene copiato con il graph. Con il journal
+     * gli addEdgeAt devono avvenire da un solo thread.
+     * 
+     * @param journal Journal da usare, nullptr per non registrare più
+     */
+    void setJournal(journal_type *journal) noexcept
+    {
+        _journal = journal;
+        recordContents();
+    }
+
+    /**
+     * @brief Getter del journal, nullptr se assente
+     */
+    journal_type *journal() const
+    {
+        return _journal;
+    }
+
+    /**
+     * @brief Numero di modifiche subite dall'oggetto
+     * 
+     * Cresce a ogni aggiunta o rimozione di nodi e archi, compattazione,
+     * assegnamento e swap, non con addEdgeAt (che può avvenire da più
+     * thread). Chi tiene una struttura derivata dal graph (vedi
+     * reachability_index) lo confronta per accorgersi di modifiche fatte
+     * direttamente sul graph. Una copia parte da 0.
+     */
+    uint64_t modifications() const
+    {
+        return _modifications;
+    }
+
+    /**
+     * @brief Contatori delle operazioni su questo graph
+     * 
+     * Sono raccolti solo compilando con GRAPH_STATS (vedi graph_stats.h),
+     * altrimenti valgono tutti 0. Una copia del graph parte da zero.
+     * 
+     * @return Fotografia dei contatori
+     */
+    graph_stats stats() const
+    {
+#ifdef GRAPH_STATS
+        return _counters.read();
+#else
+        return graph_stats();
+#endif
+    }
+
+    /**
+     * @brief Azzera i contatori restituiti da stats()
+     */
+    void resetStats()
+    {
+#ifdef GRAPH_STATS
+        _counters.reset();
+#endif
+    }
+
+    /**
+     * @brief Applica le modifiche di un journal a partire da una sequenza
+     * 
+     * Serve a tenere allineata una replica o una cache: invece di
+     * ricopiare il graph si applicano solo le modifiche dall'ultima
+     * sincronizzazione. Se una modifica non è applicabile (per esempio un
+     * nodo già presente) viene lanciato un errore e le modifiche precedenti
+     * restano applicate.
+     * 
+     * @pre journal non è il journal di questo graph
+     * 
+     * @param journal Journal da leggere
+     * @param since Prima sequenza da applicare
+     * 
+     * @return Sequenza da cui ripartire alla prossima sincronizzazione
+     */
+    uint64_t applyJournal(const journal_type &journal, uint64_t since)
+    {
+        assert(&journal != _journal);
+        return journal.forEachSince(since, [this](const typename journal_type::change &c) {
+            switch (c.op)
+            {
+            case journal_type::add_node:
+                addNode(*c.origin);
+                break;
+            case journal_type::remove_node:
+                removeNode(*c.origin);
+                break;
+            case journal_type::add_edge:
+                replayEdge(c, has_edge_weights<storage_type>());
+                break;
+            case journal_type::remove_edge:
+                removeEdge(*c.origin, *c.destination);
+                break;
+            case journal_type::clear:
+            {
+                // Le colonne restano, con tutti i valori a V()
+                graph empty(hashFunction(), keyEqual(), get_allocator());
+                empty._compactionThreshold = _compactionThreshold;
+                empty._columns.swap(_columns);
+                for (size_t c = 0; c < empty._columns.size(); c++)
+                {
+                    empty._columns[c]->clear();
+                }
+                empty.swap(*this);
+                recordContents();
+                break;
+            }
+            }
+        });
+    }
+
+    /**
+     * @brief Getter della soglia di compattazione
+     * 
+     * @return Frazione di posizioni rimosse oltre cui si compatta
+     */
+    double compactionThreshold() const
+    {
+        return _compactionThreshold;
+    }
+
+    /**
+     * @brief Funzione per riservare spazio
+     * 
+     * Funzione che alloca spazio per almeno n nodi, così che i successivi
+     * addNode non debbano riallocare. In caso di eccezione il graph resta
+     * invariato.
+     * 
+     * @param n Numero di nodi da poter contenere
+     */
+    void reserve(unsigned int n)
+    {
+        if (n <= _capacity)
+        {
+            return;
+        }
+
+        node *tmp_nodes = allocateNodes(n);
+        try
+        {
+            // reserve lascia la matrice e l'indice invariati in caso di
+            // eccezione; bit e colonne più lunghi del necessario non danno fastidio
+            reserveIndex(n);
+            _matrix.reserve(n);
+            if (_alive.size() < dense_bitset::wordsFor(n))
+            {
+                _alive.resize(dense_bitset::wordsFor(n), word_type(0));
+            }
+            for (size_t c = 0; c < _columns.size(); c++)
+            {
+                _columns[c]->reserve(n);
+            }
+        }
+        catch (...)
+        {
+            deleteNodeArray(tmp_nodes, n);
+            throw;
+        }
+
+        adoptNodes(tmp_nodes);
+        _capacity = n;
+        count(reallocations_counter);
+    }
+
+    /**
+     * @brief Getter della capacità
+     * 
+     * Funzione che permette di leggere il numero di nodi per cui è già
+     * allocato spazio
+     * 
+     * @return Capacità di Graph
+     */
+    unsigned int capacity() const
+    {
+        return _capacity;
+    }
+
+    /**
+     * @brief Funzione per liberare lo spazio inutilizzato
+     * 
+     * Funzione che riduce la capacità al numero di posizioni occupate (per
+     * liberare anche i nodi rimossi chiamare prima compact). In caso di
+     * eccezione il graph resta invariato.
+     */
+    void shrink_to_fit()
+    {
+        if (_capacity == _slots)
+        {
+            return;
+        }
+
+        node *tmp_nodes = allocateNodes(_slots);
+        try
+        {
+            _matrix.shrink_to_fit();
+        }
+        catch (...)
+        {
+            deleteNodeArray(tmp_nodes, _slots);
+            throw;
+        }
+
+        adoptNodes(tmp_nodes);
+        _capacity = _slots;
+        for (size_t c = 0; c < _columns.size(); c++)
+        {
+            _columns[c]->shrink(_slots);
+        }
+        count(reallocations_counter);
+    }
+
+    /**
+     * @brief Funzione per verificare l'esistenza di un nodo
+     * 
+     * Funzione che permette di verificare l'esistenza di un nodo
+     * 
+     * @param nodeName Nome del nodo da verificare
+     * 
+     * @return bool per l'esistenza del nodo
+     */
+    bool exists(const T &nodeName) const
+    {
+        return indexOf(nodeName) != -1;
+    }
+
+    /**
+     * @brief Posizione di un nodo dato il nome
+     * 
+     * Ricerca in tempo costante tramite l'indice hash
+     * 
+     * @param nodeName Nome del nodo
+     * 
+     * @return Indice del nodo, -1 se non esiste
+     */
+    int indexOf(const T &nodeName) const
+    {
+        graph_stats_timer timer = startTimer(lookup_ns_counter);
+        count(lookups_counter);
+        return _index.find(nodeName, _nodes);
+    }
+
+    /**
+     * @brief Funzione per verificare l'esistenza di un arco tra due nodi
+     * 
+     * Funzione che permette di verificare l'esistenza di un arco tra due nodi
+     * 
+     * @param origin_node Reference al primo nodo
+     * @param destination_node Reference al secondo nodo
+     * 
+     * @return bool per l'esistenza dell'arco
+     */
+    bool hasEdge(const T &origin_node, const T &destination_node) const
+    {
+        int origin_index = indexOf(origin_node);
+        int destination_index = indexOf(destination_node);
+        // Se non sono stati trovati nodi corrispondenti lancio un errore
+        if (origin_index == -1 || destination_index == -1)
+        {
+            throw 1;
+        };
+
+        return _matrix.test(origin_index, destination_index);
+    }
+
+private:
+
+    /**
+     * @brief Scambia gli allocatori se il loro tipo si propaga
+     *
+     * Gli allocatori che non si propagano mai (come
+     * std::pmr::polymorphic_allocator) restano al loro posto: in quel caso
+     * swap richiede allocatori uguali
+     */
+    static void swapAllocators(node_allocator &first, node_allocator &second) noexcept
+    {
+        swapAllocators(first, second,
+                       std::integral_constant<bool, node_traits::propagate_on_container_copy_assignment::value ||
+                                                        node_traits::propagate_on_container_move_assignment::value ||
+                                                        node_traits::propagate_on_container_swap::value>());
+    };
+
+    static void swapAllocators(node_allocator &first, node_allocator &second, std::true_type) noexcept
+    {
+        std::swap(first, second);
+    };
+
+    static void swapAllocators(node_allocator &, node_allocator &, std::false_type) noexcept {};
+    /**
+     * @brief Aggiunge un nodo copiando o spostando il nome
+     * 
+     * Vedi addNode
+     */
+    template <typename U>
+    void insertNode(U &&node_name)
+    {
+        graph_stats_timer timer = startTimer(mutation_ns_counter);
+        if (exists(node_name))
+        {
+            // Se esiste già un nodo con lo stesso nome
+            throw 1;
+        }
+
+        if (_slots == _capacity)
+        {
+            reserve(_capacity == 0 ? 1 : _capacity * 2);
+        }
+        // Preparo l'indice prima di toccare i dati, così l'inserimento
+        // finale non può fallire
+        reserveIndex(_size + 1);
+
+        _nodes[_slots].name = std::forward<U>(node_name);
+        setAlive(_slots);
+        // Entro la capacità resize non alloca e non lancia eccezioni
+        _matrix.resize(_slots + 1);
+
+        // Aggiorno _size
+        _size++;
+        _slots++;
+        _index.insert(_nodes[_slots - 1].name, _slots - 1, _nodes);
+        count(node_insertions_counter);
+        ++_modifications;
+        recordNode(journal_type::add_node, _slots - 1);
+    };
+
+    /**
+     * @brief Aggiunge n a un contatore, solo con GRAPH_STATS
+     */
+    void count(graph_counter counter, uint64_t n = 1) const noexcept
+    {
+#ifdef GRAPH_STATS
+        _counters.add(counter, n);
+#else
+        (void)counter;
+        (void)n;
+#endif
+    }
+
+    /**
+     * @brief Misura il tempo fino alla fine del blocco, solo con GRAPH_STATS_TIMERS
+     */
+    graph_stats_timer startTimer(graph_counter counter) const noexcept
+    {
+#ifdef GRAPH_STATS_TIMERS
+        return graph_stats_timer(_counters, counter);
+#else
+        (void)counter;
+        return graph_stats_timer();
+#endif
+    }
+
+    /**
+     * @brief Prepara l'indice per count nomi, contando i bucket allocati
+     */
+    void reserveIndex(unsigned int count)
+    {
+        unsigned int buckets = _index.capacity();
+        _index.reserve(count, _nodes);
+        if (_index.capacity() != buckets)
+        {
+            this->count(bytes_allocated_counter, static_cast<uint64_t>(_index.capacity()) * sizeof(unsigned int));
+        }
+    }
+
+    /**
+     * @brief Registra nel journal, se presente, una modifica di un nodo
+     */
+    void recordNode(typename journal_type::operation op, unsigned int index) noexcept
+    {
+        if (_journal != nullptr)
+        {
+            _journal->recordNode(op, _nodes[index].name);
+        }
+    }
+
+    /**
+     * @brief Registra nel journal, se presente, una modifica di un arco
      * 
-     * @return reference al nodo index-esimo
+     * Con una politica con pesi un add_edge registra anche il peso attuale
+     * dell'arco, nuovo o cambiato
      */
-    const node &nodeFromIndex(unsigned int index) const
+    void recordEdge(typename journal_type::operation op, unsigned int origin, unsigned int destination) noexcept
     {
-        assert(index < _size);
+        if (_journal != nullptr)
+        {
+            recordEdge(op, origin, destination, has_edge_weights<storage_type>());
+        }
+    }
 
-        return _nodes[index];
-    };
+    void recordEdge(typename journal_type::operation op, unsigned int origin, unsigned int destination,
+                    std::false_type) noexcept
+    {
+        _journal->recordEdge(op, _nodes[origin].name, _nodes[destination].name);
+    }
 
-    /**
-     * @brief Getter della size 
-     * 
-     * Funzione che permette di leggere la dimensione dei nodi
-     * 
-     * @return Size di Graph
-     */
-    const unsigned int &size() const
+    void recordEdge(typename journal_type::operation op, unsigned int origin, unsigned int destination,
+                    std::true_type) noexcept
     {
-        return _size;
-    };
+        _journal->recordEdge(op, _nodes[origin].name, _nodes[destination].name,
+                             op == journal_type::add_edge ? &_matrix.weight(origin, destination) : nullptr);
+    }
 
     /**
-     * @brief Getter della matrice di adiacenza 
-     * 
-     * Funzione che permette di leggere matrice di adiacenza
-     * 
-     * @return Puntatore alla matrice
+     * @brief Applica un add_edge letto da un journal, con il peso se c'è
      */
-    bool **matrix() const
+    void replayEdge(const typename journal_type::change &c, std::false_type)
     {
-        return _matrix;
+        addEdge(*c.origin, *c.destination);
+    }
+
+    void replayEdge(const typename journal_type::change &c, std::true_type)
+    {
+        addEdge(*c.origin, *c.destination, *c.weight);
     }
 
     /**
-     * @brief Funzione per aggiungere archi
-     * 
-     * Funzione che permette di aggiungere un arco tra due nodi
-     * 
-     * @param origin_node Reference al primo nodo
-     * @param destination_node Reference al secondo nodo
+     * @brief Registra nel journal, se presente, uno svuotamento e tutto il
+     * contenuto del graph
      */
-    void addEdge(const T &origin_node, const T &destination_node)
+    void recordContents() noexcept
     {
-        int origin_index = -1;
-        int destination_index = -1;
-        try
+        if (_journal == nullptr)
         {
-
-            for (unsigned int i = 0; i < _size; i++)
+            return;
+        }
+        _journal->recordClear();
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            if (isAlive(i))
             {
-                if (_nodes[i].name == origin_node)
-                {
-                    origin_index = i;
-                }
+                recordNode(journal_type::add_node, i);
             }
-            for (unsigned int i = 0; i < _size; i++)
+        }
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            if (isAlive(i))
             {
-                if (_nodes[i].name == destination_node)
-                {
-                    destination_index = i;
-                }
+                _matrix.forEachSuccessor(i, [this, i](unsigned int j) {
+                    recordEdge(journal_type::add_edge, i, j);
+                });
             }
-            // Se non sono stati trovati nodi corrispondenti lancio un errore
-            if (origin_index == -1 || destination_index == -1)
-            {
-                throw 1;
-            };
         }
-        catch (int e)
-        {
-            throw;
-        };
+    }
 
-        _matrix[origin_index][destination_index] = true;
-    };
+    /**
+     * @brief Posizione di un nodo dato il nome
+     * 
+     * Come indexOf, ma lancia un errore se il nodo non esiste
+     */
+    unsigned int checkedIndexOf(const T &nodeName) const
+    {
+        int index = indexOf(nodeName);
+        if (index == -1)
+        {
+            throw 1;
+        }
+        return index;
+    }
 
     /**
-     * @brief Funzione per rimuovere archi
+     * @brief Traduce un intervallo di coppie di nomi in posizioni
      * 
-     * Funzione che permette di rimuovere un arco tra due nodi
+     * Le coppie vengono ordinate per origine e destinazione, così le righe
+     * vengono visitate una volta sola. Lancia un errore se un nodo non esiste.
+     */
+    template <typename InputIt>
+    void resolveEdges(InputIt first, InputIt last, edge_buffer &edges) const
+    {
+        for (; first != last; ++first)
+        {
+            edges.push_back(std::make_pair(checkedIndexOf(first->first), checkedIndexOf(first->second)));
+        }
+        std::sort(edges.begin(), edges.end());
+    }
+
+    /**
+     * @brief Applica op agli archi di *this e a quelli di other
      * 
-     * @param origin_node Reference al primo nodo
-     * @param destination_node Reference al secondo nodo
+     * Se other ha una disposizione diversa dei nodi, op riceve una copia dei
+     * suoi archi riportata sulle posizioni di *this
      */
-    void removeEdge(const T &origin_node, const T &destination_node)
+    template <typename F>
+    void combineWith(const graph &other, F op)
     {
-        int origin_index = -1;
-        int destination_index = -1;
-        try
+        ++_modifications;
+        if (_journal == nullptr)
         {
+            combineEdges(other, op);
+            return;
+        }
 
-            for (unsigned int i = 0; i < _size; i++)
+        // Con il journal registro la differenza tra gli archi prima e dopo;
+        // i buffer sono pronti prima di modificare il graph
+        storage_type before(_matrix, _matrix.get_allocator());
+        index_buffer was((index_allocator(_alloc)));
+        index_buffer is((index_allocator(_alloc)));
+        was.reserve(_slots);
+        is.reserve(_slots);
+        combineEdges(other, op);
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            if (!isAlive(i))
             {
-                if (_nodes[i].name == origin_node)
-                {
-                    origin_index = i;
-                }
+                continue;
             }
-            for (unsigned int i = 0; i < _size; i++)
+            was.clear();
+            is.clear();
+            before.forEachSuccessor(i, [&was](unsigned int j) { was.push_back(j); });
+            _matrix.forEachSuccessor(i, [&is](unsigned int j) { is.push_back(j); });
+            size_t a = 0, b = 0;
+            while (a < was.size() || b < is.size())
             {
-                if (_nodes[i].name == destination_node)
+                if (b == is.size() || (a < was.size() && was[a] < is[b]))
+                {
+                    recordEdge(journal_type::remove_edge, i, was[a++]);
+                }
+                else if (a == was.size() || is[b] < was[a])
                 {
-                    destination_index = i;
+                    recordEdge(journal_type::add_edge, i, is[b++]);
+                }
+                else
+                {
+                    a++;
+                    b++;
                 }
             }
-            // Se non sono stati trovati nodi corrispondenti lancio un errore
-            if (origin_index == -1 || destination_index == -1)
-            {
-                throw 1;
-            };
         }
-        catch (int e)
-        {
-            throw;
-        };
-
-        _matrix[origin_index][destination_index] = false;
-    };
+    }
 
     /**
-     * @brief Funzione per aggiungere un nodo
-     * 
-     * Funzione che permette di aggiungere un nodo
-     * 
-     * @pre Gli elementi di tipo T devono essere tutti diversi
-     * 
-     * @param node_name Nodo da aggiungere
+     * @brief Applica op alla matrice e agli archi di other allineati a *this
      */
-    void addNode(const T &node_name)
+    template <typename F>
+    void combineEdges(const graph &other, F op)
     {
-        bool **tmp;
-        node *tmp_nodes;
-        try
+        if (sameLayout(other))
+        {
+            op(_matrix, other._matrix);
+            return;
+        }
+        if (other._size != _size)
         {
-            tmp = new bool *[_size + 1];
-            tmp_nodes = new node[_size + 1];
-            // tmp_nodes->matrixRowPtr = nullptr;
-            (*tmp_nodes).matrixRowPtr = nullptr;
+            throw 1;
+        }
 
-            for (unsigned int i = 0; i < _size; i++)
-            {
-                tmp[i] = new bool[_size + 1];
-                node nd = {_nodes[i].name, tmp[i]};
-                tmp_nodes[i] = nd;
-                for (unsigned int j = 0; j < _size; j++)
-                    tmp[i][j] = _matrix[i][j];
-                tmp[i][_size] = false; // Setto false all'ultima colonna di ogni riga
-            };
-            // Aggiungo ultima riga
-            tmp[_size] = new bool[_size + 1];
-            node nd = {node_name, tmp[_size]};
-            if (exists(nd.name))
+        index_buffer remap(other._slots, 0u, index_allocator(_alloc));
+        for (unsigned int j = 0; j < other._slots; j++)
+        {
+            if (other.isAlive(j))
             {
-                // Se esiste già un nodo con lo stesso nome
-                throw 1;
+                remap[j] = checkedIndexOf(other._nodes[j].name);
             }
-            tmp_nodes[_size] = nd;
-            for (unsigned int i = 0; i < _size + 1; i++)
+        }
+        storage_type aligned(_slots, 0, _matrix.get_allocator());
+        for (unsigned int j = 0; j < other._slots; j++)
+        {
+            if (other.isAlive(j))
             {
-                tmp[_size][i] = false; // Setto a false tutta la nuova riga
-            };
+                unsigned int from = remap[j];
+                other._matrix.forEachSuccessor(j, [&](unsigned int k) { aligned.set(from, remap[k]); });
+            }
         }
-        catch (int e)
+        op(_matrix, aligned);
+    }
+
+    /**
+     * @brief true se other ha gli stessi nodi nelle stesse posizioni
+     */
+    bool sameLayout(const graph &other) const
+    {
+        if (_slots != other._slots || _size != other._size)
         {
-            for (int i = 0; i < _size + 1; i++)
-                delete[] tmp[i];
-            delete[] tmp;
-            delete[] tmp_nodes;
-            throw;
+            return false;
         }
-        catch (...)
+        for (unsigned int i = 0; i < _slots; i++)
         {
-            for (int i = 0; i < _size + 1; i++)
-                delete[] tmp[i];
-            delete[] tmp;
-            delete[] tmp_nodes;
-            throw;
+            if (isAlive(i) != other.isAlive(i) || (isAlive(i) && !keyEqual()(_nodes[i].name, other._nodes[i].name)))
+            {
+                return false;
+            }
         }
-
-        std::swap(tmp, _matrix);
-        std::swap(tmp_nodes, _nodes);
-
-        // Pulisco memoria heap
-        for (int i = 0; i < _size; i++)
-            delete[] tmp[i];
-        delete[] tmp;
-        delete[] tmp_nodes;
-        tmp = nullptr;
-        tmp_nodes = nullptr;
-
-        // Aggiorno _size
-        _size++;
-    };
+        return true;
+    }
 
     /**
-     * @brief Funzione per rimuovere un nodo
+     * @brief Copia i nodi in un nuovo array
      * 
-     * Funzione che permette di rimuovere un nodo
+     * @param capacity Dimensione del nuovo array
      * 
-     * @param node_name Nodo da rimuovere
+     * @pre capacity >= _slots
+     * 
+     * @return Puntatore al nuovo array, da liberare con deleteNodeArray
      */
-    void removeNode(const T &node_name)
+    node *copyNodes(unsigned int capacity) const
     {
-        int rowToDelete = -1;
-
-        // Controllo se il nodo è valido
+        node *tmp_nodes = newNodeArray(capacity);
         try
         {
-            for (unsigned int i = 0; i < _size; i++)
+            for (unsigned int i = 0; i < _slots; i++)
             {
-                if (_nodes[i].name == node_name)
-                    rowToDelete = i;
-            };
-
-            if (rowToDelete == -1)
-            {
-                throw 1;
+                tmp_nodes[i].name = _nodes[i].name;
             }
         }
-        catch (int e)
+        catch (...)
         {
+            deleteNodeArray(tmp_nodes, capacity);
             throw;
-        };
+        }
+        return tmp_nodes;
+    }
 
-        bool **tmp;
-        node *tmp_nodes;
+    /**
+     * @brief Alloca con l'allocatore un array di count nodi vuoti
+     * 
+     * @return Puntatore all'array, da liberare con deleteNodeArray
+     */
+    node *newNodeArray(unsigned int count) const
+    {
+        node_allocator alloc(_alloc);
+        node *nodes = node_traits::allocate(alloc, count);
+        this->count(bytes_allocated_counter, static_cast<uint64_t>(count) * sizeof(node));
+        unsigned int built = 0;
         try
         {
-            int columnToDelete = rowToDelete;
-            tmp = new bool *[_size - 1];
-            tmp_nodes = new node[_size - 1];
-            // tmp_nodes->matrixRowPtr = nullptr;
-            (*tmp_nodes).matrixRowPtr = nullptr;
-            // creo nuove righe (escludendo quella da togliere)
-            unsigned int rowCount = 0;
-            for (unsigned int i = 0; i < _size; i++)
+            for (; built < count; built++)
             {
-                if (i != rowToDelete)
-                {
-                    tmp[rowCount] = new bool[_size - 1];
-                    node nd = {_nodes[i].name, tmp[rowCount]};
-                    tmp_nodes[rowCount] = nd;
-                    // creo nuove colonne (escludendo quella da togliere)
-                    unsigned int columnCount = 0;
-                    for (unsigned int j = 0; j < _size; j++)
-                    {
-                        if (j != columnToDelete)
-                        {
-                            tmp[rowCount][columnCount] = _matrix[i][j];
-                            columnCount++;
-                        }
-                    };
-
-                    rowCount++;
-                }
+                node_traits::construct(alloc, nodes + built);
             }
         }
         catch (...)
         {
-            for (int i = 0; i < _size - 1; i++)
-                delete[] tmp[i];
-            delete[] tmp;
-            delete[] tmp_nodes;
+            destroyNodes(alloc, nodes, built);
+            node_traits::deallocate(alloc, nodes, count);
             throw;
         }
-
-        std::swap(tmp, _matrix);
-        std::swap(tmp_nodes, _nodes);
-
-        // Pulisco memoria heap
-        for (int i = 0; i < _size; i++)
-            delete[] tmp[i];
-        delete[] tmp;
-        delete[] tmp_nodes;
-        tmp = nullptr;
-        tmp_nodes = nullptr;
-
-        // Aggiorno _size
-        _size--;
+        return nodes;
     }
 
     /**
-     * @brief Funzione per verificare l'esistenza di un nodo
-     * 
-     * Funzione che permette di verificare l'esistenza di un nodo
-     * 
-     * @param nodeName Nome del nodo da verificare
+     * @brief Libera un array creato da newNodeArray, può essere nullptr
      * 
-     * @return bool per l'esistenza del nodo
+     * @param nodes Array da liberare
+     * @param count Numero di nodi passato a newNodeArray
      */
-    bool exists(const T &nodeName)
+    void deleteNodeArray(node *nodes, unsigned int count) const
     {
-        bool nodeExists = false;
-        for (unsigned int i = 0; i < _size; i++)
+        if (nodes != nullptr)
         {
-            if (_nodes[i].name == nodeName)
-            {
-                nodeExists = true;
-                break;
-            };
+            node_allocator alloc(_alloc);
+            destroyNodes(alloc, nodes, count);
+            node_traits::deallocate(alloc, nodes, count);
+        }
+    }
+
+    static void destroyNodes(node_allocator &alloc, node *nodes, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            node_traits::destroy(alloc, nodes + i);
         }
-        return nodeExists;
     }
 
     /**
-     * @brief Funzione per verificare l'esistenza di un arco tra due nodi
+     * @brief Alloca il nuovo array di nodi per una riallocazione
      * 
-     * Funzione che permette di verificare l'esistenza di un arco tra due nodi
+     * Se T si sposta senza eccezioni i nomi verranno spostati da adoptNodes,
+     * dopo le operazioni che possono fallire; altrimenti vengono copiati
+     * subito, così un'eccezione lascia il graph invariato
      * 
-     * @param origin_node Reference al primo nodo
-     * @param destination_node Reference al secondo nodo
+     * @param capacity Dimensione del nuovo array
      * 
-     * @return bool per l'esistenza dell'arco
+     * @return Puntatore al nuovo array, da passare ad adoptNodes
      */
-    bool hasEdge(const T &origin_node, const T &destination_node)
+    node *allocateNodes(unsigned int capacity) const
     {
-        int origin_index = -1;
-        int destination_index = -1;
-        try
-        {
+        return std::is_nothrow_move_assignable<T>::value ? newNodeArray(capacity) : copyNodes(capacity);
+    }
 
-            for (unsigned int i = 0; i < _size; i++)
-            {
-                if (_nodes[i].name == origin_node)
-                {
-                    origin_index = i;
-                }
-            }
-            for (unsigned int i = 0; i < _size; i++)
+    /**
+     * @brief Sostituisce l'array di nodi con quello di allocateNodes
+     * 
+     * Da chiamare prima di aggiornare _capacity. Non lancia eccezioni
+     */
+    void adoptNodes(node *tmp_nodes) noexcept
+    {
+        if (std::is_nothrow_move_assignable<T>::value)
+        {
+            for (unsigned int i = 0; i < _slots; i++)
             {
-                if (_nodes[i].name == destination_node)
-                {
-                    destination_index = i;
-                }
+                tmp_nodes[i].name = std::move(_nodes[i].name);
             }
-            // Se non sono stati trovati nodi corrispondenti lancio un errore
-            if (origin_index == -1 || destination_index == -1)
-            {
-                throw 1;
-            };
         }
-        catch (int e)
+        std::swap(tmp_nodes, _nodes);
+        deleteNodeArray(tmp_nodes, _capacity);
+    }
+
+    /**
+     * @brief Copia gli archi da una matrice con la stessa politica
+     */
+    void copyAdjacency(const storage_type &other)
+    {
+        storage_type tmp(other, _matrix.get_allocator());
+        _matrix.swap(tmp);
+    }
+
+    /**
+     * @brief Copia gli archi da una matrice con un'altra politica
+     * 
+     * Enumera i successori di ogni riga di other; i pesi passano solo se
+     * entrambe le politiche li hanno (vedi copyEdge)
+     */
+    template <typename OStorage>
+    void copyAdjacency(const OStorage &other)
+    {
+        storage_type tmp(other.size(), 0, _matrix.get_allocator());
+        for (unsigned int i = 0; i < other.size(); i++)
         {
-            throw;
-        };
+            other.forEachSuccessor(i, [&tmp, &other, i](unsigned int j) { copyEdge(tmp, other, i, j); });
+        }
+        _matrix.swap(tmp);
+    }
+
+    /**
+     * @brief Segna come vivo il nodo in posizione index
+     */
+    void setAlive(unsigned int index) noexcept
+    {
+        _alive[index / dense_bitset::bitsPerWord] |= word_type(1) << (index % dense_bitset::bitsPerWord);
+    }
 
-        return _matrix[origin_index][destination_index];
+    /**
+     * @brief Distrugge tutte le colonne
+     */
+    void destroyColumns() noexcept
+    {
+        for (size_t c = 0; c < _columns.size(); c++)
+        {
+            _columns[c]->destroy();
+        }
+        _columns.clear();
     }
 
+public:
     // ITERATORI //////////////////////////////////////////////////////////////////
 
+    /**
+     * @brief Iteratore costante sui nodi
+     * 
+     * Visita i nodi in ordine di posizione saltando quelli rimossi. Legge
+     * solo l'array dei nomi e i bit dei nodi vivi, una parola ogni 64 nodi
+     */
     class const_iterator
     {
-        const node *_ptr;
+        const node *_nodes;       ///< Array dei nomi
+        const word_type *_alive;  ///< Bit dei nodi vivi
+        unsigned int _index;      ///< Posizione corrente
+        unsigned int _end;        ///< Numero di posizioni
+        word_type _bits;          ///< Bit della parola di _index, a partire da _index
 
     public:
         typedef std::forward_iterator_tag iterator_category;
@@ -629,9 +2018,9 @@ public:
         * 
         * Costruttore di default per istanziare un const iterator
         * 
-        * @post _ptr == nullptr
+        * @post _nodes == nullptr
         */
-        const_iterator() : _ptr(nullptr){};
+        const_iterator() : _nodes(nullptr), _alive(nullptr), _index(0), _end(0), _bits(0){};
 
         /**
         * @brief Copy constructor
@@ -640,7 +2029,8 @@ public:
         * 
         * @param other altro const iterator da copiare
         */
-        const_iterator(const const_iterator &other) : _ptr(nullptr){};
+        const_iterator(const const_iterator &other)
+            : _nodes(other._nodes), _alive(other._alive), _index(other._index), _end(other._end), _bits(other._bits){};
 
         /**
         * @brief Operatore di assegnamento 
@@ -654,7 +2044,11 @@ public:
         */
         const_iterator &operator=(const const_iterator &other)
         {
-            _ptr = other._ptr;
+            _nodes = other._nodes;
+            _alive = other._alive;
+            _index = other._index;
+            _end = other._end;
+            _bits = other._bits;
 
             return *this;
         };
@@ -675,7 +2069,7 @@ public:
         */
         reference operator*() const
         {
-            return *_ptr;
+            return _nodes[_index];
         }
 
         /**
@@ -687,7 +2081,7 @@ public:
         */
         pointer operator->() const
         {
-            return _ptr;
+            return _nodes + _index;
         }
 
         /**
@@ -701,7 +2095,7 @@ public:
         const_iterator operator++(int)
         {
             const_iterator tmp(*this);
-            ++_ptr;
+            advance();
             return tmp;
         }
 
@@ -714,7 +2108,7 @@ public:
         */
         const_iterator &operator++()
         {
-            ++_ptr;
+            advance();
             return *this;
         }
 
@@ -723,11 +2117,11 @@ public:
         * 
         * operator==, operatore di ugualianza
         * 
-        * @return se i due puntatori hanno lo stesso indirizzo
+        * @return se i due iteratori sono nella stessa posizione
         */
         bool operator==(const const_iterator &other) const
         {
-            return _ptr == other._ptr;
+            return _index == other._index;
         }
 
         /**
@@ -735,11 +2129,11 @@ public:
         * 
         * operator!=, operatore di diversità
         * 
-        * @return se i due puntatori hanno un indirizzo diverso
+        * @return se i due iteratori sono in posizioni diverse
         */
         bool operator!=(const const_iterator &other) const
         {
-            return _ptr != other._ptr;
+            return _index != other._index;
         }
 
     private:
@@ -755,7 +2149,59 @@ public:
         * Costruttore privato di inizializzazione usato dalla classe container
         * tipicamente nei metodi begin e end
         */
-        const_iterator(const node *p) : _ptr(p) {}
+        const_iterator(const node *nodes, const word_type *alive, unsigned int index, unsigned int end)
+            : _nodes(nodes), _alive(alive), _index(index), _end(end), _bits(0)
+        {
+            if (_index < _end)
+            {
+                _bits = _alive[_index / dense_bitset::bitsPerWord] >> (_index % dense_bitset::bitsPerWord);
+            }
+            skipRemoved();
+        }
+
+        /**
+        * @brief Passa alla posizione successiva e salta i nodi rimossi
+        */
+        void advance()
+        {
+            ++_index;
+            _bits >>= 1;
+            if (_index % dense_bitset::bitsPerWord == 0 && _index < _end)
+            {
+                _bits = _alive[_index / dense_bitset::bitsPerWord];
+            }
+            skipRemoved();
+        }
+
+        /**
+        * @brief Avanza fino al primo nodo non rimosso (o alla fine)
+        * 
+        * Salta 64 posizioni rimosse alla volta; i bit oltre la fine sono a 0
+        */
+        void skipRemoved()
+        {
+            while (_index < _end)
+            {
+                if ((_bits & 1) != 0)
+                {
+                    // Caso comune: la posizione è viva
+                    return;
+                }
+                if (_bits != 0)
+                {
+                    unsigned int skip = dense_bitset::countTrailingZeros(_bits);
+                    _index += skip;
+                    _bits >>= skip;
+                    return;
+                }
+                _index = (_index / dense_bitset::bitsPerWord + 1) * dense_bitset::bitsPerWord;
+                if (_index < _end)
+                {
+                    _bits = _alive[_index / dense_bitset::bitsPerWord];
+                }
+            }
+            _index = _end;
+        }
 
     }; // FINE classe const_iterator
 
@@ -768,7 +2214,7 @@ public:
      */
     const_iterator begin() const
     {
-        return const_iterator(_nodes);
+        return const_iterator(_nodes, _alive.data(), 0, _slots);
     }
 
     /**
@@ -780,14 +2226,14 @@ public:
      */
     const_iterator end() const
     {
-        return const_iterator(_nodes + _size);
+        return const_iterator(_nodes, _alive.data(), _slots, _slots);
     }
 
     /**
     * Funzione usata su operatore << per mandare un oggetto node
     * su uno stream di dati di output
     */
-    friend std::ostream &operator<<(std::ostream &os, const typename graph<T>::node &nd)
+    friend std::ostream &operator<<(std::ostream &os, const typename graph::node &nd)
     {
         os << nd.name;
         return os;
@@ -804,18 +2250,63 @@ public:
     }
 }; // FINE CLASSE;
 
+/**
+* Unione degli archi di due graph con gli stessi nodi (vedi graph::operator|=)
+*/
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+graph<T, Storage, Hash, KeyEqual, Allocator> operator|(graph<T, Storage, Hash, KeyEqual, Allocator> first,
+                                            const graph<T, Storage, Hash, KeyEqual, Allocator> &second)
+{
+    first |= second;
+    return first;
+}
+
+/**
+* Intersezione degli archi di due graph con gli stessi nodi (vedi graph::operator&=)
+*/
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+graph<T, Storage, Hash, KeyEqual, Allocator> operator&(graph<T, Storage, Hash, KeyEqual, Allocator> first,
+                                            const graph<T, Storage, Hash, KeyEqual, Allocator> &second)
+{
+    first &= second;
+    return first;
+}
+
+/**
+* Differenza degli archi di due graph con gli stessi nodi (vedi graph::operator-=)
+*/
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+graph<T, Storage, Hash, KeyEqual, Allocator> operator-(graph<T, Storage, Hash, KeyEqual, Allocator> first,
+                                            const graph<T, Storage, Hash, KeyEqual, Allocator> &second)
+{
+    first -= second;
+    return first;
+}
+
+/**
+* Scambia due graph senza copiarli, trovata anche tramite ADL
+*/
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+void swap(graph<T, Storage, Hash, KeyEqual, Allocator> &first, graph<T, Storage, Hash, KeyEqual, Allocator> &second) noexcept
+{
+    first.swap(second);
+}
+
 /**
 * Funzione usata su operatore << per mandare un oggetto graph
 * su uno stream di dati di output
 */
-template <typename T>
-std::ostream &operator<<(std::ostream &os, const graph<T> &gr)
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+std::ostream &operator<<(std::ostream &os, const graph<T, Storage, Hash, KeyEqual, Allocator> &gr)
 {
-    for (unsigned int i = 0; i < gr.size(); i++)
+    for (unsigned int i = 0; i < gr.slots(); i++)
     {
+        if (!gr.isAlive(i))
+            continue;
         os << gr.nodeFromIndex(i).name << ": ";
-        for (unsigned int j = 0; j < gr.size(); j++)
-            os << gr.matrix()[i][j] << " ";
+        for (unsigned int j = 0; j < gr.slots(); j++)
+            if (gr.isAlive(j))
+                os << gr.adjacency().test(i, j) << " ";
         os << std::endl;
     }
 
@@ -0,0 +1,280 @@
+#ifndef GRAPH_ALGORITHMS_H
+#define GRAPH_ALGORITHMS_H
+
+#include <algorithm> // std::reverse
+#include <vector>
+#include <stddef.h> // size_t
+#include "graph.h"
+
+/**
+ * @file graph_algorithms.h
+ * @brief Componenti fortemente connesse, grafo condensato e ordinamento topologico
+ *
+ * Tutti gli algoritmi sono iterativi, con pile esplicite allocate una volta
+ * sola, quindi la profondità del graph non è limitata dallo stack. Costano
+ * O(N + E), più la scansione delle righe con dense_bitset (O(N^2 / 64)).
+ * Gli indici sono posizioni del graph (vedi graph::slots); le posizioni
+ * rimosse vengono ignorate.
+ */
+
+/**
+ * @brief Risultato di stronglyConnectedComponents
+ */
+struct scc_result
+{
+    std::vector<int> component; ///< Componente di ogni posizione, -1 per le posizioni rimosse
+    unsigned int count;         ///< Numero di componenti
+
+    scc_result() : component(), count(0){};
+};
+
+/**
+ * @brief Componenti fortemente connesse (algoritmo di Tarjan iterativo)
+ *
+ * Le componenti sono numerate in ordine topologico: se esiste un arco da
+ * una componente c1 a una componente c2 diversa, allora c1 < c2.
+ *
+ * @param gr graph da analizzare
+ *
+ * @return Componente di ogni posizione e numero di componenti
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+scc_result stronglyConnectedComponents(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr)
+{
+    typedef typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type storage_type;
+    typedef typename storage_type::successor_range::iterator successor_iterator;
+
+    /**
+     * Nodo in visita con la posizione raggiunta tra i suoi successori
+     */
+    struct frame
+    {
+        unsigned int node;
+        successor_iterator next;
+        successor_iterator end;
+    };
+
+    const unsigned int n = gr.slots();
+    const storage_type &storage = gr.adjacency();
+    scc_result result;
+    result.component.assign(n, -1);
+
+    std::vector<unsigned int> order(n, 0);   // Ordine di scoperta + 1, 0 se non ancora scoperto
+    std::vector<unsigned int> lowlink(n, 0);
+    std::vector<unsigned int> stack;         // Nodi non ancora assegnati a una componente
+    std::vector<frame> calls;                // Pila delle chiamate
+    stack.reserve(n);
+    unsigned int discovered = 0;
+
+    for (unsigned int root = 0; root < n; root++)
+    {
+        if (!gr.isAlive(root) || order[root] != 0)
+        {
+            continue;
+        }
+
+        order[root] = lowlink[root] = ++discovered;
+        stack.push_back(root);
+        frame first = {root, storage.successors(root).begin(), storage.successors(root).end()};
+        calls.push_back(first);
+
+        while (!calls.empty())
+        {
+            frame &top = calls.back();
+            if (top.next != top.end)
+            {
+                unsigned int v = *top.next;
+                ++top.next;
+                if (order[v] == 0)
+                {
+                    order[v] = lowlink[v] = ++discovered;
+                    stack.push_back(v);
+                    frame callee = {v, storage.successors(v).begin(), storage.successors(v).end()};
+                    // top non è più valido dopo push_back
+                    calls.push_back(callee);
+                }
+                else if (result.component[v] == -1)
+                {
+                    // v è ancora sulla pila: arco all'indietro o trasversale
+                    lowlink[top.node] = std::min(lowlink[top.node], order[v]);
+                }
+                continue;
+            }
+
+            unsigned int u = top.node;
+            calls.pop_back();
+            if (lowlink[u] == order[u])
+            {
+                // u è la radice di una componente: la tolgo dalla pila
+                unsigned int v;
+                do
+                {
+                    v = stack.back();
+                    stack.pop_back();
+                    result.component[v] = static_cast<int>(result.count);
+                } while (v != u);
+                result.count++;
+            }
+            if (!calls.empty())
+            {
+                unsigned int parent = calls.back().node;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[u]);
+            }
+        }
+    }
+
+    // Tarjan chiude prima le componenti pozzo: inverto la numerazione
+    for (unsigned int i = 0; i < n; i++)
+    {
+        if (result.component[i] != -1)
+        {
+            result.component[i] = static_cast<int>(result.count) - 1 - result.component[i];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Grafo condensato
+ *
+ * Ogni componente fortemente connessa diventa un nodo, con nome pari al suo
+ * numero in stronglyConnectedComponents; tra due componenti diverse c'è un
+ * arco se almeno un arco del graph le collega. Il risultato è aciclico e
+ * usa sparse_adjacency, perché di solito ha pochi archi.
+ *
+ * @param gr graph da condensare
+ * @param components Componenti di gr, come restituite da stronglyConnectedComponents
+ *
+ * @return Grafo condensato, con il nodo c in posizione c
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+graph<unsigned int, sparse_adjacency> condensation(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr,
+                                                   const scc_result &components)
+{
+    graph<unsigned int, sparse_adjacency> dag;
+    dag.reserve(components.count);
+    for (unsigned int c = 0; c < components.count; c++)
+    {
+        dag.addNode(c);
+    }
+
+    for (unsigned int i = 0; i < gr.slots(); i++)
+    {
+        if (!gr.isAlive(i))
+        {
+            continue;
+        }
+        int from = components.component[i];
+        gr.adjacency().forEachSuccessor(i, [&](unsigned int j) {
+            int to = components.component[j];
+            if (to != from)
+            {
+                dag.addEdge(from, to);
+            }
+        });
+    }
+    return dag;
+}
+
+/**
+ * @brief Grafo condensato, calcolando anche le componenti
+ *
+ * @param gr graph da condensare
+ *
+ * @return Grafo condensato (vedi condensation(gr, components))
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+graph<unsigned int, sparse_adjacency> condensation(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr)
+{
+    return condensation(gr, stronglyConnectedComponents(gr));
+}
+
+/**
+ * @brief Ordinamento topologico (algoritmo di Kahn)
+ *
+ * Se il graph contiene un ciclo l'ordinamento non esiste: order contiene
+ * allora solo i nodi che non dipendono da alcun ciclo e, se cycle non è
+ * nullo, vi viene scritto un ciclo del graph. Un cappio (arco da un nodo a
+ * sé stesso) è un ciclo di un nodo.
+ *
+ * @param gr graph da ordinare
+ * @param order Posizioni dei nodi in ordine topologico
+ * @param cycle Se non nullo riceve le posizioni di un ciclo, nell'ordine
+ *        degli archi, quando l'ordinamento fallisce
+ *
+ * @return true se il graph è aciclico
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+bool topologicalSort(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, std::vector<unsigned int> &order,
+                     std::vector<unsigned int> *cycle = nullptr)
+{
+    typedef typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type storage_type;
+
+    const unsigned int n = gr.slots();
+    const storage_type &storage = gr.adjacency();
+
+    std::vector<unsigned int> inDegree(n, 0);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        storage.forEachSuccessor(i, [&inDegree](unsigned int j) { inDegree[j]++; });
+    }
+
+    // order fa anche da coda: i nodi tra done e la fine sono pronti
+    order.clear();
+    order.reserve(gr.size());
+    for (unsigned int i = 0; i < n; i++)
+    {
+        if (gr.isAlive(i) && inDegree[i] == 0)
+        {
+            order.push_back(i);
+        }
+    }
+    for (size_t done = 0; done < order.size(); done++)
+    {
+        storage.forEachSuccessor(order[done], [&](unsigned int j) {
+            if (--inDegree[j] == 0)
+            {
+                order.push_back(j);
+            }
+        });
+    }
+
+    if (order.size() == gr.size())
+    {
+        return true;
+    }
+    if (cycle == nullptr)
+    {
+        return false;
+    }
+
+    // Ogni nodo rimasto ha un predecessore rimasto: risalendo i predecessori
+    // si torna prima o poi su un nodo già visto, che chiude il ciclo
+    unsigned int start = 0;
+    while (!gr.isAlive(start) || inDegree[start] == 0)
+    {
+        start++;
+    }
+    std::vector<unsigned int> seen(n, 0); // Posizione nella risalita + 1, 0 se non visto
+    std::vector<unsigned int> path;
+    unsigned int u = start;
+    while (seen[u] == 0)
+    {
+        path.push_back(u);
+        seen[u] = static_cast<unsigned int>(path.size());
+        typename storage_type::predecessor_range in = storage.predecessors(u);
+        for (typename storage_type::predecessor_range::iterator it = in.begin(); it != in.end(); ++it)
+        {
+            if (inDegree[*it] != 0)
+            {
+                u = *it;
+                break;
+            }
+        }
+    }
+    cycle->assign(path.begin() + (seen[u] - 1), path.end());
+    std::reverse(cycle->begin(), cycle->end());
+    return false;
+}
+
+#endif
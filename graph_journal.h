@@ -0,0 +1,307 @@
+#ifndef GRAPH_JOURNAL_H
+#define GRAPH_JOURNAL_H
+
+#include <vector>
+#include <type_traits> // std::conditional, std::is_void
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+
+/**
+ * @file graph_journal.h
+ * @brief Dichiarazione della classe graph_journal
+ */
+
+/**
+ * @brief Registro in sola aggiunta delle modifiche di un graph
+ *
+ * Si aggancia a un graph con graph::setJournal; da quel momento ogni
+ * modifica del graph viene registrata per nome, con un numero di sequenza
+ * crescente. Una replica o una cache legge le modifiche successive
+ * all'ultima sequenza vista con forEachSince e le applica con
+ * graph::applyJournal, in O(modifiche) invece di ricopiare il graph.
+ *
+ * Ogni modifica occupa un byte di operazione più i nomi coinvolti; per i
+ * graph con pesi (vedi weighted_adjacency.h) ogni add_edge conserva anche
+ * il peso dell'arco dopo la modifica, così la replica riceve pesi nuovi e
+ * cambiati. Ogni checkpointEvery modifiche viene salvata la posizione del
+ * primo nome e del primo peso, così forEachSince parte senza scorrere tutto
+ * il registro. Le modifiche già lette da tutti si eliminano con
+ * discardBefore.
+ *
+ * La registrazione non lancia eccezioni: se manca memoria la modifica va
+ * persa e lost() diventa true. Chi legge deve allora ricopiare il graph.
+ *
+ * @tparam T Tipo del nome dei nodi
+ * @tparam W Tipo del peso degli archi, void per i graph senza pesi
+ */
+template <typename T, typename W = void>
+class graph_journal
+{
+public:
+    typedef W weight_type; ///< Tipo del peso degli archi
+
+    /**
+     * @brief Tipo di modifica
+     */
+    enum operation
+    {
+        add_node,    ///< Aggiunta di un nodo
+        remove_node, ///< Rimozione di un nodo con i suoi archi
+        add_edge,    ///< Aggiunta di un arco
+        remove_edge, ///< Rimozione di un arco
+        clear        ///< Il graph è stato svuotato
+    };
+
+    /**
+     * @brief Modifica letta dal registro
+     */
+    struct change
+    {
+        uint64_t sequence;      ///< Numero di sequenza
+        operation op;           ///< Tipo di modifica
+        const T *origin;        ///< Nodo, o origine dell'arco; nullptr per clear
+        const T *destination;   ///< Destinazione dell'arco, nullptr se non è un arco
+        const W *weight;        ///< Peso dell'arco per add_edge con W non void, altrimenti nullptr
+    };
+
+    static const unsigned int checkpointEvery = 256; ///< Modifiche tra due checkpoint
+
+private:
+    static const bool weighted = !std::is_void<W>::value; ///< true se add_edge conserva il peso
+
+    /// Tipo conservato per i pesi: con W void il vettore resta vuoto
+    typedef typename std::conditional<weighted, W, char>::type stored_weight;
+
+    /**
+     * @brief Posizione del primo nome e del primo peso di un gruppo
+     */
+    struct checkpoint
+    {
+        size_t name;
+        size_t weight;
+    };
+
+    std::vector<unsigned char> _ops;        ///< Operazione di ogni modifica
+    std::vector<T> _names;                  ///< Nomi coinvolti, in ordine
+    std::vector<stored_weight> _weights;    ///< Pesi degli add_edge, in ordine
+    std::vector<checkpoint> _checkpoints;   ///< Inizio di ogni gruppo di checkpointEvery modifiche
+    uint64_t _first;                        ///< Sequenza della prima modifica conservata
+    bool _lost;                             ///< true se una modifica non è stata registrata
+
+public:
+    /**
+     * @brief Costruttore di default
+     *
+     * @post nextSequence() == 0
+     */
+    graph_journal() : _ops(), _names(), _weights(), _checkpoints(), _first(0), _lost(false){};
+
+    /**
+     * @brief Sequenza della prima modifica ancora nel registro
+     */
+    uint64_t firstSequence() const
+    {
+        return _first;
+    };
+
+    /**
+     * @brief Sequenza che avrà la prossima modifica
+     */
+    uint64_t nextSequence() const
+    {
+        return _first + _ops.size();
+    };
+
+    /**
+     * @brief true se almeno una modifica non è stata registrata
+     */
+    bool lost() const
+    {
+        return _lost;
+    };
+
+    /**
+     * @brief Chiama f(change) per ogni modifica con sequenza >= since
+     *
+     * Lancia un errore se since precede firstSequence(), cioè se le
+     * modifiche richieste sono già state eliminate
+     *
+     * @param since Prima sequenza da leggere
+     * @param f Funzione chiamata con un const change &
+     *
+     * @return Sequenza da cui ripartire alla prossima lettura
+     */
+    template <typename F>
+    uint64_t forEachSince(uint64_t since, F f) const
+    {
+        if (since < _first)
+        {
+            throw 1;
+        }
+        size_t k = static_cast<size_t>(since - _first);
+        if (k >= _ops.size())
+        {
+            return nextSequence();
+        }
+        // Parto dal checkpoint precedente e salto nomi e pesi fino a since
+        size_t group = k / checkpointEvery;
+        size_t name = _checkpoints[group].name;
+        size_t weight = _checkpoints[group].weight;
+        for (size_t s = group * checkpointEvery; s < k; s++)
+        {
+            name += namesOf(_ops[s]);
+            weight += weightsOf(_ops[s]);
+        }
+        for (; k < _ops.size(); k++)
+        {
+            operation op = static_cast<operation>(_ops[k]);
+            unsigned int count = namesOf(_ops[k]);
+            unsigned int weights = weightsOf(_ops[k]);
+            change c = {_first + k, op, count > 0 ? &_names[name] : nullptr, count > 1 ? &_names[name + 1] : nullptr,
+                        weights > 0 ? weightAt(weight) : nullptr};
+            f(static_cast<const change &>(c));
+            name += count;
+            weight += weights;
+        }
+        return nextSequence();
+    };
+
+    /**
+     * @brief Elimina le modifiche con sequenza < sequence
+     *
+     * Vengono eliminati solo gruppi interi di checkpointEvery modifiche:
+     * alcune modifiche precedenti possono restare
+     *
+     * @param sequence Prima sequenza che serve ancora
+     */
+    void discardBefore(uint64_t sequence)
+    {
+        if (sequence <= _first)
+        {
+            return;
+        }
+        size_t groups = static_cast<size_t>(sequence - _first) / checkpointEvery;
+        if (groups == 0)
+        {
+            return;
+        }
+        size_t ops = groups * checkpointEvery;
+        if (ops > _ops.size())
+        {
+            groups = _ops.size() / checkpointEvery;
+            ops = groups * checkpointEvery;
+        }
+        size_t names = groups < _checkpoints.size() ? _checkpoints[groups].name : _names.size();
+        size_t weights = groups < _checkpoints.size() ? _checkpoints[groups].weight : _weights.size();
+
+        _ops.erase(_ops.begin(), _ops.begin() + ops);
+        _names.erase(_names.begin(), _names.begin() + names);
+        _weights.erase(_weights.begin(), _weights.begin() + weights);
+        _checkpoints.erase(_checkpoints.begin(), _checkpoints.begin() + groups);
+        for (size_t g = 0; g < _checkpoints.size(); g++)
+        {
+            _checkpoints[g].name -= names;
+            _checkpoints[g].weight -= weights;
+        }
+        _first += ops;
+    };
+
+    /**
+     * @brief Registra l'aggiunta o la rimozione di un nodo
+     */
+    void recordNode(operation op, const T &name) noexcept
+    {
+        append(op, &name, nullptr, nullptr);
+    };
+
+    /**
+     * @brief Registra l'aggiunta o la rimozione di un arco
+     *
+     * @param weight Peso dell'arco dopo un add_edge; con W non void un
+     *        add_edge senza peso registra W()
+     */
+    void recordEdge(operation op, const T &origin, const T &destination, const W *weight = nullptr) noexcept
+    {
+        append(op, &origin, &destination, weight);
+    };
+
+    /**
+     * @brief Registra lo svuotamento del graph
+     */
+    void recordClear() noexcept
+    {
+        append(clear, nullptr, nullptr, nullptr);
+    };
+
+private:
+    /**
+     * @brief Numero di nomi di una modifica
+     */
+    static unsigned int namesOf(unsigned char op)
+    {
+        return op == clear ? 0 : (op == add_edge || op == remove_edge ? 2 : 1);
+    };
+
+    /**
+     * @brief Numero di pesi di una modifica
+     */
+    static unsigned int weightsOf(unsigned char op)
+    {
+        return weighted && op == add_edge ? 1 : 0;
+    };
+
+    /**
+     * @brief Puntatore al peso in posizione k
+     */
+    const W *weightAt(size_t k) const
+    {
+        return static_cast<const W *>(&_weights[k]);
+    };
+
+    /**
+     * @brief Aggiunge una modifica, tutta o niente
+     */
+    void append(operation op, const T *origin, const T *destination, const W *weight) noexcept
+    {
+        size_t names = _names.size();
+        size_t weights = _weights.size();
+        size_t checkpoints = _checkpoints.size();
+        try
+        {
+            if (_ops.size() % checkpointEvery == 0)
+            {
+                checkpoint at = {names, weights};
+                _checkpoints.push_back(at);
+            }
+            if (origin != nullptr)
+            {
+                _names.push_back(*origin);
+            }
+            if (destination != nullptr)
+            {
+                _names.push_back(*destination);
+            }
+            if (weightsOf(static_cast<unsigned char>(op)) > 0)
+            {
+                _weights.push_back(weight != nullptr ? *static_cast<const stored_weight *>(weight)
+                                                     : stored_weight());
+            }
+            _ops.push_back(static_cast<unsigned char>(op));
+        }
+        catch (...)
+        {
+            _names.erase(_names.begin() + names, _names.end());
+            _weights.erase(_weights.begin() + weights, _weights.end());
+            _checkpoints.erase(_checkpoints.begin() + checkpoints, _checkpoints.end());
+            _lost = true;
+        }
+    };
+};
+
+template <typename T, typename W>
+const unsigned int graph_journal<T, W>::checkpointEvery;
+
+template <typename T, typename W>
+const bool graph_journal<T, W>::weighted;
+
+#endif
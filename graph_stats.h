@@ -0,0 +1,179 @@
+#ifndef GRAPH_STATS_H
+#define GRAPH_STATS_H
+
+#include <stdint.h> // uint64_t
+
+#ifdef GRAPH_STATS_TIMERS
+#ifndef GRAPH_STATS
+#define GRAPH_STATS 1
+#endif
+#endif
+
+#ifdef GRAPH_STATS
+#include <atomic>
+#endif
+#ifdef GRAPH_STATS_TIMERS
+#include <chrono>
+#endif
+
+/**
+ * @file graph_stats.h
+ * @brief Contatori e tempi delle operazioni di graph, opzionali
+ *
+ * Senza macro graph non conta niente: stats() restituisce un graph_stats
+ * a zero e il graph non ha membri in più. Compilando con -DGRAPH_STATS
+ * ogni graph conta le modifiche di nodi e archi, le ricerche per nome, le
+ * riallocazioni e i byte che alloca per nodi e indice; con
+ * -DGRAPH_STATS_TIMERS misura anche il tempo speso, al costo di due letture
+ * dell'orologio per operazione.
+ *
+ * I contatori sono atomici con ordinamento rilassato, quindi le ricerche
+ * const restano utilizzabili da più thread. La macro cambia la struttura
+ * di graph: va definita allo stesso modo in tutte le unità di traduzione.
+ */
+
+/**
+ * @brief Contatori di un graph, letti con graph::stats()
+ *
+ * I tempi sono in nanosecondi e si sovrappongono: il tempo di una modifica
+ * comprende quello delle ricerche che fa.
+ */
+struct graph_stats
+{
+    uint64_t node_insertions; ///< Nodi aggiunti
+    uint64_t node_removals;   ///< Nodi rimossi
+    uint64_t edge_insertions; ///< Chiamate che aggiungono un arco
+    uint64_t edge_removals;   ///< Chiamate che rimuovono un arco
+    uint64_t lookups;         ///< Ricerche di un nome nell'indice
+    uint64_t reallocations;   ///< Riallocazioni dell'array di nodi
+    uint64_t bytes_allocated; ///< Byte allocati per nodi e indice
+    uint64_t mutation_ns;     ///< Tempo nelle modifiche (GRAPH_STATS_TIMERS)
+    uint64_t lookup_ns;       ///< Tempo nelle ricerche (GRAPH_STATS_TIMERS)
+
+    graph_stats()
+        : node_insertions(0), node_removals(0), edge_insertions(0), edge_removals(0), lookups(0),
+          reallocations(0), bytes_allocated(0), mutation_ns(0), lookup_ns(0){};
+};
+
+/**
+ * @brief Identificativo di un contatore di graph_stats
+ */
+enum graph_counter
+{
+    node_insertions_counter,
+    node_removals_counter,
+    edge_insertions_counter,
+    edge_removals_counter,
+    lookups_counter,
+    reallocations_counter,
+    bytes_allocated_counter,
+    mutation_ns_counter,
+    lookup_ns_counter,
+    graph_counter_count
+};
+
+#ifdef GRAPH_STATS
+/**
+ * @brief Contatori atomici di un graph
+ *
+ * Una copia parte da zero: i contatori appartengono all'oggetto, non al
+ * contenuto.
+ */
+class graph_counters
+{
+    std::atomic<uint64_t> _values[graph_counter_count]; ///< Un valore per contatore
+
+public:
+    graph_counters()
+    {
+        reset();
+    };
+
+    graph_counters(const graph_counters &)
+    {
+        reset();
+    };
+
+    graph_counters &operator=(const graph_counters &)
+    {
+        return *this;
+    };
+
+    /**
+     * @brief Aggiunge n al contatore c
+     */
+    void add(graph_counter c, uint64_t n) noexcept
+    {
+        _values[c].fetch_add(n, std::memory_order_relaxed);
+    };
+
+    /**
+     * @brief Azzera tutti i contatori
+     */
+    void reset() noexcept
+    {
+        for (unsigned int c = 0; c < graph_counter_count; c++)
+        {
+            _values[c].store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Fotografia dei contatori
+     */
+    graph_stats read() const
+    {
+        graph_stats s;
+        s.node_insertions = _values[node_insertions_counter].load(std::memory_order_relaxed);
+        s.node_removals = _values[node_removals_counter].load(std::memory_order_relaxed);
+        s.edge_insertions = _values[edge_insertions_counter].load(std::memory_order_relaxed);
+        s.edge_removals = _values[edge_removals_counter].load(std::memory_order_relaxed);
+        s.lookups = _values[lookups_counter].load(std::memory_order_relaxed);
+        s.reallocations = _values[reallocations_counter].load(std::memory_order_relaxed);
+        s.bytes_allocated = _values[bytes_allocated_counter].load(std::memory_order_relaxed);
+        s.mutation_ns = _values[mutation_ns_counter].load(std::memory_order_relaxed);
+        s.lookup_ns = _values[lookup_ns_counter].load(std::memory_order_relaxed);
+        return s;
+    };
+};
+#endif
+
+/**
+ * @brief Misura il tempo fino alla distruzione e lo aggiunge a un contatore
+ *
+ * Senza GRAPH_STATS_TIMERS è vuoto e il compilatore lo elimina.
+ */
+class graph_stats_timer
+{
+#ifdef GRAPH_STATS_TIMERS
+    graph_counters *_counters;                     ///< Destinazione, nullptr dopo uno spostamento
+    graph_counter _counter;                        ///< Contatore dei nanosecondi
+    std::chrono::steady_clock::time_point _start;  ///< Inizio della misura
+
+public:
+    graph_stats_timer(graph_counters &counters, graph_counter counter)
+        : _counters(&counters), _counter(counter), _start(std::chrono::steady_clock::now()){};
+
+    graph_stats_timer(graph_stats_timer &&other) noexcept
+        : _counters(other._counters), _counter(other._counter), _start(other._start)
+    {
+        other._counters = nullptr;
+    };
+
+    ~graph_stats_timer()
+    {
+        if (_counters != nullptr)
+        {
+            _counters->add(_counter, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - _start)
+                                         .count());
+        }
+    };
+#else
+public:
+    // Il distruttore dichiarato evita gli avvisi di variabile inutilizzata
+    ~graph_stats_timer(){};
+#endif
+};
+
+#endif
@@ -0,0 +1,354 @@
+#ifndef GRAPH_TRAVERSAL_H
+#define GRAPH_TRAVERSAL_H
+
+#include <algorithm> // std::min, std::fill
+#include <atomic>
+#include <vector>
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+#include "graph.h"
+#include "thread_pool.h"
+
+/**
+ * @file graph_traversal.h
+ * @brief Visita in ampiezza (BFS) e raggiungibilità su graph
+ *
+ * La visita procede per livelli. A ogni livello sceglie come espandere la
+ * frontiera in base alla sua dimensione (direction-optimizing BFS):
+ * - frontiera piccola: top-down, per ogni nodo della frontiera vengono
+ *   enumerati i successori e ognuno viene reclamato con un fetch_or
+ *   atomico sulla bitmap dei visitati;
+ * - frontiera grande: bottom-up, ogni nodo non visitato cerca tra i suoi
+ *   predecessori uno che stia nella frontiera e si ferma al primo trovato;
+ *   con dense_bitset i predecessori sono la riga della vista trasposta,
+ *   intersecata parola per parola con la bitmap della frontiera, con
+ *   sparse_adjacency la lista dei predecessori. Le politiche con pesi usano
+ *   la loro matrice o le loro liste.
+ *
+ * Tutte le funzioni accettano un thread_pool opzionale; con nullptr la
+ * visita avviene nel thread chiamante. Il graph non deve essere modificato
+ * durante la visita.
+ */
+
+/**
+ * @brief Motore della visita in ampiezza su una politica di memorizzazione
+ *
+ * @tparam Storage Politica di memorizzazione (dense_bitset, sparse_adjacency)
+ */
+template <typename Storage>
+class bfs_engine
+{
+    typedef uint64_t word_type;
+
+    static const size_t chunkSize = 1024;   ///< Nodi della frontiera per ogni iterazione parallela
+    static const size_t wordsPerChunk = 64; ///< Parole della bitmap per ogni iterazione parallela
+
+    const Storage &_storage;                    ///< Archi da visitare
+    thread_pool *_pool;                         ///< thread_pool, nullptr per la visita seriale
+    unsigned int _nodes;                        ///< Numero di nodi (posizioni)
+    unsigned int _words;                        ///< Parole di una bitmap di _nodes bit
+    std::vector<std::atomic<word_type> > _visited; ///< Nodi già raggiunti
+    std::vector<word_type> _frontierBits;       ///< Frontiera corrente come bitmap
+    std::vector<unsigned int> _frontier;        ///< Frontiera corrente come lista
+    std::vector<int> _distance;                 ///< Livello di ogni nodo, -1 se non raggiunto
+
+public:
+    /**
+     * @brief Costruttore
+     *
+     * @param storage Archi da visitare
+     * @param pool thread_pool da usare, nullptr per la visita seriale
+     */
+    bfs_engine(const Storage &storage, thread_pool *pool)
+        : _storage(storage), _pool(pool), _nodes(storage.size()), _words((storage.size() + 63) / 64),
+          _visited(_words), _frontierBits(_words, 0), _frontier(), _distance(storage.size(), -1)
+    {
+        for (unsigned int w = 0; w < _words; w++)
+        {
+            _visited[w].store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Esegue la visita
+     *
+     * @param sources Indici dei nodi di partenza
+     * @param target Indice a cui fermarsi appena raggiunto, -1 per visitare tutto
+     *
+     * @return Livello di ogni nodo, -1 se non raggiungibile
+     */
+    const std::vector<int> &run(const std::vector<unsigned int> &sources, int target)
+    {
+        for (size_t k = 0; k < sources.size(); k++)
+        {
+            if (claim(sources[k]))
+            {
+                _distance[sources[k]] = 0;
+                _frontier.push_back(sources[k]);
+            }
+        }
+
+        for (int level = 1; !_frontier.empty(); level++)
+        {
+            if (target != -1 && _distance[target] != -1)
+            {
+                break;
+            }
+            if (isLarge(_frontier.size()))
+            {
+                expandWide(_storage, level);
+            }
+            else
+            {
+                expandTopDown(level);
+            }
+        }
+        return _distance;
+    };
+
+private:
+    /**
+     * @brief Reclama un nodo come visitato
+     *
+     * @return true se il nodo non era ancora stato visitato
+     */
+    bool claim(unsigned int v)
+    {
+        word_type bit = word_type(1) << (v % 64);
+        if (_visited[v / 64].load(std::memory_order_relaxed) & bit)
+        {
+            return false;
+        }
+        return (_visited[v / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+    };
+
+    /**
+     * @brief true se conviene passare all'espansione per blocchi di parole
+     */
+    bool isLarge(size_t frontier) const
+    {
+        return frontier * 64 >= _nodes;
+    };
+
+    /**
+     * @brief Espansione top-down della frontiera
+     */
+    void expandTopDown(int level)
+    {
+        size_t chunks = (_frontier.size() + chunkSize - 1) / chunkSize;
+        std::vector<std::vector<unsigned int> > next(chunks);
+
+        parallelFor(_pool, chunks, [&](size_t c) {
+            size_t end = std::min(_frontier.size(), (c + 1) * chunkSize);
+            for (size_t k = c * chunkSize; k < end; k++)
+            {
+                typename Storage::successor_range out = _storage.successors(_frontier[k]);
+                for (typename Storage::successor_range::iterator it = out.begin(); it != out.end(); ++it)
+                {
+                    if (claim(*it))
+                    {
+                        _distance[*it] = level;
+                        next[c].push_back(*it);
+                    }
+                }
+            }
+        });
+
+        _frontier.clear();
+        for (size_t c = 0; c < chunks; c++)
+        {
+            _frontier.insert(_frontier.end(), next[c].begin(), next[c].end());
+        }
+    };
+
+    /**
+     * @brief Espansione bottom-up per una frontiera grande con dense_bitset
+     *
+     * Ogni nodo non visitato interseca la sua riga della vista trasposta
+     * (i predecessori, vedi basic_dense_bitset::transposed) con la bitmap
+     * della frontiera, parola per parola, e si ferma alla prima parola non
+     * nulla. La vista viene costruita, se manca, prima della parte parallela.
+     */
+    template <typename A>
+    void expandWide(const basic_dense_bitset<A> &matrix, int level)
+    {
+        const basic_dense_bitset<A> &reverse = matrix.transposed();
+        expandBottomUp(level, [this, &reverse](unsigned int v) {
+            const word_type *in = reverse.row(v);
+            for (unsigned int w = 0; w < _words; w++)
+            {
+                if ((in[w] & _frontierBits[w]) != 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        });
+    };
+
+    /**
+     * @brief Espansione bottom-up per una frontiera grande con sparse_adjacency
+     *
+     * Ogni nodo non visitato scorre i suoi predecessori e si ferma al primo
+     * che appartiene alla frontiera.
+     */
+    template <typename A>
+    void expandWide(const basic_sparse_adjacency<A> &lists, int level)
+    {
+        expandBottomUp(level, [this, &lists](unsigned int v) {
+            typename basic_sparse_adjacency<A>::predecessor_range in = lists.predecessors(v);
+            for (const unsigned int *u = in.begin(); u != in.end(); ++u)
+            {
+                if ((_frontierBits[*u / 64] >> (*u % 64)) & 1)
+                {
+                    return true;
+                }
+            }
+            return false;
+        });
+    };
+
+    /**
+     * @brief Le politiche con pesi espandono come la loro matrice o le loro liste
+     */
+    template <typename W, typename A>
+    void expandWide(const dense_weights<W, A> &matrix, int level)
+    {
+        expandWide(matrix.bits(), level);
+    };
+
+    template <typename W, typename A>
+    void expandWide(const sparse_weights<W, A> &lists, int level)
+    {
+        expandWide(lists.lists(), level);
+    };
+
+    /**
+     * @brief Passo bottom-up comune
+     *
+     * Riempie la bitmap della frontiera, poi ogni nodo non visitato chiede a
+     * inFrontier(v) se ha un predecessore nella frontiera. Ogni iterazione
+     * parallela possiede un blocco di parole della bitmap dei visitati.
+     */
+    template <typename F>
+    void expandBottomUp(int level, F inFrontier)
+    {
+        std::fill(_frontierBits.begin(), _frontierBits.end(), word_type(0));
+        for (size_t k = 0; k < _frontier.size(); k++)
+        {
+            _frontierBits[_frontier[k] / 64] |= word_type(1) << (_frontier[k] % 64);
+        }
+
+        size_t chunks = (_words + wordsPerChunk - 1) / wordsPerChunk;
+        std::vector<std::vector<unsigned int> > next(chunks);
+
+        parallelFor(_pool, chunks, [&](size_t c) {
+            unsigned int first = static_cast<unsigned int>(c * wordsPerChunk * 64);
+            unsigned int last = std::min(_nodes, static_cast<unsigned int>((c + 1) * wordsPerChunk * 64));
+            for (unsigned int v = first; v < last; v++)
+            {
+                word_type bit = word_type(1) << (v % 64);
+                if (_visited[v / 64].load(std::memory_order_relaxed) & bit)
+                {
+                    continue;
+                }
+                if (inFrontier(v))
+                {
+                    _visited[v / 64].fetch_or(bit, std::memory_order_relaxed);
+                    _distance[v] = level;
+                    next[c].push_back(v);
+                }
+            }
+        });
+
+        _frontier.clear();
+        for (size_t c = 0; c < chunks; c++)
+        {
+            _frontier.insert(_frontier.end(), next[c].begin(), next[c].end());
+        }
+    };
+
+    /**
+     * @brief Politiche senza espansione dedicata: sempre top-down
+     */
+    template <typename Other>
+    void expandWide(const Other &, int level)
+    {
+        expandTopDown(level);
+    };
+};
+
+/**
+ * @brief Visita in ampiezza da più sorgenti
+ *
+ * @param gr graph da visitare
+ * @param sources Nomi dei nodi di partenza
+ * @param pool thread_pool da usare, nullptr per la visita seriale
+ *
+ * @return Per ogni posizione del graph (vedi graph::slots) la distanza in
+ *         archi dalla sorgente più vicina, -1 se non raggiungibile
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+std::vector<int> multiSourceBfs(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const std::vector<T> &sources,
+                                thread_pool *pool = nullptr)
+{
+    std::vector<unsigned int> indices;
+    indices.reserve(sources.size());
+    for (size_t k = 0; k < sources.size(); k++)
+    {
+        int index = gr.indexOf(sources[k]);
+        if (index == -1)
+        {
+            throw 1;
+        }
+        indices.push_back(index);
+    }
+
+    bfs_engine<typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type> engine(gr.adjacency(), pool);
+    return engine.run(indices, -1);
+}
+
+/**
+ * @brief Visita in ampiezza da una sorgente
+ *
+ * @param gr graph da visitare
+ * @param source Nome del nodo di partenza
+ * @param pool thread_pool da usare, nullptr per la visita seriale
+ *
+ * @return Per ogni posizione del graph la distanza in archi da source,
+ *         -1 se non raggiungibile
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+std::vector<int> bfs(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const T &source, thread_pool *pool = nullptr)
+{
+    return multiSourceBfs(gr, std::vector<T>(1, source), pool);
+}
+
+/**
+ * @brief Verifica se esiste un cammino da un nodo a un altro
+ *
+ * La visita si ferma al primo livello che raggiunge destination_node.
+ *
+ * @param gr graph da visitare
+ * @param origin_node Nome del nodo di partenza
+ * @param destination_node Nome del nodo di arrivo
+ * @param pool thread_pool da usare, nullptr per la visita seriale
+ *
+ * @return true se destination_node è raggiungibile da origin_node
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+bool isReachable(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const T &origin_node, const T &destination_node,
+                 thread_pool *pool = nullptr)
+{
+    int origin_index = gr.indexOf(origin_node);
+    int destination_index = gr.indexOf(destination_node);
+    if (origin_index == -1 || destination_index == -1)
+    {
+        throw 1;
+    }
+
+    bfs_engine<typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type> engine(gr.adjacency(), pool);
+    return engine.run(std::vector<unsigned int>(1, origin_index), destination_index)[destination_index] != -1;
+}
+
+#endif
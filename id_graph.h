@@ -0,0 +1,445 @@
+#ifndef ID_GRAPH_H
+#define ID_GRAPH_H
+
+#include <algorithm>   // std::max, std::swap
+#include <functional>  // std::hash, std::equal_to
+#include <memory>      // std::allocator, std::allocator_traits
+#include <type_traits> // std::is_integral, std::is_enum, std::conditional
+#include <vector>
+#include <stddef.h> // size_t
+#include "dense_bitset.h"
+#include "sparse_adjacency.h"
+
+/**
+ * @file id_graph.h
+ * @brief Dichiarazione della classe id_graph e del trait node_id_traits
+ */
+
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+class graph;
+
+/**
+ * @brief Dice se i nomi di tipo T possono fare da indice nella matrice
+ *
+ * Vale per i tipi interi e le enum: il nome n occupa la riga n. Per un tipo
+ * identificativo dell'utente (per esempio una struct che avvolge un intero)
+ * si specializza con direct = true e le due conversioni.
+ *
+ * @tparam T Tipo del nome dei nodi
+ */
+template <typename T, typename Enable = void>
+struct node_id_traits
+{
+    static const bool direct = false;
+};
+
+template <typename T>
+struct node_id_traits<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>
+{
+    static const bool direct = true;
+    static const unsigned int invalidIndex = 0xffffffffu; ///< Indice dei nomi fuori da 0 .. 2^31 - 1
+
+    /**
+     * @brief Riga del nodo di nome id
+     *
+     * I nomi negativi o maggiori di 2^31 - 1 diventano invalidIndex, che i
+     * controlli sulla capacità rifiutano: un tipo più largo di unsigned int
+     * non deve ricadere per troncamento sulla riga di un altro nome
+     */
+    static constexpr unsigned int toIndex(T id)
+    {
+        return static_cast<long long>(id) >= 0 && static_cast<long long>(id) <= 0x7fffffffLL
+                   ? static_cast<unsigned int>(id)
+                   : invalidIndex;
+    }
+
+    /**
+     * @brief Nome del nodo della riga index
+     */
+    static constexpr T fromIndex(unsigned int index)
+    {
+        return static_cast<T>(index);
+    }
+};
+
+template <typename T>
+const bool node_id_traits<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>::direct;
+
+template <typename T>
+const unsigned int
+    node_id_traits<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>::invalidIndex;
+
+/**
+ * @brief Graph i cui nomi sono gli indici della matrice
+ *
+ * Per nomi interi densi (identificativi compatti da 0 in su) il nome è già
+ * la posizione: id_graph non conserva i nomi e non ha un indice hash, quindi
+ * exists, addEdge e hasEdge costano un accesso alla matrice. Le righe vanno
+ * da 0 al nome più grande aggiunto, anche se alcuni nomi intermedi non
+ * esistono: con nomi sparsi conviene graph. I nodi rimossi lasciano la
+ * riga vuota, che viene riusata se il nome viene aggiunto di nuovo.
+ *
+ * @tparam Id Tipo del nome dei nodi, con node_id_traits<Id>::direct
+ * @tparam Storage Politica di memorizzazione degli archi, come in graph
+ * @tparam Allocator Allocatore per archi e flag di presenza
+ */
+template <typename Id, typename Storage = dense_bitset, typename Allocator = std::allocator<Id> >
+class id_graph
+{
+    static_assert(node_id_traits<Id>::direct, "id_graph richiede nomi interi, enum o un node_id_traits specializzato");
+
+public:
+    typedef Allocator allocator_type;
+    typedef typename Storage::template rebind<Allocator>::other storage_type; ///< Storage con Allocator
+    typedef typename storage_type::successor_range successor_range;     ///< Successori di un nodo (indici)
+    typedef typename storage_type::predecessor_range predecessor_range; ///< Predecessori di un nodo (indici)
+    typedef iterator_range<edge_iterator<storage_type> > edge_range;    ///< Tutti gli archi (indici)
+    typedef dense_bitset::word_type word_type;
+
+private:
+    typedef node_id_traits<Id> traits;
+    typedef std::vector<word_type, typename std::allocator_traits<Allocator>::template rebind_alloc<word_type> >
+        word_vector;
+
+    storage_type _matrix; ///< Archi; la riga i è il nodo di nome fromIndex(i)
+    word_vector _alive;   ///< Bit i a 1 se il nodo i esiste
+    unsigned int _size;   ///< Numero di nodi
+
+public:
+    /**
+     * @brief Costruttore di default
+     *
+     * @param alloc Allocatore
+     */
+    explicit id_graph(const Allocator &alloc = Allocator())
+        : _matrix(typename storage_type::allocator_type(alloc)),
+          _alive(typename word_vector::allocator_type(alloc)), _size(0){};
+
+    /**
+     * @brief Costruttore con i nodi da 0 a count - 1
+     *
+     * @param count Numero di nodi
+     * @param alloc Allocatore
+     */
+    explicit id_graph(unsigned int count, const Allocator &alloc = Allocator())
+        : _matrix(count, count, typename storage_type::allocator_type(alloc)),
+          _alive(dense_bitset::wordsFor(count), 0, typename word_vector::allocator_type(alloc)), _size(count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            _alive[i / dense_bitset::bitsPerWord] |= word_type(1) << (i % dense_bitset::bitsPerWord);
+        }
+    };
+
+    /**
+     * @brief Costruttore da graph
+     *
+     * Copia nodi e archi di un graph con nomi dello stesso tipo; lancia un
+     * errore se un nome non può fare da indice (negativo). Costa O(N + E)
+     * più la riga più alta.
+     *
+     * @param other graph da copiare
+     * @param alloc Allocatore
+     */
+    template <typename OStorage, typename OHash, typename OKeyEqual, typename OAllocator>
+    explicit id_graph(const graph<Id, OStorage, OHash, OKeyEqual, OAllocator> &other,
+                      const Allocator &alloc = Allocator())
+        : id_graph(alloc)
+    {
+        std::vector<unsigned int> rows(other.slots());
+        unsigned int top = 0;
+        for (unsigned int i = 0; i < other.slots(); i++)
+        {
+            if (other.isAlive(i))
+            {
+                rows[i] = checkedIndex(other.nodeFromIndex(i).name);
+                top = std::max(top, rows[i] + 1);
+            }
+        }
+        reserve(top);
+        for (unsigned int i = 0; i < other.slots(); i++)
+        {
+            if (other.isAlive(i))
+            {
+                addNode(other.nodeFromIndex(i).name);
+            }
+        }
+        for (unsigned int i = 0; i < other.slots(); i++)
+        {
+            if (other.isAlive(i))
+            {
+                other.adjacency().forEachSuccessor(i, [this, &rows, i](unsigned int j) {
+                    _matrix.set(rows[i], rows[j]);
+                });
+            }
+        }
+    };
+
+    /**
+     * @brief Scambia lo stato interno con un altro id_graph
+     */
+    void swap(id_graph &other) noexcept
+    {
+        _matrix.swap(other._matrix);
+        _alive.swap(other._alive);
+        std::swap(_size, other._size);
+    };
+
+    /**
+     * @brief Numero di nodi
+     */
+    unsigned int size() const
+    {
+        return _size;
+    };
+
+    /**
+     * @brief Numero di righe: il nome più grande mai aggiunto + 1
+     */
+    unsigned int slots() const
+    {
+        return _matrix.size();
+    };
+
+    /**
+     * @brief Getter degli archi, indicizzati per nome
+     */
+    const storage_type &adjacency() const
+    {
+        return _matrix;
+    };
+
+    /**
+     * @brief Getter dell'allocatore
+     */
+    allocator_type get_allocator() const
+    {
+        return allocator_type(_matrix.get_allocator());
+    };
+
+    /**
+     * @brief Alloca spazio per i nomi da 0 a count - 1
+     *
+     * @param count Numero di righe da poter contenere
+     */
+    void reserve(unsigned int count)
+    {
+        _alive.reserve(dense_bitset::wordsFor(count));
+        _matrix.reserve(count);
+    };
+
+    /**
+     * @brief true se esiste il nodo id
+     */
+    bool exists(Id id) const
+    {
+        return isAlive(traits::toIndex(id));
+    };
+
+    /**
+     * @brief Aggiunge il nodo id
+     *
+     * Lancia un errore se esiste già. Se id supera le righe attuali la
+     * matrice cresce fino a id + 1 righe (almeno raddoppiando la capacità).
+     * In caso di eccezione il graph resta invariato.
+     *
+     * @param id Nome del nodo
+     */
+    void addNode(Id id)
+    {
+        unsigned int index = checkedIndex(id);
+        if (isAlive(index))
+        {
+            throw 1;
+        }
+        if (index >= _matrix.size())
+        {
+            // Le parole in più restano a zero anche se la matrice non cresce
+            if (dense_bitset::wordsFor(index + 1) > _alive.size())
+            {
+                _alive.resize(dense_bitset::wordsFor(index + 1), 0);
+            }
+            _matrix.resize(index + 1);
+        }
+        _alive[index / dense_bitset::bitsPerWord] |= word_type(1) << (index % dense_bitset::bitsPerWord);
+        _size++;
+    };
+
+    /**
+     * @brief Rimuove il nodo id con i suoi archi
+     *
+     * La riga resta e viene riusata se id viene aggiunto di nuovo. Lancia un
+     * errore se il nodo non esiste.
+     *
+     * @param id Nome del nodo
+     */
+    void removeNode(Id id)
+    {
+        unsigned int index = existingIndex(id);
+        _matrix.clear(index);
+        _alive[index / dense_bitset::bitsPerWord] &= ~(word_type(1) << (index % dense_bitset::bitsPerWord));
+        _size--;
+    };
+
+    /**
+     * @brief Aggiunge l'arco origin -> destination
+     *
+     * Lancia un errore se uno dei nodi non esiste
+     */
+    void addEdge(Id origin, Id destination)
+    {
+        unsigned int i = existingIndex(origin);
+        _matrix.set(i, existingIndex(destination));
+    };
+
+    /**
+     * @brief Rimuove l'arco origin -> destination
+     *
+     * Lancia un errore se uno dei nodi non esiste
+     */
+    void removeEdge(Id origin, Id destination)
+    {
+        unsigned int i = existingIndex(origin);
+        _matrix.reset(i, existingIndex(destination));
+    };
+
+    /**
+     * @brief true se esiste l'arco origin -> destination
+     *
+     * Lancia un errore se uno dei nodi non esiste
+     */
+    bool hasEdge(Id origin, Id destination) const
+    {
+        unsigned int i = existingIndex(origin);
+        return _matrix.test(i, existingIndex(destination));
+    };
+
+    /**
+     * @brief Successori del nodo id, come indici (vedi node_id_traits::fromIndex)
+     */
+    successor_range successors(Id id) const
+    {
+        return _matrix.successors(existingIndex(id));
+    };
+
+    /**
+     * @brief Predecessori del nodo id, come indici
+     */
+    predecessor_range predecessors(Id id) const
+    {
+        return _matrix.predecessors(existingIndex(id));
+    };
+
+    /**
+     * @brief Tutti gli archi, come coppie di indici
+     */
+    edge_range edges() const
+    {
+        return edge_range(edge_iterator<storage_type>(&_matrix, 0),
+                          edge_iterator<storage_type>(&_matrix, _matrix.size()));
+    };
+
+    /**
+     * @brief Numero di successori del nodo id
+     */
+    unsigned int outDegree(Id id) const
+    {
+        return _matrix.outDegree(existingIndex(id));
+    };
+
+    /**
+     * @brief Numero di predecessori del nodo id
+     */
+    unsigned int inDegree(Id id) const
+    {
+        return _matrix.inDegree(existingIndex(id));
+    };
+
+    /**
+     * @brief Chiama f(Id) per ogni nodo, in ordine crescente
+     */
+    template <typename F>
+    void forEachNode(F f) const
+    {
+        for (size_t w = 0; w < _alive.size(); w++)
+        {
+            for (word_type bits = _alive[w]; bits != 0; bits &= bits - 1)
+            {
+                f(traits::fromIndex(static_cast<unsigned int>(w * dense_bitset::bitsPerWord +
+                                                              dense_bitset::countTrailingZeros(bits))));
+            }
+        }
+    };
+
+    /**
+     * @brief Chiama f(Id) per ogni successore del nodo id
+     */
+    template <typename F>
+    void forEachSuccessor(Id id, F f) const
+    {
+        _matrix.forEachSuccessor(existingIndex(id), [&f](unsigned int j) { f(traits::fromIndex(j)); });
+    };
+
+private:
+    /**
+     * @brief true se la riga index contiene un nodo
+     */
+    bool isAlive(unsigned int index) const
+    {
+        return index < _matrix.size() &&
+               ((_alive[index / dense_bitset::bitsPerWord] >> (index % dense_bitset::bitsPerWord)) & 1) != 0;
+    };
+
+    /**
+     * @brief Indice di id, lancia un errore se il nodo non esiste
+     */
+    unsigned int existingIndex(Id id) const
+    {
+        unsigned int index = traits::toIndex(id);
+        if (!isAlive(index))
+        {
+            throw 1;
+        }
+        return index;
+    };
+
+    /**
+     * @brief Indice di id, lancia un errore se non può essere una riga
+     */
+    static unsigned int checkedIndex(Id id)
+    {
+        unsigned int index = traits::toIndex(id);
+        // Un nome negativo o troppo grande diventa invalidIndex, e righe
+        // oltre 2^31 non starebbero comunque in memoria
+        if (index >= 0x80000000u)
+        {
+            throw 1;
+        }
+        return index;
+    };
+};
+
+/**
+ * @brief Scambia due id_graph
+ */
+template <typename Id, typename Storage, typename Allocator>
+void swap(id_graph<Id, Storage, Allocator> &first, id_graph<Id, Storage, Allocator> &second) noexcept
+{
+    first.swap(second);
+}
+
+/**
+ * @brief Sceglie id_graph se i nomi possono fare da indice, graph altrimenti
+ *
+ * Da usare solo con nomi densi: con id_graph la matrice ha tante righe quanto
+ * il nome più grande.
+ */
+template <typename T, typename Storage = dense_bitset>
+struct select_graph
+{
+    typedef typename std::conditional<node_id_traits<T>::direct, id_graph<T, Storage>,
+                                      graph<T, Storage, std::hash<T>, std::equal_to<T>, std::allocator<T> > >::type
+        type;
+};
+
+#endif
@@ -1,5 +1,21 @@
 #include <iostream>
 #include "graph.h"
+#include "graph_traversal.h"
+#include "reachability_index.h"
+#include "graph_algorithms.h"
+#include "mapped_graph.h"
+#include "edge_list_loader.h"
+#include "arena_allocator.h"
+#include "concurrent_graph.h"
+#include "versioned_graph.h"
+#include "graph_journal.h"
+#include "id_graph.h"
+#include "static_graph.h"
+#include "shortest_paths.h"
+#include <sstream>
+#include <cstdio> // std::remove
+#include <atomic>
+#include <thread>
 
 /**
 * @brief Funzione di test per l'iteratore
@@ -36,6 +52,32 @@ struct obj_test
     }
 };
 
+/**
+* @brief Funtore di hash per obj_test
+* 
+* Funtore di hash usato dall'indice dei nomi di graph<obj_test>
+*/
+struct obj_test_hash
+{
+    size_t operator()(const obj_test &obj) const
+    {
+        return std::hash<int>()(obj.i) ^ (std::hash<double>()(obj.d) << 1);
+    }
+};
+
+/**
+* @brief Funtore di uguaglianza per obj_test
+* 
+* Funtore di uguaglianza usato dall'indice dei nomi di graph<obj_test>
+*/
+struct obj_test_equal
+{
+    bool operator()(const obj_test &obj1, const obj_test &obj2) const
+    {
+        return obj1.i == obj2.i && obj1.d == obj2.d;
+    }
+};
+
 int main()
 {
     int *valori = new int[3];
@@ -54,7 +96,7 @@ int main()
     obj_test obj2 = {170, 70};
     obj_test obj3 = {180, 80};
     obj_test objs[3] = {obj1, obj2, obj3};
-    graph<obj_test> tgr(3, objs);
+    graph<obj_test, dense_bitset, obj_test_hash, obj_test_equal> tgr(3, objs);
     graph<int> gr2 = gr;
 
     std::cout << "Creato graph" << std::endl;
@@ -159,6 +201,379 @@ int main()
     test_iterator(gr);
     test_iterator(cgr);
 
+    std::cout << "Archi del graph:";
+    graph<int>::edge_range archi = gr.edges();
+    for (graph<int>::edge_range::iterator it = archi.begin(); it != archi.end(); ++it)
+    {
+        std::cout << " " << gr.nodeFromIndex((*it).first) << "->" << gr.nodeFromIndex((*it).second);
+    }
+    std::cout << std::endl;
+    std::cout << "Predecessori di '8':";
+    graph<int>::predecessor_range pred = gr.predecessors(8);
+    for (graph<int>::predecessor_range::iterator it = pred.begin(); it != pred.end(); ++it)
+    {
+        std::cout << " " << gr.nodeFromIndex(*it);
+    }
+    std::cout << std::endl
+              << std::endl;
+
+    std::cout << "'7' archi uscenti: " << gr.outDegree(7) << " entranti: " << gr.inDegree(7) << std::endl;
+    std::cout << "Successori comuni di '7' e '8':";
+    std::vector<unsigned int> comuni = gr.commonSuccessors(7, 8);
+    for (size_t k = 0; k < comuni.size(); k++)
+    {
+        std::cout << " " << gr.nodeFromIndex(comuni[k]);
+    }
+    std::cout << std::endl;
+    graph<int> altri;
+    altri.addNode(6);
+    altri.addNode(8);
+    altri.addNode(7);
+    altri.addEdge(8, 7);
+    altri.addEdge(6, 8);
+    graph<int> unione = gr | altri;
+    std::cout << "Unione con un graph con gli stessi nodi" << std::endl;
+    std::cout << unione << std::endl;
+
+    std::cout << "Graph inverso" << std::endl;
+    std::cout << gr.transpose() << std::endl;
+
+    frozen_graph<int> fgr = gr.freeze();
+    std::cout << "Fotografia CSR, archi: " << fgr.edges() << std::endl;
+    for (unsigned int i = 0; i < fgr.size(); i++)
+    {
+        std::cout << fgr.nodeFromIndex(i).name << " successori: " << fgr.outDegree(i)
+                  << " predecessori: " << fgr.inDegree(i) << std::endl;
+    }
+    std::cout << std::endl;
+
+    thread_pool pool(2);
+    std::vector<int> distanze = bfs(gr, 8, &pool);
+    std::cout << "Distanze da '8':";
+    for (unsigned int i = 0; i < gr.slots(); i++)
+    {
+        std::cout << " " << gr.nodeFromIndex(i) << "=" << distanze[i];
+    }
+    std::cout << std::endl;
+    std::cout << "'7' raggiunge '8': " << isReachable(gr, 7, 8, &pool) << std::endl;
+    std::cout << "'8' raggiunge '7': " << isReachable(gr, 8, 7) << std::endl
+              << std::endl;
+
+    reachability_index<int> rgr(gr);
+    std::cout << "Indice di raggiungibilita', '6' raggiunge '8': " << rgr.isReachable(6, 8) << std::endl;
+    rgr.addEdge(6, 7);
+    std::cout << "Aggiunto arco 6->7, '6' raggiunge '8': " << rgr.isReachable(6, 8) << std::endl;
+    rgr.removeEdge(7, 8);
+    std::cout << "Rimosso arco 7->8, '6' raggiunge '8': " << rgr.isReachable(6, 8) << std::endl
+              << std::endl;
+
+    scc_result componenti = stronglyConnectedComponents(gr);
+    std::cout << "Componenti fortemente connesse: " << componenti.count << std::endl;
+    std::vector<unsigned int> ordine, ciclo;
+    if (topologicalSort(gr, ordine, &ciclo))
+    {
+        std::cout << "Ordinamento topologico:";
+        for (size_t k = 0; k < ordine.size(); k++)
+        {
+            std::cout << " " << gr.nodeFromIndex(ordine[k]);
+        }
+    }
+    else
+    {
+        std::cout << "Ciclo trovato:";
+        for (size_t k = 0; k < ciclo.size(); k++)
+        {
+            std::cout << " " << gr.nodeFromIndex(ciclo[k]);
+        }
+    }
+    std::cout << std::endl
+              << std::endl;
+
+    saveGraph(gr, "graph.bin");
+    {
+        mapped_graph<int> mgr("graph.bin");
+        std::cout << "Letto da file mappato, nodi: " << mgr.size() << " archi: " << mgr.edges()
+                  << " checksum corretti: " << mgr.verify() << std::endl;
+        std::cout << "Esiste arco tra '7' e '8'? " << mgr.hasEdge(7, 8) << std::endl
+                  << std::endl;
+    }
+    std::remove("graph.bin");
+
+    graph<int> lgr;
+    std::istringstream lista("1 2\n2 3\n3 1\n3 4\n");
+    loadEdgeList(lgr, lista, &pool);
+    std::cout << "Caricato da lista di archi, nodi: " << lgr.size() << std::endl;
+    std::cout << "Esiste arco tra '3' e '4'? " << lgr.hasEdge(3, 4) << std::endl
+              << std::endl;
+
+    int nuovi[] = {5, 6, 7};
+    lgr.addNodes(nuovi, nuovi + 3);
+    std::vector<std::pair<int, int> > blocco;
+    blocco.push_back(std::make_pair(4, 5));
+    blocco.push_back(std::make_pair(5, 6));
+    blocco.push_back(std::make_pair(6, 7));
+    lgr.addEdges(blocco.begin(), blocco.end());
+    std::cout << "Aggiunti nodi e archi in blocco, nodi: " << lgr.size() << std::endl;
+    lgr.removeEdges(blocco.begin(), blocco.begin() + 2);
+    std::cout << "Rimossi due archi in blocco, esiste arco tra '6' e '7'? " << lgr.hasEdge(6, 7) << std::endl
+              << std::endl;
+
+    graph<int> spostato(std::move(lgr));
+    spostato.emplaceNode(8);
+    std::cout << "Graph spostato, nodi: " << spostato.size() << " (l'originale ne ha " << lgr.size() << ")"
+              << std::endl
+              << std::endl;
+
+    {
+        arena regione;
+        graph<int, sparse_adjacency, std::hash<int>, std::equal_to<int>, arena_allocator<int> > agr(
+            (arena_allocator<int>(regione)));
+        for (int i = 0; i < 10; i++)
+        {
+            agr.addNode(i);
+        }
+        for (int i = 0; i + 1 < 10; i++)
+        {
+            agr.addEdge(i, i + 1);
+        }
+        std::cout << "Graph nell'arena, nodi: " << agr.size() << ", byte usati: " << regione.used()
+                  << std::endl
+                  << std::endl;
+    }
+
+    {
+        // Uno scrittore aggiunge e toglie nodi mentre quattro lettori
+        // controllano che l'arco fisso 0 -> 1 sia sempre visibile e altri due
+        // scorrono nodi e successori: ogni nome letto deve essere uno di
+        // quelli scritti e i nodi 0 e 1, mai rimossi, devono esistere sempre.
+        // Le rimozioni azzerano le colonne e, a capacità esaurita, lo
+        // scrittore ricostruisce la versione e ritira la vecchia
+        concurrent_graph<int> cogr;
+        cogr.addNode(0);
+        cogr.addNode(1);
+        cogr.addEdge(0, 1);
+        std::atomic<bool> fine(false);
+        std::atomic<int> errori(0);
+        std::vector<std::thread> lettori;
+        for (int t = 0; t < 4; t++)
+        {
+            lettori.push_back(std::thread([&cogr, &fine, &errori] {
+                while (!fine.load())
+                {
+                    concurrent_graph<int>::reader lettore(cogr);
+                    if (!lettore.exists(0) || !lettore.hasEdge(0, 1))
+                    {
+                        errori++;
+                    }
+                }
+            }));
+        }
+        for (int t = 0; t < 2; t++)
+        {
+            lettori.push_back(std::thread([&cogr, &fine, &errori] {
+                while (!fine.load())
+                {
+                    concurrent_graph<int>::reader lettore(cogr);
+                    std::vector<int> nodi;
+                    lettore.forEachNode([&nodi](int nome) { nodi.push_back(nome); });
+                    bool uno = false;
+                    for (size_t k = 0; k < nodi.size(); k++)
+                    {
+                        if (nodi[k] < 0 || nodi[k] >= 102)
+                        {
+                            errori++;
+                            continue;
+                        }
+                        try
+                        {
+                            lettore.forEachSuccessor(nodi[k], [&](int successore) {
+                                if (successore < 0 || successore >= 102 ||
+                                    (successore < 2 && !lettore.exists(successore)))
+                                {
+                                    errori++;
+                                }
+                                uno = uno || (nodi[k] == 0 && successore == 1);
+                            });
+                        }
+                        catch (int)
+                        {
+                            // Solo un nodo dello scrittore può sparire nel frattempo
+                            if (nodi[k] < 2)
+                            {
+                                errori++;
+                            }
+                        }
+                    }
+                    if (!uno)
+                    {
+                        errori++;
+                    }
+                }
+            }));
+        }
+        for (int i = 0; i < 2000; i++)
+        {
+            int nome = 2 + i % 100;
+            if (cogr.exists(nome))
+            {
+                cogr.removeNode(nome);
+            }
+            else
+            {
+                cogr.addNode(nome);
+                cogr.addEdge(0, nome);
+                cogr.addEdge(nome, 1);
+            }
+        }
+        fine = true;
+        for (size_t t = 0; t < lettori.size(); t++)
+        {
+            lettori[t].join();
+        }
+        std::cout << "Graph concorrente, nodi: " << cogr.size() << ", letture errate: " << errori.load()
+                  << std::endl
+                  << std::endl;
+        if (errori.load() != 0)
+        {
+            return 1;
+        }
+    }
+
+    {
+        versioned_graph<int> vgr;
+        for (int i = 0; i < 1000; i++)
+        {
+            vgr.addNode(i);
+        }
+        vgr.addEdge(1, 2);
+        versioned_graph<int> fotografia = vgr.snapshot();
+        vgr.addEdge(2, 3);
+        vgr.removeNode(1);
+        std::cout << "Fotografia: 1 -> 2 " << fotografia.hasEdge(1, 2) << ", 2 -> 3 " << fotografia.hasEdge(2, 3)
+                  << "; graph: 1 esiste " << vgr.exists(1) << ", blocchi ancora condivisi "
+                  << vgr.sharedMatrixBlocks() << std::endl
+                  << std::endl;
+    }
+
+    {
+        graph<int> origine;
+        graph_journal<int> registro;
+        origine.setJournal(&registro);
+        graph<int> replica;
+        uint64_t visto = replica.applyJournal(registro, registro.firstSequence());
+        for (int i = 0; i < 10; i++)
+        {
+            origine.addNode(i);
+        }
+        origine.addEdge(1, 2);
+        origine.addEdge(2, 3);
+        origine.removeNode(1);
+        visto = replica.applyJournal(registro, visto);
+        std::cout << "Replica dal journal: nodi " << replica.size() << ", 2 -> 3 " << replica.hasEdge(2, 3)
+                  << ", modifiche lette " << visto << std::endl
+                  << std::endl;
+        origine.setJournal(nullptr);
+    }
+
+    {
+        // I nomi di gr (6, 7, 8) fanno già da indice: nessun indice hash
+        id_graph<int> igr(gr);
+        igr.addNode(2);
+        igr.addEdge(2, 8);
+        static_graph<16> sgr;
+        sgr.addNode(1);
+        sgr.addNode(15);
+        sgr.addEdge(1, 15);
+        std::cout << "id_graph: nodi " << igr.size() << ", righe " << igr.slots() << ", 2 -> 8 "
+                  << igr.hasEdge(2, 8) << "; static_graph: 1 -> 15 " << sgr.hasEdge(1, 15) << ", byte "
+                  << sizeof(sgr) << std::endl
+                  << std::endl;
+    }
+
+    {
+        // Pesi e etichette in colonne separate dai nomi
+        graph<int> pesato(gr);
+        column_handle<double> peso = pesato.addColumn<double>();
+        column_handle<std::string> etichetta = pesato.addColumn<std::string>();
+        for (graph<int>::const_iterator it = pesato.begin(); it != pesato.end(); ++it)
+        {
+            pesato.payload(peso, it->name) = it->name * 1.5;
+        }
+        pesato.payload(etichetta, 8) = "otto";
+        const double *pesi = pesato.columnData(peso);
+        double totale = 0;
+        for (unsigned int i = 0; i < pesato.slots(); i++)
+        {
+            totale += pesi[i];
+        }
+        std::cout << "Colonne: peso totale " << totale << ", etichetta di 8 " << pesato.payload(etichetta, 8)
+                  << ", byte per nodo " << sizeof(graph<int>::node) << std::endl
+                  << std::endl;
+    }
+
+    {
+        // Archi con pesi e cammini minimi
+        graph<char, sparse_weights<int> > strade;
+        for (char c = 'a'; c <= 'e'; c++)
+        {
+            strade.addNode(c);
+        }
+        strade.addEdge('a', 'b', 4);
+        strade.addEdge('a', 'c', 1);
+        strade.addEdge('c', 'b', 2);
+        strade.addEdge('b', 'd', 5);
+        strade.addEdge('c', 'd', 8);
+        strade.addEdge('d', 'e', 3);
+        path_result<int> minimi = dijkstra(strade, 'a');
+        std::vector<unsigned int> percorso = minimi.pathTo(strade.indexOf('e'));
+        std::cout << "Dijkstra da 'a' a 'e': distanza " << minimi.distance[strade.indexOf('e')] << ", percorso";
+        for (unsigned int i = 0; i < percorso.size(); i++)
+        {
+            std::cout << " " << strade.nodeFromIndex(percorso[i]).name;
+        }
+        std::cout << std::endl;
+
+        graph<char, dense_weights<int> > debiti(strade);
+        debiti.addEdge('e', 'c', -20);
+        path_result<int> negativi;
+        std::vector<unsigned int> ciclo;
+        bool valido = bellmanFord(debiti, 'a', negativi, &ciclo);
+        std::cout << "Bellman-Ford con l'arco e -> c di peso " << debiti.weight('e', 'c') << ": "
+                  << (valido ? "nessun ciclo negativo" : "ciclo negativo") << ",";
+        for (unsigned int i = 0; i < ciclo.size(); i++)
+        {
+            std::cout << " " << debiti.nodeFromIndex(ciclo[i]).name;
+        }
+        std::cout << std::endl;
+
+        all_pairs_result<int> tutte = floydWarshall(strade, &pool);
+        std::cout << "Floyd-Warshall: b -> e " << tutte.at(strade.indexOf('b'), strade.indexOf('e')) << ", e -> a "
+                  << (tutte.at(strade.indexOf('e'), strade.indexOf('a')) == distance_traits<int>::infinity()
+                          ? "irraggiungibile"
+                          : "raggiungibile")
+                  << std::endl
+                  << std::endl;
+    }
+
+    graph<char, sparse_adjacency> scgr(cgr);
+    scgr.addEdge('b', 'c');
+    scgr.removeEdge('a', 'f');
+    std::cout << "Creato graph sparso per conversione" << std::endl;
+    std::cout << scgr << std::endl;
+    graph<int> iscgr(scgr);
+    std::cout << "Creato graph denso di int dal graph sparso" << std::endl;
+    std::cout << iscgr << std::endl;
+
+    cgr.setCompactionThreshold(0.5);
+    cgr.removeNode('b');
+    cgr.removeNode('d');
+    std::cout << "Rimossi due nodi senza compattare, size: " << cgr.size()
+              << " posizioni: " << cgr.slots() << std::endl;
+    test_iterator(cgr);
+    cgr.compact();
+    std::cout << "Compattato, size: " << cgr.size() << " posizioni: " << cgr.slots() << std::endl;
+    std::cout << cgr << std::endl;
+
     delete[] valori;
     valori = nullptr;
 
@@ -0,0 +1,536 @@
+#ifndef MAPPED_GRAPH_H
+#define MAPPED_GRAPH_H
+
+#include <cassert>
+#include <cstdio>  // std::rename, std::remove
+#include <cstring> // std::memcpy, std::memcmp, std::memset
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>   // std::lower_bound
+#include <functional>  // std::hash, std::equal_to
+#include <type_traits> // std::is_trivially_copyable
+#include <stddef.h>    // size_t
+#include <stdint.h>    // uint32_t, uint64_t
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+#include "graph.h"
+
+/**
+ * @file mapped_graph.h
+ * @brief Formato binario su file di graph e lettura tramite mmap
+ *
+ * Il file contiene, dopo un'intestazione, quattro sezioni allineate a 64
+ * byte:
+ * - nomi: i nomi dei nodi, copiati byte per byte (T deve essere
+ *   trivially copyable);
+ * - offset: N + 1 interi da 64 bit, inizio dei successori di ogni nodo;
+ * - destinazioni: E interi da 32 bit, successori di ogni nodo in ordine
+ *   crescente (formato CSR, come frozen_graph);
+ * - indice: i bucket di un node_index costruito sui nomi.
+ *
+ * Ogni sezione ha un checksum nell'intestazione, che ha a sua volta il
+ * proprio. I nodi rimossi del graph non vengono scritti e gli indici sono
+ * contigui da 0 a N - 1. I numeri sono scritti nell'ordine dei byte della
+ * macchina, che viene controllato alla lettura.
+ */
+
+/**
+ * @brief Intestazione del file binario di un graph
+ */
+struct graph_file_header
+{
+    static const uint32_t currentVersion = 1;  ///< Versione scritta da saveGraph
+    static const uint32_t byteOrderMark = 0x01020304u; ///< Rileva un ordine dei byte diverso
+
+    char magic[8];           ///< "OGRAPH" seguito da due zeri
+    uint32_t version;        ///< Versione del formato
+    uint32_t byteOrder;      ///< byteOrderMark nell'ordine dei byte di chi ha scritto
+    uint32_t nameSize;       ///< sizeof(T)
+    uint32_t bucketCount;    ///< Numero di bucket dell'indice
+    uint64_t nodes;          ///< Numero di nodi
+    uint64_t edges;          ///< Numero di archi
+    uint64_t hashCheck;      ///< Hash del primo nome, per riconoscere un funtore di hash diverso
+    uint64_t sectionOffset[4];   ///< Posizione nel file di nomi, offset, destinazioni e indice
+    uint64_t sectionSize[4];     ///< Lunghezza in byte di ogni sezione
+    uint64_t sectionChecksum[4]; ///< Checksum di ogni sezione
+    uint64_t headerChecksum;     ///< Checksum dei campi precedenti
+
+    enum section
+    {
+        names = 0,
+        offsets = 1,
+        targets = 2,
+        buckets = 3
+    };
+
+    /**
+     * @brief Checksum di una sequenza di byte
+     *
+     * Mescola 8 byte alla volta con la moltiplicazione di FNV-1a
+     */
+    static uint64_t checksum(const void *data, size_t length)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        uint64_t h = 0xcbf29ce484222325ULL;
+        size_t k = 0;
+        for (; k + 8 <= length; k += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + k, 8);
+            h = (h ^ word) * 0x100000001b3ULL;
+            h ^= h >> 29;
+        }
+        for (; k < length; k++)
+        {
+            h = (h ^ bytes[k]) * 0x100000001b3ULL;
+        }
+        return h;
+    };
+
+    /**
+     * @brief Checksum dell'intestazione, escluso il campo headerChecksum
+     */
+    uint64_t computeHeaderChecksum() const
+    {
+        return checksum(this, offsetof(graph_file_header, headerChecksum));
+    };
+};
+
+/**
+ * @brief Scrive un graph nel formato binario
+ *
+ * Costruisce in memoria le sezioni (O(N + E)) e le scrive con un solo
+ * passaggio in path + ".tmp", che poi rinomina sopra path: chi apre il file
+ * vede la versione precedente o quella nuova, mai una scritta a metà. Lancia
+ * un errore se il file non può essere scritto.
+ *
+ * @param gr graph da scrivere
+ * @param path Percorso del file
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+void saveGraph(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const char *path)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "saveGraph richiede nomi trivially copyable");
+    typedef graph_file_header header_type;
+    struct node
+    {
+        T name;
+    };
+
+    // Nomi e nuova posizione di ogni nodo vivo. La tabella è azzerata prima
+    // di copiare i nomi, così nel file non finiscono byte di padding casuali
+    const unsigned int n = gr.size();
+    std::vector<unsigned int> remap(gr.slots());
+    std::vector<node> names(n);
+    if (n > 0)
+    {
+        std::memset(static_cast<void *>(names.data()), 0, n * sizeof(node));
+    }
+    for (unsigned int i = 0, k = 0; i < gr.slots(); i++)
+    {
+        if (gr.isAlive(i))
+        {
+            remap[i] = k;
+            names[k++].name = gr.nodeFromIndex(i).name;
+        }
+    }
+
+    std::vector<uint64_t> offsets;
+    std::vector<unsigned int> targets;
+    offsets.reserve(n + 1);
+    offsets.push_back(0);
+    for (unsigned int i = 0; i < gr.slots(); i++)
+    {
+        if (gr.isAlive(i))
+        {
+            gr.adjacency().forEachSuccessor(i, [&](unsigned int j) { targets.push_back(remap[j]); });
+            offsets.push_back(targets.size());
+        }
+    }
+
+    node_index<T, Hash, KeyEqual> index(gr.hashFunction(), gr.keyEqual());
+    index.reserve(n, names.data());
+    for (unsigned int i = 0; i < n; i++)
+    {
+        index.insert(names[i].name, i, names.data());
+    }
+
+    header_type header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "OGRAPH\0\0", 8);
+    header.version = header_type::currentVersion;
+    header.byteOrder = header_type::byteOrderMark;
+    header.nameSize = sizeof(T);
+    header.bucketCount = index.capacity();
+    header.nodes = n;
+    header.edges = targets.size();
+    header.hashCheck = n == 0 ? 0 : static_cast<uint64_t>(gr.hashFunction()(names[0].name));
+
+    const void *data[4] = {names.data(), offsets.data(), targets.data(), index.buckets()};
+    header.sectionSize[header_type::names] = static_cast<uint64_t>(n) * sizeof(node);
+    header.sectionSize[header_type::offsets] = offsets.size() * sizeof(uint64_t);
+    header.sectionSize[header_type::targets] = targets.size() * sizeof(unsigned int);
+    header.sectionSize[header_type::buckets] = static_cast<uint64_t>(index.capacity()) * sizeof(unsigned int);
+    uint64_t position = sizeof(header_type);
+    for (int s = 0; s < 4; s++)
+    {
+        position = (position + 63) & ~uint64_t(63);
+        header.sectionOffset[s] = position;
+        header.sectionChecksum[s] = header_type::checksum(data[s], header.sectionSize[s]);
+        position += header.sectionSize[s];
+    }
+    header.headerChecksum = header.computeHeaderChecksum();
+
+    const std::string temporary = std::string(path) + ".tmp";
+    std::ofstream out(temporary.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    position = sizeof(header_type);
+    const char padding[64] = {0};
+    for (int s = 0; s < 4; s++)
+    {
+        out.write(padding, header.sectionOffset[s] - position);
+        out.write(static_cast<const char *>(data[s]), header.sectionSize[s]);
+        position = header.sectionOffset[s] + header.sectionSize[s];
+    }
+    out.flush();
+    out.close();
+    if (!out || std::rename(temporary.c_str(), path) != 0)
+    {
+        std::remove(temporary.c_str());
+        throw 1;
+    }
+}
+
+/**
+ * @brief graph in sola lettura servito da un file mappato in memoria
+ *
+ * Il costruttore mappa il file scritto da saveGraph, controlla
+ * l'intestazione e scorre una volta offset, destinazioni e indice, così un
+ * file corrotto lancia un errore invece di far leggere fuori dalla
+ * mappatura: i dati non vengono copiati né deserializzati, quindi
+ * l'apertura costa O(N + E) letture sequenziali e ogni interrogazione
+ * legge direttamente le pagine del file. verify() controlla anche i
+ * checksum delle sezioni, leggendo tutto il file.
+ *
+ * Offre la stessa interfaccia di sola lettura di frozen_graph per i
+ * successori. Più thread possono interrogarlo contemporaneamente. Non è
+ * copiabile: il file resta mappato fino alla distruzione.
+ *
+ * @tparam T Tipo del nome dei nodi, trivially copyable
+ * @tparam Hash Funtore di hash su T, lo stesso usato per scrivere il file
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ */
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T> >
+class mapped_graph
+{
+    static_assert(std::is_trivially_copyable<T>::value, "mapped_graph richiede nomi trivially copyable");
+    typedef graph_file_header header_type;
+
+public:
+    struct node
+    {
+        T name;
+    };
+
+    typedef iterator_range<const unsigned int *> index_range; ///< Intervallo nell'array delle destinazioni
+
+private:
+    void *_base;                  ///< Inizio della mappatura
+    size_t _length;               ///< Lunghezza della mappatura
+    const header_type *_header;   ///< Intestazione
+    const node *_nodes;           ///< Nomi dei nodi
+    const uint64_t *_offsets;     ///< Inizio dei successori di ogni nodo (N + 1)
+    const unsigned int *_targets; ///< Successori, concatenati
+    const unsigned int *_buckets; ///< Bucket dell'indice dei nomi
+    Hash _hash;                   ///< Funtore di hash
+    KeyEqual _equal;              ///< Funtore di uguaglianza
+
+public:
+    /**
+     * @brief Costruttore
+     *
+     * Mappa il file e controlla intestazione, versione, ordine dei byte,
+     * dimensione dei nomi, funtore di hash, che le sezioni stiano nel file
+     * e che offset, destinazioni e bucket siano coerenti (vedi
+     * checkSections). Lancia un errore se un controllo fallisce.
+     *
+     * @param path Percorso del file scritto da saveGraph
+     * @param hash Funtore di hash usato per scrivere il file
+     * @param equal Funtore di uguaglianza
+     */
+    explicit mapped_graph(const char *path, const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual())
+        : _base(MAP_FAILED), _length(0), _header(nullptr), _nodes(nullptr), _offsets(nullptr), _targets(nullptr),
+          _buckets(nullptr), _hash(hash), _equal(equal)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd == -1)
+        {
+            throw 1;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(header_type))
+        {
+            ::close(fd);
+            throw 1;
+        }
+        _length = static_cast<size_t>(info.st_size);
+        _base = ::mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, fd, 0);
+        // La mappatura resta valida anche dopo la chiusura del descrittore
+        ::close(fd);
+        if (_base == MAP_FAILED)
+        {
+            throw 1;
+        }
+
+        try
+        {
+            attach();
+        }
+        catch (...)
+        {
+            ::munmap(_base, _length);
+            throw;
+        }
+    };
+
+    /**
+     * @brief Distruttore della classe
+     *
+     * Toglie la mappatura del file
+     */
+    ~mapped_graph()
+    {
+        ::munmap(_base, _length);
+        _base = MAP_FAILED;
+        _length = 0;
+    };
+
+    /**
+     * @brief Controlla i checksum di tutte le sezioni
+     *
+     * Legge l'intero file, quindi costa quanto caricarlo
+     *
+     * @return true se nessuna sezione è corrotta
+     */
+    bool verify() const
+    {
+        for (int s = 0; s < 4; s++)
+        {
+            const char *data = static_cast<const char *>(_base) + _header->sectionOffset[s];
+            if (header_type::checksum(data, _header->sectionSize[s]) != _header->sectionChecksum[s])
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    /**
+     * @brief Getter del numero di nodi
+     */
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(_header->nodes);
+    };
+
+    /**
+     * @brief Getter del numero di archi
+     */
+    size_t edges() const
+    {
+        return static_cast<size_t>(_header->edges);
+    };
+
+    /**
+     * @brief Getter del nodo index-esimo
+     *
+     * @pre index < size()
+     */
+    const node &nodeFromIndex(unsigned int index) const
+    {
+        assert(index < size());
+
+        return _nodes[index];
+    };
+
+    /**
+     * @brief Posizione di un nodo dato il nome
+     *
+     * Ricerca nell'indice hash salvato nel file
+     *
+     * @return Indice del nodo, -1 se non esiste
+     */
+    int indexOf(const T &nodeName) const
+    {
+        return node_index<T, Hash, KeyEqual>::findIn(_buckets, _header->bucketCount, nodeName, _nodes, _hash,
+                                                     _equal);
+    };
+
+    /**
+     * @brief Verifica l'esistenza di un nodo
+     */
+    bool exists(const T &nodeName) const
+    {
+        return indexOf(nodeName) != -1;
+    };
+
+    /**
+     * @brief Verifica l'esistenza di un arco tra due nodi
+     *
+     * Lancia un errore se uno dei due nodi non esiste, come graph::hasEdge
+     *
+     * @param origin_node Nome del nodo di origine
+     * @param destination_node Nome del nodo di destinazione
+     *
+     * @return bool per l'esistenza dell'arco
+     */
+    bool hasEdge(const T &origin_node, const T &destination_node) const
+    {
+        int origin_index = indexOf(origin_node);
+        int destination_index = indexOf(destination_node);
+        if (origin_index == -1 || destination_index == -1)
+        {
+            throw 1;
+        }
+        return hasEdgeAt(origin_index, destination_index);
+    };
+
+    /**
+     * @brief Verifica l'esistenza di un arco tra due indici
+     *
+     * Ricerca binaria tra i successori di origin
+     *
+     * @pre origin < size() && destination < size()
+     */
+    bool hasEdgeAt(unsigned int origin, unsigned int destination) const
+    {
+        index_range out = successors(origin);
+        const unsigned int *it = std::lower_bound(out.begin(), out.end(), destination);
+        return it != out.end() && *it == destination;
+    };
+
+    /**
+     * @brief Successori del nodo index-esimo, in ordine crescente
+     *
+     * @pre index < size()
+     */
+    index_range successors(unsigned int index) const
+    {
+        assert(index < size());
+
+        return index_range(_targets + _offsets[index], _targets + _offsets[index + 1]);
+    };
+
+    /**
+     * @brief Numero di archi uscenti dal nodo index-esimo
+     */
+    size_t outDegree(unsigned int index) const
+    {
+        return static_cast<size_t>(_offsets[index + 1] - _offsets[index]);
+    };
+
+private:
+    mapped_graph(const mapped_graph &);
+    mapped_graph &operator=(const mapped_graph &);
+
+    /**
+     * @brief Controlla l'intestazione e ricava i puntatori alle sezioni
+     */
+    void attach()
+    {
+        const char *base = static_cast<const char *>(_base);
+        _header = reinterpret_cast<const header_type *>(base);
+        if (std::memcmp(_header->magic, "OGRAPH\0\0", 8) != 0 || _header->version != header_type::currentVersion ||
+            _header->byteOrder != header_type::byteOrderMark || _header->nameSize != sizeof(T) ||
+            _header->headerChecksum != _header->computeHeaderChecksum())
+        {
+            throw 1;
+        }
+
+        const uint64_t expected[4] = {_header->nodes * sizeof(node), (_header->nodes + 1) * sizeof(uint64_t),
+                                      _header->edges * sizeof(unsigned int),
+                                      static_cast<uint64_t>(_header->bucketCount) * sizeof(unsigned int)};
+        for (int s = 0; s < 4; s++)
+        {
+            if (_header->sectionSize[s] != expected[s] || _header->sectionOffset[s] % 64 != 0 ||
+                _header->sectionOffset[s] > _length || _header->sectionSize[s] > _length - _header->sectionOffset[s])
+            {
+                throw 1;
+            }
+        }
+        // L'indice deve avere una potenza di 2 di bucket e almeno uno vuoto
+        if (_header->nodes > 0 && (_header->bucketCount <= _header->nodes ||
+                                   (_header->bucketCount & (_header->bucketCount - 1)) != 0))
+        {
+            throw 1;
+        }
+
+        _nodes = reinterpret_cast<const node *>(base + _header->sectionOffset[header_type::names]);
+        _offsets = reinterpret_cast<const uint64_t *>(base + _header->sectionOffset[header_type::offsets]);
+        _targets = reinterpret_cast<const unsigned int *>(base + _header->sectionOffset[header_type::targets]);
+        _buckets = reinterpret_cast<const unsigned int *>(base + _header->sectionOffset[header_type::buckets]);
+
+        if (_header->nodes > 0 && static_cast<uint64_t>(_hash(_nodes[0].name)) != _header->hashCheck)
+        {
+            // Il file è stato scritto con un altro funtore di hash
+            throw 1;
+        }
+        checkSections();
+    };
+
+    /**
+     * @brief Controlla il contenuto delle sezioni usato come indice
+     *
+     * Gli offset partono da 0, non decrescono e finiscono a edges, ogni
+     * destinazione è minore di nodes, ogni bucket vale al più nodes e
+     * almeno uno è vuoto: con questi vincoli hasEdge, successors e le
+     * ricerche per nome restano dentro le sezioni e terminano. Costa
+     * O(N + E) e lancia un errore se un controllo fallisce.
+     */
+    void checkSections() const
+    {
+        const uint64_t nodes = _header->nodes;
+        const uint64_t edges = _header->edges;
+        // Destinazioni e bucket sono interi da 32 bit
+        if (nodes >= 0xffffffffULL)
+        {
+            throw 1;
+        }
+        if (_offsets[0] != 0 || _offsets[nodes] != edges)
+        {
+            throw 1;
+        }
+        for (uint64_t i = 0; i < nodes; i++)
+        {
+            if (_offsets[i + 1] < _offsets[i])
+            {
+                throw 1;
+            }
+        }
+        for (uint64_t e = 0; e < edges; e++)
+        {
+            if (_targets[e] >= nodes)
+            {
+                throw 1;
+            }
+        }
+        bool empty = false;
+        for (uint32_t b = 0; b < _header->bucketCount; b++)
+        {
+            if (_buckets[b] > nodes)
+            {
+                throw 1;
+            }
+            empty = empty || _buckets[b] == 0;
+        }
+        if (_header->bucketCount > 0 && !empty)
+        {
+            throw 1;
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef NODE_COLUMNS_H
+#define NODE_COLUMNS_H
+
+#include <memory>      // std::allocator_traits
+#include <vector>
+#include <type_traits> // std::is_nothrow_move_assignable
+#include <utility>     // std::swap
+
+/**
+ * @file node_columns.h
+ * @brief Colonne di dati per nodo (pesi, etichette) di graph
+ *
+ * Una colonna è un array di valori, uno per posizione del graph, separato
+ * dall'array dei nomi: chi legge solo i pesi non carica i nomi in cache e
+ * viceversa. Le colonne si aggiungono con graph::addColumn, che restituisce
+ * un column_handle con cui leggere e scrivere i valori.
+ */
+
+/**
+ * @brief Riferimento a una colonna di valori V di un graph
+ *
+ * Resta valido finché il graph esiste, anche dopo riallocazioni e
+ * compattazioni; vale anche per le copie del graph, che hanno le stesse
+ * colonne nello stesso ordine.
+ *
+ * @tparam V Tipo dei valori
+ */
+template <typename V>
+class column_handle
+{
+    unsigned int _column; ///< Posizione della colonna nel graph
+
+    template <typename, typename, typename, typename, typename>
+    friend class graph;
+
+    explicit column_handle(unsigned int column) : _column(column){};
+
+public:
+    typedef V value_type;
+};
+
+/**
+ * @brief Colonna vista senza il tipo dei valori, usata da graph
+ *
+ * Tutte le operazioni tranne clone e reserve non lanciano eccezioni: graph
+ * le chiama dopo aver già modificato i nodi.
+ *
+ * @tparam Allocator Allocatore del graph
+ */
+template <typename Allocator>
+class basic_node_column
+{
+public:
+    virtual ~basic_node_column(){};
+
+    /**
+     * @brief Identifica il tipo dei valori, per i controlli con assert
+     */
+    virtual const void *type() const noexcept = 0;
+
+    /**
+     * @brief Copia dei primi count valori che alloca con alloc
+     */
+    virtual basic_node_column *clone(unsigned int count, const Allocator &alloc) const = 0;
+
+    /**
+     * @brief Porta la colonna ad almeno count valori, i nuovi valgono V()
+     *
+     * In caso di eccezione la colonna resta invariata
+     */
+    virtual void reserve(unsigned int count) = 0;
+
+    /**
+     * @brief Riduce la colonna a count valori, se possibile
+     */
+    virtual void shrink(unsigned int count) noexcept = 0;
+
+    /**
+     * @brief Riporta a V() il valore in posizione index
+     */
+    virtual void reset(unsigned int index) noexcept = 0;
+
+    /**
+     * @brief Riporta a V() tutti i valori
+     */
+    virtual void clear() noexcept = 0;
+
+    /**
+     * @brief Sposta i valori come graph::compact sposta i nomi
+     *
+     * @param remap Nuova posizione di ogni posizione vecchia, discarded per
+     *        quelle rimosse (che valgono già V())
+     * @param slots Numero di posizioni vecchie
+     * @param discarded Valore di remap per le posizioni rimosse
+     */
+    virtual void compact(const unsigned int *remap, unsigned int slots, unsigned int discarded) noexcept = 0;
+
+    /**
+     * @brief Distrugge la colonna creata da create o clone
+     */
+    virtual void destroy() noexcept = 0;
+};
+
+/**
+ * @brief Colonna di valori V, in un vettore che alloca con Allocator
+ *
+ * Si crea con create e si distrugge con destroy, che usano l'allocatore
+ * del graph anche per l'oggetto colonna.
+ */
+template <typename V, typename Allocator>
+class node_column : public basic_node_column<Allocator>
+{
+    static_assert(std::is_nothrow_move_assignable<V>::value, "i valori di una colonna devono spostarsi senza eccezioni");
+
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<V> value_allocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<node_column> column_allocator;
+    typedef std::allocator_traits<column_allocator> column_traits;
+
+    std::vector<V, value_allocator> _values; ///< Un valore per posizione
+
+public:
+    node_column(unsigned int count, const Allocator &alloc) : _values(count, V(), value_allocator(alloc)){};
+
+    node_column(const node_column &other, unsigned int count, const Allocator &alloc)
+        : _values(other._values.begin(), other._values.begin() + count, value_allocator(alloc)){};
+
+    /**
+     * @brief Alloca con alloc una colonna di count valori V()
+     */
+    static node_column *create(unsigned int count, const Allocator &alloc)
+    {
+        column_allocator calloc(alloc);
+        node_column *column = column_traits::allocate(calloc, 1);
+        try
+        {
+            column_traits::construct(calloc, column, count, alloc);
+        }
+        catch (...)
+        {
+            column_traits::deallocate(calloc, column, 1);
+            throw;
+        }
+        return column;
+    }
+
+    /**
+     * @brief Puntatore al primo valore
+     */
+    V *data()
+    {
+        return _values.data();
+    }
+
+    const V *data() const
+    {
+        return _values.data();
+    }
+
+    /**
+     * @brief Identificativo del tipo V, lo stesso per ogni node_column<V, ...>
+     */
+    static const void *typeTag() noexcept
+    {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    const void *type() const noexcept
+    {
+        return typeTag();
+    }
+
+    basic_node_column<Allocator> *clone(unsigned int count, const Allocator &alloc) const
+    {
+        column_allocator calloc(alloc);
+        node_column *column = column_traits::allocate(calloc, 1);
+        try
+        {
+            column_traits::construct(calloc, column, *this, count, alloc);
+        }
+        catch (...)
+        {
+            column_traits::deallocate(calloc, column, 1);
+            throw;
+        }
+        return column;
+    }
+
+    void reserve(unsigned int count)
+    {
+        if (count > _values.size())
+        {
+            // resize dà la garanzia forte solo se V si sposta senza eccezioni
+            // o si copia: V è spostabile senza eccezioni per static_assert
+            _values.resize(count);
+        }
+    }
+
+    void shrink(unsigned int count) noexcept
+    {
+        if (count >= _values.size())
+        {
+            return;
+        }
+        try
+        {
+            _values.resize(count);
+            _values.shrink_to_fit();
+        }
+        catch (...)
+        {
+            // Ridurre è solo un'ottimizzazione
+        }
+    }
+
+    void reset(unsigned int index) noexcept
+    {
+        _values[index] = V();
+    }
+
+    void clear() noexcept
+    {
+        for (size_t i = 0; i < _values.size(); i++)
+        {
+            _values[i] = V();
+        }
+    }
+
+    void compact(const unsigned int *remap, unsigned int slots, unsigned int discarded) noexcept
+    {
+        using std::swap;
+        for (unsigned int i = 0; i < slots; i++)
+        {
+            if (remap[i] != discarded && remap[i] != i)
+            {
+                swap(_values[remap[i]], _values[i]);
+            }
+        }
+    }
+
+    void destroy() noexcept
+    {
+        column_allocator calloc(_values.get_allocator());
+        node_column *self = this;
+        column_traits::destroy(calloc, self);
+        column_traits::deallocate(calloc, self, 1);
+    }
+};
+
+#endif
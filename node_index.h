@@ -0,0 +1,470 @@
+#ifndef NODE_INDEX_H
+#define NODE_INDEX_H
+
+#include <algorithm> // std::swap, std::fill
+#include <memory>    // std::allocator, std::allocator_traits
+#include <type_traits> // std::integral_constant
+#include <stddef.h>  // size_t
+
+/**
+ * @file node_index.h
+ * @brief Dichiarazione della classe node_index
+ */
+
+/**
+ * @brief Indice hash dal nome di un nodo alla sua posizione
+ *
+ * Tabella a indirizzamento aperto (linear probing) che memorizza solo la
+ * posizione dei nodi: i nomi restano nell'array di nodi del graph, che viene
+ * passato ai metodi che devono confrontarli. Ogni bucket contiene
+ * posizione + 1, 0 indica un bucket vuoto.
+ *
+ * @tparam T Tipo del nome dei nodi
+ * @tparam Hash Funtore di hash su T
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ * @tparam Allocator Allocatore per i bucket
+ */
+template <typename T, typename Hash, typename KeyEqual, typename Allocator = std::allocator<unsigned int> >
+class node_index
+{
+public:
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned int> allocator_type;
+
+private:
+    typedef std::allocator_traits<allocator_type> bucket_traits;
+
+    allocator_type _alloc;    ///< Allocatore dei bucket
+    unsigned int *_buckets;   ///< Array dei bucket (posizione + 1, 0 se vuoto)
+    unsigned int _capacity;   ///< Numero di bucket (potenza di 2)
+    unsigned int _count;      ///< Numero di posizioni memorizzate
+    Hash _hash;               ///< Funtore di hash
+    KeyEqual _equal;          ///< Funtore di uguaglianza
+
+public:
+    /**
+     * @brief Costruttore di default
+     *
+     * @post _buckets == nullptr
+     * @post _count == 0
+     */
+    node_index(const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual(),
+               const allocator_type &alloc = allocator_type())
+        : _alloc(alloc), _buckets(nullptr), _capacity(0), _count(0), _hash(hash), _equal(equal){};
+
+    /**
+     * @brief Copy constructor
+     *
+     * @param other node_index da copiare
+     */
+    node_index(const node_index &other)
+        : _alloc(bucket_traits::select_on_container_copy_construction(other._alloc)), _buckets(nullptr),
+          _capacity(0), _count(0), _hash(other._hash), _equal(other._equal)
+    {
+        copyBuckets(other);
+    };
+
+    /**
+     * @brief Copy constructor con allocatore
+     *
+     * @param other node_index da copiare
+     * @param alloc Allocatore della copia
+     */
+    node_index(const node_index &other, const allocator_type &alloc)
+        : _alloc(alloc), _buckets(nullptr), _capacity(0), _count(0), _hash(other._hash), _equal(other._equal)
+    {
+        copyBuckets(other);
+    };
+
+    /**
+     * @brief Operatore di assegnamento
+     *
+     * @param other node_index da copiare
+     *
+     * @return reference a node_index
+     */
+    node_index &operator=(const node_index &other)
+    {
+        if (this != &other)
+        {
+            node_index tmp(other,
+                           bucket_traits::propagate_on_container_copy_assignment::value ? other._alloc : _alloc);
+
+            tmp.swap(*this);
+        }
+
+        return *this;
+    };
+
+    /**
+     * @brief Distruttore della classe
+     */
+    ~node_index()
+    {
+        if (_buckets != nullptr)
+        {
+            bucket_traits::deallocate(_alloc, _buckets, _capacity);
+        }
+        _buckets = nullptr;
+        _capacity = 0;
+        _count = 0;
+    };
+
+    /**
+     * @brief Scambia lo stato interno con un altro node_index
+     *
+     * @param other node_index sorgente
+     */
+    void swap(node_index &other) noexcept
+    {
+        swapAllocators(_alloc, other._alloc);
+        std::swap(_buckets, other._buckets);
+        std::swap(_capacity, other._capacity);
+        std::swap(_count, other._count);
+        std::swap(_hash, other._hash);
+        std::swap(_equal, other._equal);
+    };
+
+    /**
+     * @brief Getter del funtore di hash
+     */
+    const Hash &hash_function() const
+    {
+        return _hash;
+    };
+
+    /**
+     * @brief Getter del funtore di uguaglianza
+     */
+    const KeyEqual &key_eq() const
+    {
+        return _equal;
+    };
+
+    /**
+     * @brief Getter dell'allocatore
+     */
+    allocator_type get_allocator() const
+    {
+        return _alloc;
+    };
+
+    /**
+     * @brief Cerca la posizione di un nome
+     *
+     * @param name Nome da cercare
+     * @param nodes Array di nodi del graph (con membro name)
+     *
+     * @return Posizione del nodo, -1 se non presente
+     */
+    template <typename Node>
+    int find(const T &name, const Node *nodes) const
+    {
+        if (_count == 0)
+        {
+            return -1;
+        }
+        return findIn(_buckets, _capacity, name, nodes, _hash, _equal);
+    };
+
+    /**
+     * @brief Cerca la posizione di un nome in un array di bucket esterno
+     *
+     * L'array deve avere la stessa disposizione di quello di un node_index
+     * costruito con lo stesso funtore di hash, per esempio perché copiato
+     * da buckets() in un file (vedi mapped_graph).
+     *
+     * @param buckets Array dei bucket (posizione + 1, 0 se vuoto)
+     * @param capacity Numero di bucket (potenza di 2, almeno un bucket vuoto)
+     * @param name Nome da cercare
+     * @param nodes Array di nodi (con membro name)
+     * @param hash Funtore di hash
+     * @param equal Funtore di uguaglianza
+     *
+     * @return Posizione del nodo, -1 se non presente
+     */
+    template <typename Node>
+    static int findIn(const unsigned int *buckets, unsigned int capacity, const T &name, const Node *nodes,
+                      const Hash &hash, const KeyEqual &equal)
+    {
+        if (capacity == 0)
+        {
+            return -1;
+        }
+        return probe(name, capacity, hash, [buckets](unsigned int b) { return buckets[b]; },
+                     [&](unsigned int p) { return equal(nodes[p].name, name); });
+    };
+
+    /**
+     * @brief Scorre la sequenza di bucket di un nome fino a un bucket vuoto
+     *
+     * Condiviso con le tabelle che non sono un node_index (bucket atomici in
+     * concurrent_graph, cow_array in versioned_graph): load(b) legge il
+     * bucket b, match(p) dice se la posizione p contiene il nome cercato.
+     *
+     * @param name Nome da cercare
+     * @param capacity Numero di bucket (potenza di 2, almeno un bucket vuoto)
+     * @param hash Funtore di hash
+     * @param load Lettura di un bucket (posizione + 1, 0 se vuoto)
+     * @param match Confronto della posizione con il nome
+     *
+     * @return Prima posizione accettata da match, -1 se nessuna
+     */
+    template <typename Load, typename Match>
+    static int probe(const T &name, unsigned int capacity, const Hash &hash, Load load, Match match)
+    {
+        unsigned int mask = capacity - 1;
+        for (unsigned int b = bucketFor(name, capacity, hash), p = load(b); p != 0; b = (b + 1) & mask, p = load(b))
+        {
+            if (match(p - 1))
+            {
+                return static_cast<int>(p - 1);
+            }
+        }
+        return -1;
+    };
+
+    /**
+     * @brief Primo bucket vuoto della sequenza di un nome
+     *
+     * @pre Esiste almeno un bucket vuoto
+     *
+     * @param name Nome da inserire
+     * @param capacity Numero di bucket (potenza di 2)
+     * @param hash Funtore di hash
+     * @param load Lettura di un bucket (posizione + 1, 0 se vuoto)
+     *
+     * @return Indice del bucket
+     */
+    template <typename Load>
+    static unsigned int freeBucket(const T &name, unsigned int capacity, const Hash &hash, Load load)
+    {
+        unsigned int mask = capacity - 1;
+        unsigned int b = bucketFor(name, capacity, hash);
+        while (load(b) != 0)
+        {
+            b = (b + 1) & mask;
+        }
+        return b;
+    };
+
+    /**
+     * @brief Capacità per count elementi con fattore di carico al più 1/2
+     *
+     * Potenza di 2, almeno 16. La usano anche concurrent_graph e
+     * versioned_graph per dimensionare posizioni e bucket.
+     */
+    static unsigned int capacityFor(unsigned int count)
+    {
+        unsigned int capacity = 16;
+        while (capacity < static_cast<size_t>(count) * 2)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    };
+
+    /**
+     * @brief Bucket di partenza per un nome in una tabella di capacity bucket
+     */
+    static unsigned int bucketFor(const T &name, unsigned int capacity, const Hash &hash)
+    {
+        size_t h = hash(name);
+        // Mescolo i bit alti perché molti std::hash sono l'identità
+        h ^= h >> 16;
+        h *= 0x45d9f3bU;
+        h ^= h >> 16;
+        return static_cast<unsigned int>(h) & (capacity - 1);
+    };
+
+    /**
+     * @brief Getter dell'array dei bucket (capacity() elementi)
+     */
+    const unsigned int *buckets() const
+    {
+        return _buckets;
+    };
+
+    /**
+     * @brief Getter del numero di bucket
+     */
+    unsigned int capacity() const
+    {
+        return _capacity;
+    };
+
+    /**
+     * @brief Garantisce spazio per count posizioni senza riallocare
+     *
+     * In caso di eccezione l'indice resta invariato.
+     *
+     * @param count Numero di posizioni da poter contenere
+     * @param nodes Array di nodi del graph, usato per ricalcolare gli hash
+     */
+    template <typename Node>
+    void reserve(unsigned int count, const Node *nodes)
+    {
+        // Fattore di carico massimo 1/2
+        if (static_cast<size_t>(count) * 2 <= _capacity)
+        {
+            return;
+        }
+        unsigned int capacity = capacityFor(count);
+
+        node_index tmp(_hash, _equal, _alloc);
+        tmp._buckets = bucket_traits::allocate(tmp._alloc, capacity);
+        tmp._capacity = capacity;
+        std::fill(tmp._buckets, tmp._buckets + capacity, 0u);
+        for (unsigned int b = 0; b < _capacity; b++)
+        {
+            if (_buckets[b] != 0)
+            {
+                tmp.place(nodes[_buckets[b] - 1].name, _buckets[b] - 1);
+            }
+        }
+        tmp._count = _count;
+
+        tmp.swap(*this);
+    };
+
+    /**
+     * @brief Inserisce la posizione di un nome
+     *
+     * @pre name non è già presente
+     *
+     * @param name Nome del nodo
+     * @param position Posizione del nodo nell'array
+     * @param nodes Array di nodi del graph
+     */
+    template <typename Node>
+    void insert(const T &name, unsigned int position, const Node *nodes)
+    {
+        reserve(_count + 1, nodes);
+        place(name, position);
+        _count++;
+    };
+
+    /**
+     * @brief Rimuove un nome dall'indice
+     *
+     * Usa la cancellazione con spostamento all'indietro, senza lasciare
+     * marcatori nei bucket.
+     *
+     * @param name Nome da rimuovere
+     * @param nodes Array di nodi del graph
+     *
+     * @return true se il nome era presente
+     */
+    template <typename Node>
+    bool erase(const T &name, const Node *nodes)
+    {
+        if (_count == 0)
+        {
+            return false;
+        }
+        unsigned int mask = _capacity - 1;
+        unsigned int b = bucketFor(name);
+        while (_buckets[b] != 0 && !_equal(nodes[_buckets[b] - 1].name, name))
+        {
+            b = (b + 1) & mask;
+        }
+        if (_buckets[b] == 0)
+        {
+            return false;
+        }
+
+        // Sposto indietro gli elementi successivi della stessa sequenza
+        unsigned int hole = b;
+        for (unsigned int next = (hole + 1) & mask; _buckets[next] != 0; next = (next + 1) & mask)
+        {
+            unsigned int home = bucketFor(nodes[_buckets[next] - 1].name);
+            // L'elemento può occupare il buco solo se la sua posizione
+            // naturale non cade tra il buco (escluso) e next (incluso)
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                _buckets[hole] = _buckets[next];
+                hole = next;
+            }
+        }
+        _buckets[hole] = 0;
+        _count--;
+        return true;
+    };
+
+    /**
+     * @brief Rinumera le posizioni memorizzate
+     *
+     * Usato dopo la compattazione dell'array di nodi: ogni posizione p
+     * diventa remap[p]. Non serve ricalcolare gli hash perché i nomi non
+     * cambiano.
+     *
+     * @param remap Nuova posizione di ogni nodo presente nell'indice
+     */
+    void remap(const unsigned int *remap)
+    {
+        for (unsigned int b = 0; b < _capacity; b++)
+        {
+            if (_buckets[b] != 0)
+            {
+                _buckets[b] = remap[_buckets[b] - 1] + 1;
+            }
+        }
+    };
+
+private:
+
+    /**
+     * @brief Scambia gli allocatori se il loro tipo si propaga
+     *
+     * Gli allocatori che non si propagano mai (come
+     * std::pmr::polymorphic_allocator) restano al loro posto: in quel caso
+     * swap richiede allocatori uguali
+     */
+    static void swapAllocators(allocator_type &first, allocator_type &second) noexcept
+    {
+        swapAllocators(first, second,
+                       std::integral_constant<bool, bucket_traits::propagate_on_container_copy_assignment::value ||
+                                                        bucket_traits::propagate_on_container_move_assignment::value ||
+                                                        bucket_traits::propagate_on_container_swap::value>());
+    };
+
+    static void swapAllocators(allocator_type &first, allocator_type &second, std::true_type) noexcept
+    {
+        std::swap(first, second);
+    };
+
+    static void swapAllocators(allocator_type &, allocator_type &, std::false_type) noexcept {};
+    /**
+     * @brief Copia i bucket di other in un indice vuoto
+     */
+    void copyBuckets(const node_index &other)
+    {
+        if (other._capacity != 0)
+        {
+            _buckets = bucket_traits::allocate(_alloc, other._capacity);
+            _capacity = other._capacity;
+            std::copy(other._buckets, other._buckets + _capacity, _buckets);
+        }
+        _count = other._count;
+    };
+
+    /**
+     * @brief Bucket di partenza per un nome
+     */
+    unsigned int bucketFor(const T &name) const
+    {
+        return bucketFor(name, _capacity, _hash);
+    };
+
+    /**
+     * @brief Colloca una posizione nel primo bucket libero
+     *
+     * @pre Esiste almeno un bucket libero
+     */
+    void place(const T &name, unsigned int position)
+    {
+        const unsigned int *buckets = _buckets;
+        _buckets[freeBucket(name, _capacity, _hash, [buckets](unsigned int b) { return buckets[b]; })] = position + 1;
+    };
+};
+
+#endif
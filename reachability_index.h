@@ -0,0 +1,406 @@
+#ifndef REACHABILITY_INDEX_H
+#define REACHABILITY_INDEX_H
+
+#include <algorithm> // std::min, std::fill
+#include <cassert>
+#include <vector>
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+#include "graph.h"
+#include "thread_pool.h"
+
+/**
+ * @file reachability_index.h
+ * @brief Dichiarazione della classe reachability_index
+ */
+
+/**
+ * @brief Indice di raggiungibilità (chiusura transitiva) di un graph
+ *
+ * Memorizza la chiusura transitiva come dense_bitset: il bit (i, j) vale 1
+ * se esiste un cammino di almeno un arco da i a j. isReachable risponde
+ * quindi in O(1) con un solo accesso alla matrice.
+ *
+ * L'indice lavora su un graph esterno, che deve sopravvivergli. Le
+ * modifiche vanno fatte tramite i metodi addEdge, removeEdge, addNode,
+ * removeNode e compact dell'indice, che le inoltrano al graph e aggiornano
+ * la chiusura in modo incrementale. Dopo una modifica fatta direttamente
+ * sul graph bisogna chiamare rebuild(): l'indice ricorda
+ * graph::modifications() all'ultimo allineamento e isReachable lo
+ * controlla con un assert.
+ *
+ * La matrice occupa N^2 / 8 byte, con N numero di posizioni del graph.
+ *
+ * @tparam T Tipo del nome dei nodi
+ * @tparam Storage Politica di memorizzazione del graph
+ * @tparam Hash Funtore di hash su T
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ * @tparam Allocator Allocatore del graph
+ */
+template <typename T, typename Storage = dense_bitset, typename Hash = std::hash<T>,
+          typename KeyEqual = std::equal_to<T>, typename Allocator = std::allocator<T> >
+class reachability_index
+{
+public:
+    typedef graph<T, Storage, Hash, KeyEqual, Allocator> graph_type;
+    typedef dense_bitset::word_type word_type;
+
+private:
+    graph_type &_graph;       ///< graph indicizzato
+    dense_bitset _closure;    ///< Chiusura transitiva, una riga per posizione del graph
+    std::vector<bool> _alive; ///< Posizioni vive del graph, per seguirne la compattazione
+    uint64_t _synced;         ///< graph::modifications() all'ultimo allineamento della chiusura
+
+public:
+    /**
+     * @brief Costruttore
+     *
+     * Costruisce la chiusura con rebuild()
+     *
+     * @param gr graph da indicizzare
+     * @param pool thread_pool da usare, nullptr per la costruzione seriale
+     */
+    explicit reachability_index(graph_type &gr, thread_pool *pool = nullptr) : _graph(gr), _closure(), _alive(), _synced(0)
+    {
+        rebuild(pool);
+    };
+
+    /**
+     * @brief Getter del graph indicizzato
+     */
+    const graph_type &indexedGraph() const
+    {
+        return _graph;
+    };
+
+    /**
+     * @brief Getter della chiusura transitiva
+     *
+     * La riga i contiene i nodi raggiungibili da i con almeno un arco
+     */
+    const dense_bitset &closure() const
+    {
+        return _closure;
+    };
+
+    /**
+     * @brief Ricostruisce la chiusura da zero
+     *
+     * Algoritmo di Warshall sulle righe compatte: per ogni k, ogni riga che
+     * contiene k viene unita alla riga k parola per parola. Costa
+     * O(N^3 / 64); per un k fissato le righe sono indipendenti e vengono
+     * distribuite sul thread_pool.
+     *
+     * @param pool thread_pool da usare, nullptr per la costruzione seriale
+     */
+    void rebuild(thread_pool *pool = nullptr)
+    {
+        const unsigned int n = _graph.slots();
+        dense_bitset closure(n);
+        std::vector<bool> alive(n);
+        for (unsigned int i = 0; i < n; i++)
+        {
+            alive[i] = _graph.isAlive(i);
+            _graph.adjacency().forEachSuccessor(i, [&closure, i](unsigned int j) { closure.set(i, j); });
+        }
+
+        // Le righe si calcolano da un solo puntatore: row() modificabile
+        // scarta la vista trasposta a ogni chiamata, con una scrittura
+        // atomica che tutti i thread farebbero sulla stessa linea di cache
+        closure.releaseTransposed();
+        word_type *const matrix = closure.row(0);
+        const size_t stride = closure.wordsPerRow();
+        const unsigned int words = dense_bitset::wordsFor(n);
+        const size_t rowsPerChunk = 256;
+        for (unsigned int k = 0; k < n; k++)
+        {
+            const word_type *through = matrix + k * stride;
+            parallelFor(pool, (n + rowsPerChunk - 1) / rowsPerChunk, [&](size_t c) {
+                unsigned int last = static_cast<unsigned int>(std::min<size_t>(n, (c + 1) * rowsPerChunk));
+                for (unsigned int i = static_cast<unsigned int>(c * rowsPerChunk); i < last; i++)
+                {
+                    word_type *row = matrix + i * stride;
+                    if (i != k && ((row[k / dense_bitset::bitsPerWord] >> (k % dense_bitset::bitsPerWord)) & 1) != 0)
+                    {
+                        for (unsigned int w = 0; w < words; w++)
+                        {
+                            row[w] |= through[w];
+                        }
+                    }
+                }
+            });
+        }
+
+        _closure.swap(closure);
+        _alive.swap(alive);
+        _synced = _graph.modifications();
+    };
+
+    /**
+     * @brief Verifica se esiste un cammino da un nodo a un altro
+     *
+     * Ogni nodo raggiunge sé stesso, come in isReachable di
+     * graph_traversal.h
+     *
+     * @param origin_node Nome del nodo di partenza
+     * @param destination_node Nome del nodo di arrivo
+     *
+     * @return true se destination_node è raggiungibile da origin_node
+     */
+    bool isReachable(const T &origin_node, const T &destination_node) const
+    {
+        int origin_index = _graph.indexOf(origin_node);
+        int destination_index = _graph.indexOf(destination_node);
+        if (origin_index == -1 || destination_index == -1)
+        {
+            throw 1;
+        }
+        return isReachableAt(origin_index, destination_index);
+    };
+
+    /**
+     * @brief Verifica se esiste un cammino tra due posizioni
+     *
+     * @pre origin < indexedGraph().slots() && destination < indexedGraph().slots()
+     */
+    bool isReachableAt(unsigned int origin, unsigned int destination) const
+    {
+        // Il graph è stato modificato senza passare dall'indice: serve rebuild()
+        assert(_synced == _graph.modifications());
+        assert(_closure.size() == _graph.slots());
+
+        return origin == destination || _closure.test(origin, destination);
+    };
+
+    /**
+     * @brief Aggiunge un arco al graph e aggiorna la chiusura
+     *
+     * Ogni nodo che raggiunge l'origine (e l'origine stessa) riceve la
+     * riga della destinazione. Costa O(N^2 / 64) nel caso peggiore e O(1)
+     * se la destinazione era già raggiungibile.
+     */
+    void addEdge(const T &origin_node, const T &destination_node)
+    {
+        _graph.addEdge(origin_node, destination_node);
+        _synced = _graph.modifications();
+
+        unsigned int a = _graph.indexOf(origin_node);
+        unsigned int b = _graph.indexOf(destination_node);
+        if (_closure.test(a, b))
+        {
+            return;
+        }
+
+        const unsigned int words = _closure.wordsPerRow();
+        _closure.releaseTransposed();
+        word_type *const matrix = _closure.row(0);
+        const word_type *through = matrix + static_cast<size_t>(b) * words;
+        for (unsigned int i = 0; i < _closure.size(); i++)
+        {
+            if (i == a || _closure.test(i, a))
+            {
+                // La riga b può coincidere con la riga i se b raggiunge a
+                word_type *row = matrix + static_cast<size_t>(i) * words;
+                if (row != through)
+                {
+                    for (unsigned int w = 0; w < words; w++)
+                    {
+                        row[w] |= through[w];
+                    }
+                }
+                _closure.set(i, b);
+            }
+        }
+    };
+
+    /**
+     * @brief Rimuove un arco dal graph e aggiorna la chiusura
+     *
+     * Solo le righe dei nodi che raggiungevano l'origine possono cambiare:
+     * vengono ricalcolate con recomputeRows.
+     */
+    void removeEdge(const T &origin_node, const T &destination_node)
+    {
+        _graph.removeEdge(origin_node, destination_node);
+        _synced = _graph.modifications();
+
+        unsigned int a = _graph.indexOf(origin_node);
+        std::vector<unsigned int> affected = ancestors(a);
+        if (!_closure.test(a, a))
+        {
+            affected.push_back(a);
+        }
+        recomputeRows(affected);
+    };
+
+    /**
+     * @brief Aggiunge un nodo al graph e alla chiusura
+     *
+     * Il nuovo nodo non ha archi: la matrice cresce di una riga e una
+     * colonna vuote, in O(1) ammortizzato.
+     */
+    void addNode(const T &node_name)
+    {
+        _graph.addNode(node_name);
+        _synced = _graph.modifications();
+        _closure.resize(_graph.slots());
+        _alive.push_back(true);
+    };
+
+    /**
+     * @brief Rimuove un nodo dal graph e aggiorna la chiusura
+     *
+     * Vengono ricalcolate le righe dei nodi che raggiungevano il nodo
+     * rimosso. La compattazione automatica del graph viene rimandata a dopo
+     * il ricalcolo, che usa le posizioni correnti, e applicata poi a graph
+     * e chiusura insieme con la stessa soglia.
+     */
+    void removeNode(const T &node_name)
+    {
+        int removed = _graph.indexOf(node_name);
+        if (removed == -1)
+        {
+            throw 1;
+        }
+        std::vector<unsigned int> affected = ancestors(removed);
+
+        double threshold = _graph.compactionThreshold();
+        _graph.setCompactionThreshold(1);
+        _graph.removeNode(node_name);
+        _graph.setCompactionThreshold(threshold);
+        _synced = _graph.modifications();
+
+        _closure.clear(removed);
+        _alive[removed] = false;
+        for (size_t k = 0; k < affected.size(); k++)
+        {
+            if (affected[k] == static_cast<unsigned int>(removed))
+            {
+                affected.erase(affected.begin() + k);
+                break;
+            }
+        }
+        recomputeRows(affected);
+
+        if (_graph.slots() - _graph.size() > threshold * _graph.slots())
+        {
+            try
+            {
+                compact();
+            }
+            catch (...)
+            {
+                // Come in graph::removeNode la compattazione è solo
+                // un'ottimizzazione
+            }
+        }
+    };
+
+    /**
+     * @brief Compatta il graph e la chiusura (vedi graph::compact)
+     */
+    void compact()
+    {
+        _graph.compact();
+        _synced = _graph.modifications();
+        followCompaction();
+    };
+
+private:
+    /**
+     * @brief Nodi che raggiungono index, letti dalla colonna della chiusura
+     */
+    std::vector<unsigned int> ancestors(unsigned int index) const
+    {
+        std::vector<unsigned int> result;
+        for (unsigned int i = 0; i < _closure.size(); i++)
+        {
+            if (_closure.test(i, index))
+            {
+                result.push_back(i);
+            }
+        }
+        return result;
+    };
+
+    /**
+     * @brief Ricalcola le righe di un insieme di nodi
+     *
+     * Da ogni nodo di rows parte una visita in profondità sul graph che usa
+     * la riga stessa come insieme dei visitati. I nodi fuori da rows hanno
+     * righe ancora valide: quando la visita ne incontra uno unisce la sua
+     * riga e non lo espande. Costa, per ogni riga, gli archi tra i nodi di
+     * rows più O(N / 64) per ogni nodo esterno incontrato.
+     *
+     * @param rows Nodi le cui righe vanno ricalcolate
+     */
+    void recomputeRows(const std::vector<unsigned int> &rows)
+    {
+        const unsigned int words = _closure.wordsPerRow();
+        _closure.releaseTransposed();
+        word_type *const matrix = _closure.row(0);
+        std::vector<bool> stale(_closure.size(), false);
+        for (size_t k = 0; k < rows.size(); k++)
+        {
+            stale[rows[k]] = true;
+            std::fill(matrix + static_cast<size_t>(rows[k]) * words, matrix + static_cast<size_t>(rows[k] + 1) * words,
+                      word_type(0));
+        }
+
+        std::vector<unsigned int> stack;
+        for (size_t k = 0; k < rows.size(); k++)
+        {
+            const unsigned int i = rows[k];
+            word_type *row = matrix + static_cast<size_t>(i) * words;
+            stack.push_back(i);
+            while (!stack.empty())
+            {
+                unsigned int u = stack.back();
+                stack.pop_back();
+                _graph.adjacency().forEachSuccessor(u, [&](unsigned int v) {
+                    if (_closure.test(i, v))
+                    {
+                        return;
+                    }
+                    _closure.set(i, v);
+                    if (stale[v])
+                    {
+                        stack.push_back(v);
+                    }
+                    else
+                    {
+                        const word_type *through = matrix + static_cast<size_t>(v) * words;
+                        for (unsigned int w = 0; w < words; w++)
+                        {
+                            row[w] |= through[w];
+                        }
+                    }
+                });
+            }
+        }
+    };
+
+    /**
+     * @brief Allinea la chiusura a una compattazione del graph
+     *
+     * compact() conserva l'ordine dei nodi vivi, quindi la rinumerazione
+     * del graph si ricava da _alive.
+     */
+    void followCompaction()
+    {
+        if (_closure.size() == _graph.slots())
+        {
+            return;
+        }
+        std::vector<unsigned int> remap(_closure.size());
+        unsigned int next = 0;
+        for (unsigned int i = 0; i < _closure.size(); i++)
+        {
+            remap[i] = _alive[i] ? next++ : dense_bitset::discarded;
+        }
+        _closure.compact(remap.data(), next);
+        _alive.assign(next, true);
+    };
+};
+
+#endif
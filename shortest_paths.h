@@ -0,0 +1,526 @@
+#ifndef SHORTEST_PATHS_H
+#define SHORTEST_PATHS_H
+
+#include <algorithm> // std::min, std::reverse, std::copy
+#include <limits>
+#include <vector>
+#include <stddef.h> // size_t
+#include "graph.h"
+#include "thread_pool.h"
+
+/**
+ * @file shortest_paths.h
+ * @brief Cammini minimi sui graph con pesi (Dijkstra, Bellman-Ford, Floyd-Warshall)
+ *
+ * Gli algoritmi lavorano sui graph con una politica con pesi (vedi
+ * weighted_adjacency.h). Come in graph_algorithms.h gli indici sono
+ * posizioni del graph (vedi graph::slots) e le posizioni rimosse vengono
+ * ignorate. Un nodo non raggiungibile ha distanza
+ * distance_traits<W>::infinity().
+ */
+
+/**
+ * @brief Distanza infinita per il tipo di peso W
+ *
+ * Per i tipi con infinito (float, double) è l'infinito; per gli interi è
+ * metà del massimo, così sommarle un peso non va in overflow.
+ */
+template <typename W>
+struct distance_traits
+{
+    static W infinity()
+    {
+        return std::numeric_limits<W>::has_infinity ? std::numeric_limits<W>::infinity()
+                                                    : std::numeric_limits<W>::max() / 2;
+    };
+};
+
+/**
+ * @brief Risultato di dijkstra e bellmanFord
+ */
+template <typename W>
+struct path_result
+{
+    std::vector<W> distance; ///< Distanza di ogni posizione dalla sorgente
+    std::vector<int> parent; ///< Posizione precedente sul cammino minimo, -1 per la sorgente e i non raggiunti
+
+    path_result() : distance(), parent(){};
+
+    /**
+     * @brief true se la posizione index è raggiungibile dalla sorgente
+     */
+    bool reached(unsigned int index) const
+    {
+        return distance[index] != distance_traits<W>::infinity();
+    };
+
+    /**
+     * @brief Posizioni del cammino minimo dalla sorgente a index
+     *
+     * @return Posizioni dalla sorgente a index comprese, vuoto se index non
+     *         è raggiungibile
+     */
+    std::vector<unsigned int> pathTo(unsigned int index) const
+    {
+        std::vector<unsigned int> path;
+        if (!reached(index))
+        {
+            return path;
+        }
+        for (int at = static_cast<int>(index); at != -1; at = parent[at])
+        {
+            path.push_back(static_cast<unsigned int>(at));
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    };
+};
+
+/**
+ * @brief Coda di priorità d-aria con chiavi modificabili
+ *
+ * Gli elementi sono interi da 0 a items - 1. Lo heap è un array di coppie
+ * (chiave, elemento): i D figli di un nodo sono contigui, quindi con D = 4
+ * e chiavi double il confronto tra fratelli legge una sola linea di cache,
+ * e l'albero è alto la metà di uno heap binario.
+ *
+ * @tparam Key Tipo della chiave, confrontato con <
+ * @tparam D Numero di figli per nodo
+ */
+template <typename Key, unsigned int D = 4>
+class d_ary_heap
+{
+    struct entry
+    {
+        Key key;
+        unsigned int item;
+    };
+
+    static const unsigned int absent = ~0u; ///< Posizione di un elemento non nello heap
+
+    std::vector<entry> _heap;            ///< Heap, il minimo in posizione 0
+    std::vector<unsigned int> _position; ///< Posizione di ogni elemento in _heap, absent se assente
+
+public:
+    /**
+     * @brief Costruttore, heap vuoto per elementi da 0 a items - 1
+     */
+    explicit d_ary_heap(unsigned int items) : _heap(), _position(items, absent){};
+
+    bool empty() const
+    {
+        return _heap.empty();
+    };
+
+    /**
+     * @brief Inserisce item con chiave key, o ne abbassa la chiave se presente
+     *
+     * @pre item non presente, oppure key non maggiore della sua chiave
+     */
+    void push(unsigned int item, const Key &key)
+    {
+        unsigned int at = _position[item];
+        if (at == absent)
+        {
+            at = static_cast<unsigned int>(_heap.size());
+            entry e = {key, item};
+            _heap.push_back(e);
+        }
+        else
+        {
+            _heap[at].key = key;
+        }
+        siftUp(at);
+    };
+
+    /**
+     * @brief Toglie l'elemento con la chiave minima
+     *
+     * @pre !empty()
+     *
+     * @return Elemento tolto
+     */
+    unsigned int pop()
+    {
+        unsigned int top = _heap[0].item;
+        _position[top] = absent;
+        entry last = _heap.back();
+        _heap.pop_back();
+        if (!_heap.empty())
+        {
+            _heap[0] = last;
+            _position[last.item] = 0;
+            siftDown(0);
+        }
+        return top;
+    };
+
+private:
+    void siftUp(unsigned int at)
+    {
+        entry moving = _heap[at];
+        while (at > 0)
+        {
+            unsigned int parent = (at - 1) / D;
+            if (!(moving.key < _heap[parent].key))
+            {
+                break;
+            }
+            _heap[at] = _heap[parent];
+            _position[_heap[at].item] = at;
+            at = parent;
+        }
+        _heap[at] = moving;
+        _position[moving.item] = at;
+    };
+
+    void siftDown(unsigned int at)
+    {
+        const size_t size = _heap.size();
+        entry moving = _heap[at];
+        for (;;)
+        {
+            size_t first = static_cast<size_t>(at) * D + 1;
+            if (first >= size)
+            {
+                break;
+            }
+            size_t last = std::min(first + D, size);
+            size_t best = first;
+            for (size_t child = first + 1; child < last; child++)
+            {
+                if (_heap[child].key < _heap[best].key)
+                {
+                    best = child;
+                }
+            }
+            if (!(_heap[best].key < moving.key))
+            {
+                break;
+            }
+            _heap[at] = _heap[best];
+            _position[_heap[at].item] = at;
+            at = static_cast<unsigned int>(best);
+        }
+        _heap[at] = moving;
+        _position[moving.item] = at;
+    };
+};
+
+template <typename Key, unsigned int D>
+const unsigned int d_ary_heap<Key, D>::absent;
+
+/**
+ * @brief Cammini minimi da una sorgente (algoritmo di Dijkstra)
+ *
+ * Usa un d_ary_heap con chiavi modificabili: ogni nodo entra nella coda
+ * una volta sola. Costa O((N + E) log N). I pesi devono essere non
+ * negativi: un arco negativo lancia un errore (vedi bellmanFord).
+ *
+ * @param gr graph con pesi
+ * @param source Nome del nodo di partenza
+ *
+ * @return Distanze e predecessori di ogni posizione
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+path_result<typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type::weight_type>
+dijkstra(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const T &source)
+{
+    typedef typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type storage_type;
+    typedef typename storage_type::weight_type W;
+
+    int start = gr.indexOf(source);
+    if (start == -1)
+    {
+        throw 1;
+    }
+
+    const unsigned int n = gr.slots();
+    const storage_type &storage = gr.adjacency();
+    path_result<W> result;
+    result.distance.assign(n, distance_traits<W>::infinity());
+    result.parent.assign(n, -1);
+    result.distance[start] = W();
+
+    d_ary_heap<W> queue(n);
+    queue.push(start, W());
+    while (!queue.empty())
+    {
+        const unsigned int u = queue.pop();
+        const W du = result.distance[u];
+        storage.forEachWeightedSuccessor(u, [&](unsigned int v, const W &w) {
+            if (w < W())
+            {
+                throw 1;
+            }
+            W dv = du + w;
+            if (dv < result.distance[v])
+            {
+                result.distance[v] = dv;
+                result.parent[v] = static_cast<int>(u);
+                queue.push(v, dv);
+            }
+        });
+    }
+    return result;
+}
+
+/**
+ * @brief Cammini minimi da una sorgente con pesi anche negativi (Bellman-Ford)
+ *
+ * A ogni passata rilassa solo gli archi uscenti dai nodi la cui distanza è
+ * cambiata nella passata precedente, e si ferma quando non cambia più
+ * niente. Se la passata size() cambia ancora qualcosa, dalla sorgente si
+ * raggiunge un ciclo negativo e le distanze non hanno significato. Costa
+ * O(N E) nel caso peggiore.
+ *
+ * @param gr graph con pesi
+ * @param source Nome del nodo di partenza
+ * @param result Riceve distanze e predecessori di ogni posizione
+ * @param cycle Se non nullo riceve le posizioni di un ciclo negativo,
+ *        nell'ordine degli archi, quando esiste
+ *
+ * @return false se dalla sorgente si raggiunge un ciclo negativo
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+bool bellmanFord(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, const T &source,
+                 path_result<typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type::weight_type> &result,
+                 std::vector<unsigned int> *cycle = nullptr)
+{
+    typedef typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type storage_type;
+    typedef typename storage_type::weight_type W;
+
+    int start = gr.indexOf(source);
+    if (start == -1)
+    {
+        throw 1;
+    }
+
+    const unsigned int n = gr.slots();
+    const storage_type &storage = gr.adjacency();
+    result.distance.assign(n, distance_traits<W>::infinity());
+    result.parent.assign(n, -1);
+    result.distance[start] = W();
+
+    std::vector<unsigned int> active(1, static_cast<unsigned int>(start));
+    std::vector<unsigned int> next;
+    std::vector<char> queued(n, 0);
+    for (unsigned int round = 0; round < gr.size() && !active.empty(); round++)
+    {
+        next.clear();
+        for (size_t a = 0; a < active.size(); a++)
+        {
+            const unsigned int u = active[a];
+            const W du = result.distance[u];
+            storage.forEachWeightedSuccessor(u, [&](unsigned int v, const W &w) {
+                W dv = du + w;
+                if (dv < result.distance[v])
+                {
+                    result.distance[v] = dv;
+                    result.parent[v] = static_cast<int>(u);
+                    if (!queued[v])
+                    {
+                        queued[v] = 1;
+                        next.push_back(v);
+                    }
+                }
+            });
+        }
+        for (size_t a = 0; a < next.size(); a++)
+        {
+            queued[next[a]] = 0;
+        }
+        active.swap(next);
+    }
+    if (active.empty())
+    {
+        return true;
+    }
+
+    if (cycle != nullptr)
+    {
+        // Risalendo size() predecessori da un nodo cambiato all'ultima
+        // passata si finisce dentro il ciclo
+        unsigned int u = active[0];
+        for (unsigned int k = 0; k < gr.size(); k++)
+        {
+            u = static_cast<unsigned int>(result.parent[u]);
+        }
+        cycle->clear();
+        unsigned int v = u;
+        do
+        {
+            cycle->push_back(v);
+            v = static_cast<unsigned int>(result.parent[v]);
+        } while (v != u);
+        std::reverse(cycle->begin(), cycle->end());
+    }
+    return false;
+}
+
+/**
+ * @brief Risultato di floydWarshall
+ */
+template <typename W>
+struct all_pairs_result
+{
+    unsigned int size;       ///< Numero di posizioni (righe e colonne)
+    std::vector<W> distance; ///< Distanze, riga per riga: distance[i * size + j] da i a j
+    bool negativeCycle;      ///< true se il graph ha un ciclo negativo: le distanze non hanno significato
+
+    all_pairs_result() : size(0), distance(), negativeCycle(false){};
+
+    /**
+     * @brief Distanza dalla posizione i alla posizione j
+     */
+    const W &at(unsigned int i, unsigned int j) const
+    {
+        return distance[static_cast<size_t>(i) * size + j];
+    };
+};
+
+/**
+ * @brief Passo di Floyd-Warshall su un blocco, vedi floydWarshall
+ *
+ * Per ogni k del blocco kb e ogni i del blocco ib abbassa la riga i,
+ * ristretta alle Tile colonne del blocco jb, passando per k. Il tratto
+ * della riga k viene copiato in un array locale: il ciclo interno ha
+ * lunghezza fissa, nessun salto e nessun alias, e viene vettorizzato già
+ * con -O2. Con gli interi un valore infinito non fa da scorciatoia.
+ *
+ * @param distance Matrice con righe di stride valori, stride multiplo di Tile
+ */
+template <unsigned int Tile, typename W>
+void floydWarshallTile(W *distance, size_t stride, unsigned int ib, unsigned int jb, unsigned int kb)
+{
+    const W infinity = distance_traits<W>::infinity();
+    W through[Tile];
+    for (unsigned int k = kb * Tile; k < (kb + 1) * Tile; k++)
+    {
+        const W *rowK = distance + k * stride + jb * Tile;
+        for (unsigned int j = 0; j < Tile; j++)
+        {
+            through[j] = rowK[j];
+        }
+        for (unsigned int i = ib * Tile; i < (ib + 1) * Tile; i++)
+        {
+            W *row = distance + i * stride + jb * Tile;
+            const W dik = distance[i * stride + k];
+            if (dik == infinity)
+            {
+                continue;
+            }
+            if (std::numeric_limits<W>::has_infinity)
+            {
+                for (unsigned int j = 0; j < Tile; j++)
+                {
+                    W candidate = dik + through[j];
+                    row[j] = candidate < row[j] ? candidate : row[j];
+                }
+            }
+            else
+            {
+                for (unsigned int j = 0; j < Tile; j++)
+                {
+                    W candidate = dik + through[j];
+                    row[j] = (through[j] != infinity && candidate < row[j]) ? candidate : row[j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Distanze minime tra tutte le coppie (Floyd-Warshall a blocchi)
+ *
+ * La matrice delle distanze, con le righe allungate a un multiplo di 64
+ * valori, viene divisa in blocchi di 64 x 64 che stanno in cache. Per ogni
+ * blocco kb sulla diagonale si aggiorna prima il blocco (kb, kb), poi in
+ * parallelo i blocchi della sua riga e della sua colonna, infine in
+ * parallelo tutti gli altri, che dipendono solo da quelli. Costa O(N^3)
+ * operazioni, divise tra i thread di pool, e N^2 valori W di memoria.
+ *
+ * @param gr graph con pesi
+ * @param pool thread_pool da usare, nullptr per il calcolo seriale
+ *
+ * @return Matrice delle distanze tra posizioni e presenza di cicli negativi
+ */
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+all_pairs_result<typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type::weight_type>
+floydWarshall(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr, thread_pool *pool = nullptr)
+{
+    typedef typename graph<T, Storage, Hash, KeyEqual, Allocator>::storage_type storage_type;
+    typedef typename storage_type::weight_type W;
+    static const unsigned int tile = 64;
+
+    const unsigned int n = gr.slots();
+    const unsigned int blocks = (n + tile - 1) / tile;
+    const size_t stride = static_cast<size_t>(blocks) * tile;
+    const storage_type &storage = gr.adjacency();
+    all_pairs_result<W> result;
+    result.size = n;
+    result.distance.assign(stride * stride, distance_traits<W>::infinity());
+    W *distance = result.distance.data();
+    for (unsigned int i = 0; i < n; i++)
+    {
+        if (!gr.isAlive(i))
+        {
+            continue;
+        }
+        W *row = distance + i * stride;
+        row[i] = W();
+        storage.forEachWeightedSuccessor(i, [row](unsigned int j, const W &w) {
+            if (w < row[j])
+            {
+                row[j] = w;
+            }
+        });
+    }
+
+    for (unsigned int kb = 0; kb < blocks; kb++)
+    {
+        floydWarshallTile<tile>(distance, stride, kb, kb, kb);
+        parallelFor(pool, 2 * static_cast<size_t>(blocks), [&](size_t t) {
+            unsigned int other = static_cast<unsigned int>(t / 2);
+            if (other == kb)
+            {
+                return;
+            }
+            if (t % 2 == 0)
+            {
+                floydWarshallTile<tile>(distance, stride, kb, other, kb);
+            }
+            else
+            {
+                floydWarshallTile<tile>(distance, stride, other, kb, kb);
+            }
+        });
+        parallelFor(pool, static_cast<size_t>(blocks) * blocks, [&](size_t t) {
+            unsigned int ib = static_cast<unsigned int>(t / blocks);
+            unsigned int jb = static_cast<unsigned int>(t % blocks);
+            if (ib != kb && jb != kb)
+            {
+                floydWarshallTile<tile>(distance, stride, ib, jb, kb);
+            }
+        });
+    }
+
+    // Toglie le colonne aggiunte: ogni riga si sposta verso l'inizio
+    for (unsigned int i = 1; i < n && stride != n; i++)
+    {
+        std::copy(distance + i * stride, distance + i * stride + n, distance + static_cast<size_t>(i) * n);
+    }
+    result.distance.resize(static_cast<size_t>(n) * n);
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        if (result.at(i, i) < W())
+        {
+            result.negativeCycle = true;
+            break;
+        }
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,571 @@
+#ifndef SPARSE_ADJACENCY_H
+#define SPARSE_ADJACENCY_H
+
+#include <algorithm> // std::lower_bound, std::swap, std::set_union, ...
+#include <iterator>  // std::back_inserter
+#include <memory>    // std::allocator, std::allocator_traits
+#include <vector>
+#include <stddef.h> // size_t
+#include "adjacency_ranges.h"
+
+/**
+ * @file sparse_adjacency.h
+ * @brief Dichiarazione della classe sparse_adjacency
+ */
+
+/**
+ * @brief Liste di adiacenza ordinate
+ *
+ * Politica di memorizzazione alternativa a dense_bitset per grafi sparsi.
+ * Per ogni nodo conserva la lista ordinata dei successori e quella dei
+ * predecessori, quindi la memoria occupata è O(N + E) invece di O(N^2).
+ * Offre la stessa interfaccia di dense_bitset usata da graph; la riga
+ * index-esima (row) è la lista dei successori del nodo. sparse_adjacency è
+ * la versione con std::allocator.
+ *
+ * @tparam Allocator Allocatore per le liste, passato anche a ogni lista
+ */
+template <typename Allocator = std::allocator<unsigned int> >
+class basic_sparse_adjacency
+{
+public:
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned int> allocator_type;
+    typedef std::vector<unsigned int, allocator_type> row_type;
+
+    /**
+     * @brief La stessa politica con un altro allocatore
+     */
+    template <typename OtherAllocator>
+    struct rebind
+    {
+        typedef basic_sparse_adjacency<
+            typename std::allocator_traits<OtherAllocator>::template rebind_alloc<unsigned int> >
+            other;
+    };
+
+    static const unsigned int discarded = ~0u; ///< Valore di remap per le righe da togliere
+
+    typedef iterator_range<const unsigned int *> successor_range;   ///< Successori di un nodo
+    typedef iterator_range<const unsigned int *> predecessor_range; ///< Predecessori di un nodo
+
+private:
+    // Le liste vengono sempre create da row_type(get_allocator()), così anche
+    // gli allocatori senza costruttore di default le possono contenere
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<row_type> list_allocator;
+    typedef std::vector<row_type, list_allocator> list_type;
+    typedef std::vector<size_t, typename std::allocator_traits<Allocator>::template rebind_alloc<size_t> > count_type;
+
+    list_type _out; ///< Successori di ogni nodo, in ordine crescente
+    list_type _in;  ///< Predecessori di ogni nodo, in ordine crescente
+    size_t _edges;              ///< Numero di archi
+
+public:
+    /**
+     * @brief Costruttore di default
+     *
+     * @post size() == 0
+     */
+    basic_sparse_adjacency() : _out(), _in(), _edges(0){};
+
+    /**
+     * @brief Costruttore con allocatore
+     *
+     * @param alloc Allocatore da usare
+     */
+    explicit basic_sparse_adjacency(const allocator_type &alloc)
+        : _out(list_allocator(alloc)), _in(list_allocator(alloc)), _edges(0){};
+
+    /**
+     * @brief Costruttore secondario
+     *
+     * Crea size nodi senza archi
+     *
+     * @param size Numero di nodi
+     * @param capacity Numero di nodi per cui allocare spazio (almeno size)
+     * @param alloc Allocatore da usare
+     */
+    explicit basic_sparse_adjacency(unsigned int size, unsigned int capacity = 0,
+                                    const allocator_type &alloc = allocator_type())
+        : _out(list_allocator(alloc)), _in(list_allocator(alloc)), _edges(0)
+    {
+        reserve(std::max(size, capacity));
+        _out.resize(size, row_type(alloc));
+        _in.resize(size, row_type(alloc));
+    };
+
+    /**
+     * @brief Copy constructor con allocatore
+     *
+     * @param other sparse_adjacency da copiare
+     * @param alloc Allocatore della copia
+     */
+    basic_sparse_adjacency(const basic_sparse_adjacency &other, const allocator_type &alloc)
+        : _out(list_allocator(alloc)), _in(list_allocator(alloc)), _edges(other._edges)
+    {
+        _out.reserve(other._out.capacity());
+        _in.reserve(other._in.capacity());
+        for (size_t i = 0; i < other._out.size(); i++)
+        {
+            _out.push_back(row_type(other._out[i], alloc));
+            _in.push_back(row_type(other._in[i], alloc));
+        }
+    };
+
+    /**
+     * @brief Scambia lo stato interno con un altro sparse_adjacency
+     *
+     * Scambia anche gli allocatori
+     *
+     * @param other sparse_adjacency sorgente
+     */
+    void swap(basic_sparse_adjacency &other) noexcept
+    {
+        _out.swap(other._out);
+        _in.swap(other._in);
+        std::swap(_edges, other._edges);
+    };
+
+    /**
+     * @brief Getter dell'allocatore
+     */
+    allocator_type get_allocator() const
+    {
+        return allocator_type(_out.get_allocator());
+    };
+
+    /**
+     * @brief Getter del numero di nodi
+     */
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(_out.size());
+    };
+
+    /**
+     * @brief Getter della capacità
+     *
+     * @return Numero di nodi per cui è allocato spazio
+     */
+    unsigned int capacity() const
+    {
+        return static_cast<unsigned int>(std::min(_out.capacity(), _in.capacity()));
+    };
+
+    /**
+     * @brief Getter del numero di archi
+     */
+    size_t edges() const
+    {
+        return _edges;
+    };
+
+    /**
+     * @brief Getter della lista dei successori del nodo index-esimo
+     *
+     * @pre index < size()
+     *
+     * @return Puntatore alla lista ordinata dei successori
+     */
+    const row_type *row(unsigned int index) const
+    {
+        return &_out[index];
+    };
+
+    /**
+     * @brief Getter della lista dei predecessori del nodo index-esimo
+     *
+     * @pre index < size()
+     *
+     * @return Puntatore alla lista ordinata dei predecessori
+     */
+    const row_type *column(unsigned int index) const
+    {
+        return &_in[index];
+    };
+
+    /**
+     * @brief Verifica l'arco (i, j)
+     *
+     * Ricerca binaria nella più corta tra i successori di i e i
+     * predecessori di j.
+     *
+     * @pre i < size() && j < size()
+     *
+     * @return true se l'arco esiste
+     */
+    bool test(unsigned int i, unsigned int j) const
+    {
+        if (_out[i].size() <= _in[j].size())
+        {
+            return contains(_out[i], j);
+        }
+        return contains(_in[j], i);
+    };
+
+    /**
+     * @brief Aggiunge l'arco (i, j)
+     *
+     * @pre i < size() && j < size()
+     */
+    void set(unsigned int i, unsigned int j)
+    {
+        typename row_type::iterator out = std::lower_bound(_out[i].begin(), _out[i].end(), j);
+        if (out != _out[i].end() && *out == j)
+        {
+            return;
+        }
+        typename row_type::iterator in = std::lower_bound(_in[j].begin(), _in[j].end(), i);
+        // Inserisco prima in _in: se _out fallisce annullo l'inserimento
+        in = _in[j].insert(in, i);
+        try
+        {
+            _out[i].insert(out, j);
+        }
+        catch (...)
+        {
+            _in[j].erase(in);
+            throw;
+        }
+        _edges++;
+    };
+
+    /**
+     * @brief Toglie l'arco (i, j)
+     *
+     * @pre i < size() && j < size()
+     */
+    void reset(unsigned int i, unsigned int j)
+    {
+        if (remove(_out[i], j))
+        {
+            remove(_in[j], i);
+            _edges--;
+        }
+    };
+
+    /**
+     * @brief Alloca spazio per almeno capacity nodi
+     *
+     * @param capacity Numero di nodi da poter contenere
+     */
+    void reserve(unsigned int capacity)
+    {
+        _out.reserve(capacity);
+        _in.reserve(capacity);
+    };
+
+    /**
+     * @brief Riduce la capacità al numero di nodi e archi presenti
+     */
+    void shrink_to_fit()
+    {
+        _out.shrink_to_fit();
+        _in.shrink_to_fit();
+        for (unsigned int i = 0; i < size(); i++)
+        {
+            _out[i].shrink_to_fit();
+            _in[i].shrink_to_fit();
+        }
+    };
+
+    /**
+     * @brief Ridimensiona il numero di nodi
+     *
+     * I nuovi nodi non hanno archi; i nodi tolti perdono tutti i loro
+     * archi. Entro la capacità la crescita non alloca.
+     *
+     * @param newSize Nuovo numero di nodi
+     */
+    void resize(unsigned int newSize)
+    {
+        for (unsigned int i = newSize; i < size(); i++)
+        {
+            clear(i);
+        }
+        _out.resize(newSize, row_type(get_allocator()));
+        _in.resize(newSize, row_type(get_allocator()));
+    };
+
+    /**
+     * @brief Toglie tutti gli archi entranti e uscenti da un nodo
+     *
+     * Costa O(somma dei gradi dei vicini). Non lancia eccezioni.
+     *
+     * @param index Nodo da isolare
+     *
+     * @pre index < size()
+     */
+    void clear(unsigned int index)
+    {
+        for (size_t k = 0; k < _out[index].size(); k++)
+        {
+            if (_out[index][k] != index)
+            {
+                remove(_in[_out[index][k]], index);
+            }
+        }
+        for (size_t k = 0; k < _in[index].size(); k++)
+        {
+            if (_in[index][k] != index)
+            {
+                remove(_out[_in[index][k]], index);
+            }
+        }
+        _edges -= _out[index].size() + _in[index].size();
+        if (contains(_out[index], index))
+        {
+            // Il cappio è stato contato due volte
+            _edges++;
+        }
+        row_type(_out[index].get_allocator()).swap(_out[index]);
+        row_type(_in[index].get_allocator()).swap(_in[index]);
+    };
+
+    /**
+     * @brief Compatta i nodi togliendo quelli scartati
+     *
+     * Il nodo i finisce in posizione remap[i]; quelli con
+     * remap[i] == discarded vengono tolti e devono essere già isolati.
+     * La rinumerazione conserva l'ordine, quindi le liste restano
+     * ordinate. Costa O(N + E) e non lancia eccezioni.
+     *
+     * @param remap Nuova posizione di ogni nodo, discarded se da togliere
+     * @param newSize Numero di nodi che restano
+     */
+    void compact(const unsigned int *remap, unsigned int newSize)
+    {
+        for (unsigned int i = 0; i < size(); i++)
+        {
+            if (remap[i] == discarded)
+            {
+                continue;
+            }
+            renumber(_out[i], remap);
+            renumber(_in[i], remap);
+            if (remap[i] != i)
+            {
+                _out[remap[i]].swap(_out[i]);
+                _in[remap[i]].swap(_in[i]);
+            }
+        }
+        _out.resize(newSize, row_type(get_allocator()));
+        _in.resize(newSize, row_type(get_allocator()));
+    };
+
+    /**
+     * @brief Chiama f(j) per ogni successore j di index, in ordine
+     *
+     * @pre index < size()
+     */
+    template <typename F>
+    void forEachSuccessor(unsigned int index, F f) const
+    {
+        for (size_t k = 0; k < _out[index].size(); k++)
+        {
+            f(_out[index][k]);
+        }
+    };
+
+    /**
+     * @brief Successori del nodo index-esimo, in ordine crescente
+     *
+     * @pre index < size()
+     */
+    successor_range successors(unsigned int index) const
+    {
+        const unsigned int *first = _out[index].data();
+        return successor_range(first, first + _out[index].size());
+    };
+
+    /**
+     * @brief Predecessori del nodo index-esimo, in ordine crescente
+     *
+     * @pre index < size()
+     */
+    predecessor_range predecessors(unsigned int index) const
+    {
+        const unsigned int *first = _in[index].data();
+        return predecessor_range(first, first + _in[index].size());
+    };
+
+    /**
+     * @brief Archi invertiti
+     *
+     * Le liste dei successori e dei predecessori si scambiano il ruolo,
+     * quindi basta copiarle. Costa O(N + E).
+     *
+     * @return Liste con ogni arco (i, j) sostituito da (j, i)
+     */
+    basic_sparse_adjacency transpose() const
+    {
+        basic_sparse_adjacency result(0, capacity(), get_allocator());
+        result._out = _in;
+        result._in = _out;
+        result._edges = _edges;
+        return result;
+    };
+
+    /**
+     * @brief Numero di successori del nodo index-esimo
+     *
+     * @pre index < size()
+     */
+    unsigned int outDegree(unsigned int index) const
+    {
+        return static_cast<unsigned int>(_out[index].size());
+    };
+
+    /**
+     * @brief Numero di predecessori del nodo index-esimo
+     *
+     * @pre index < size()
+     */
+    unsigned int inDegree(unsigned int index) const
+    {
+        return static_cast<unsigned int>(_in[index].size());
+    };
+
+    /**
+     * @brief Successori comuni a due nodi, in ordine crescente
+     *
+     * Fusione delle due liste ordinate
+     *
+     * @param out Riceve gli indici dei successori comuni
+     *
+     * @pre i < size() && j < size()
+     */
+    void commonSuccessors(unsigned int i, unsigned int j, std::vector<unsigned int> &out) const
+    {
+        out.clear();
+        std::set_intersection(_out[i].begin(), _out[i].end(), _out[j].begin(), _out[j].end(),
+                              std::back_inserter(out));
+    };
+
+    /**
+     * @brief Aggiunge gli archi di other (unione)
+     *
+     * @pre other.size() == size()
+     */
+    void uniteWith(const basic_sparse_adjacency &other)
+    {
+        combine(other, [](const row_type &a, const row_type &b, row_type &result) {
+            std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        });
+    };
+
+    /**
+     * @brief Tiene solo gli archi presenti anche in other (intersezione)
+     *
+     * @pre other.size() == size()
+     */
+    void intersectWith(const basic_sparse_adjacency &other)
+    {
+        combine(other, [](const row_type &a, const row_type &b, row_type &result) {
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        });
+    };
+
+    /**
+     * @brief Toglie gli archi presenti in other (differenza)
+     *
+     * @pre other.size() == size()
+     */
+    void subtract(const basic_sparse_adjacency &other)
+    {
+        combine(other, [](const row_type &a, const row_type &b, row_type &result) {
+            std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        });
+    };
+
+private:
+    /**
+     * @brief Ricalcola le liste dei successori con op e ricava i predecessori
+     *
+     * Le nuove liste vengono costruite a parte: in caso di eccezione gli
+     * archi restano invariati. Costa O(N + E).
+     */
+    template <typename F>
+    void combine(const basic_sparse_adjacency &other, F op)
+    {
+        // Conservo la capacità, su cui graph conta per non riallocare
+        list_type out(_out.get_allocator());
+        out.reserve(_out.capacity());
+        out.resize(size(), row_type(get_allocator()));
+        count_type inDegree(size(), 0, get_allocator());
+        size_t edges = 0;
+        for (unsigned int i = 0; i < size(); i++)
+        {
+            op(_out[i], other._out[i], out[i]);
+            edges += out[i].size();
+            for (size_t k = 0; k < out[i].size(); k++)
+            {
+                inDegree[out[i][k]]++;
+            }
+        }
+        // Scorrendo le origini in ordine le liste dei predecessori restano ordinate
+        list_type in(_in.get_allocator());
+        in.reserve(_in.capacity());
+        in.resize(size(), row_type(get_allocator()));
+        for (unsigned int j = 0; j < size(); j++)
+        {
+            in[j].reserve(inDegree[j]);
+        }
+        for (unsigned int i = 0; i < size(); i++)
+        {
+            for (size_t k = 0; k < out[i].size(); k++)
+            {
+                in[out[i][k]].push_back(i);
+            }
+        }
+
+        _out.swap(out);
+        _in.swap(in);
+        _edges = edges;
+    };
+
+    /**
+     * @brief Ricerca binaria in una lista ordinata
+     */
+    static bool contains(const row_type &list, unsigned int value)
+    {
+        typename row_type::const_iterator it = std::lower_bound(list.begin(), list.end(), value);
+        return it != list.end() && *it == value;
+    };
+
+    /**
+     * @brief Toglie value da una lista ordinata
+     *
+     * @return true se value era presente
+     */
+    static bool remove(row_type &list, unsigned int value)
+    {
+        typename row_type::iterator it = std::lower_bound(list.begin(), list.end(), value);
+        if (it == list.end() || *it != value)
+        {
+            return false;
+        }
+        list.erase(it);
+        return true;
+    };
+
+    /**
+     * @brief Applica la rinumerazione agli elementi di una lista
+     */
+    static void renumber(row_type &list, const unsigned int *remap)
+    {
+        for (size_t k = 0; k < list.size(); k++)
+        {
+            list[k] = remap[list[k]];
+        }
+    };
+};
+
+template <typename Allocator>
+const unsigned int basic_sparse_adjacency<Allocator>::discarded;
+
+/**
+ * @brief Liste di adiacenza ordinate con std::allocator
+ */
+typedef basic_sparse_adjacency<> sparse_adjacency;
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef STATIC_GRAPH_H
+#define STATIC_GRAPH_H
+
+#include <array>
+#include <stdint.h> // uint64_t
+#include "id_graph.h"
+
+/**
+ * @file static_graph.h
+ * @brief Dichiarazione della classe static_graph
+ */
+
+// std::array è leggibile in un'espressione costante da C++14 e
+// modificabile da C++17: le funzioni diventano constexpr di conseguenza
+#if __cplusplus >= 201402L
+#define STATIC_GRAPH_CONSTEXPR_READ constexpr
+#else
+#define STATIC_GRAPH_CONSTEXPR_READ
+#endif
+#if __cplusplus >= 201703L
+#define STATIC_GRAPH_CONSTEXPR_WRITE constexpr
+#else
+#define STATIC_GRAPH_CONSTEXPR_WRITE
+#endif
+
+/**
+ * @brief Graph con capacità fissa N e nomi che fanno da indice
+ *
+ * Come id_graph i nomi sono le righe della matrice (vedi node_id_traits),
+ * ma la matrice è uno std::array di N righe da wordsPerRow parole dentro
+ * l'oggetto: nessuna allocazione, copia con memcpy e dimensione nota al
+ * compilatore. Le letture sono constexpr da C++14, le modifiche da C++17,
+ * quindi una tabella fissa può essere costruita a tempo di compilazione:
+ *
+ *     constexpr static_graph<8> g = [] { static_graph<8> g; g.addNode(1); return g; }();
+ *
+ * I nomi devono stare tra 0 e N - 1; gli errori lanciano come in graph.
+ *
+ * @tparam N Numero massimo di nodi
+ * @tparam Id Tipo del nome dei nodi, con node_id_traits<Id>::direct
+ */
+template <unsigned int N, typename Id = unsigned int>
+class static_graph
+{
+    static_assert(node_id_traits<Id>::direct, "static_graph richiede nomi interi, enum o un node_id_traits specializzato");
+
+public:
+    typedef uint64_t word_type;
+    static const unsigned int bitsPerWord = 64;                               ///< Bit in una parola
+    static const unsigned int wordsPerRow = (N + bitsPerWord - 1) / bitsPerWord; ///< Parole per riga
+
+private:
+    typedef node_id_traits<Id> traits;
+
+    std::array<word_type, N * wordsPerRow> _words; ///< Matrice di adiacenza, riga per riga
+    std::array<word_type, wordsPerRow> _alive;     ///< Bit i a 1 se il nodo i esiste
+    unsigned int _size;                            ///< Numero di nodi
+
+public:
+    /**
+     * @brief Costruttore di default, senza nodi
+     */
+    constexpr static_graph() : _words(), _alive(), _size(0){};
+
+    /**
+     * @brief Numero massimo di nodi
+     */
+    static constexpr unsigned int capacity()
+    {
+        return N;
+    };
+
+    /**
+     * @brief Numero di nodi
+     */
+    constexpr unsigned int size() const
+    {
+        return _size;
+    };
+
+    /**
+     * @brief Riga index della matrice (wordsPerRow parole)
+     *
+     * @pre index < N
+     */
+    const word_type *row(unsigned int index) const
+    {
+        return _words.data() + static_cast<size_t>(index) * wordsPerRow;
+    };
+
+    /**
+     * @brief true se esiste il nodo id
+     */
+    STATIC_GRAPH_CONSTEXPR_READ bool exists(Id id) const
+    {
+        return traits::toIndex(id) < N && bit(_alive[traits::toIndex(id) / bitsPerWord], traits::toIndex(id));
+    };
+
+    /**
+     * @brief true se esiste l'arco origin -> destination
+     *
+     * Lancia un errore se uno dei nodi non esiste
+     */
+    STATIC_GRAPH_CONSTEXPR_READ bool hasEdge(Id origin, Id destination) const
+    {
+        unsigned int i = existingIndex(origin);
+        unsigned int j = existingIndex(destination);
+        return bit(_words[static_cast<size_t>(i) * wordsPerRow + j / bitsPerWord], j);
+    };
+
+    /**
+     * @brief Numero di successori del nodo id
+     */
+    STATIC_GRAPH_CONSTEXPR_READ unsigned int outDegree(Id id) const
+    {
+        unsigned int i = existingIndex(id);
+        unsigned int degree = 0;
+        for (unsigned int w = 0; w < wordsPerRow; w++)
+        {
+            for (word_type bits = _words[static_cast<size_t>(i) * wordsPerRow + w]; bits != 0; bits &= bits - 1)
+            {
+                degree++;
+            }
+        }
+        return degree;
+    };
+
+    /**
+     * @brief Aggiunge il nodo id
+     *
+     * Lancia un errore se esiste già o se id non è minore di N
+     */
+    STATIC_GRAPH_CONSTEXPR_WRITE void addNode(Id id)
+    {
+        unsigned int index = traits::toIndex(id);
+        if (index >= N || bit(_alive[index / bitsPerWord], index))
+        {
+            throw 1;
+        }
+        _alive[index / bitsPerWord] |= mask(index);
+        _size++;
+    };
+
+    /**
+     * @brief Rimuove il nodo id con i suoi archi
+     *
+     * Lancia un errore se il nodo non esiste. Costa O(N)
+     */
+    STATIC_GRAPH_CONSTEXPR_WRITE void removeNode(Id id)
+    {
+        unsigned int index = existingIndex(id);
+        for (unsigned int w = 0; w < wordsPerRow; w++)
+        {
+            _words[static_cast<size_t>(index) * wordsPerRow + w] = 0;
+        }
+        for (unsigned int i = 0; i < N; i++)
+        {
+            _words[static_cast<size_t>(i) * wordsPerRow + index / bitsPerWord] &= ~mask(index);
+        }
+        _alive[index / bitsPerWord] &= ~mask(index);
+        _size--;
+    };
+
+    /**
+     * @brief Aggiunge l'arco origin -> destination
+     *
+     * Lancia un errore se uno dei nodi non esiste
+     */
+    STATIC_GRAPH_CONSTEXPR_WRITE void addEdge(Id origin, Id destination)
+    {
+        unsigned int i = existingIndex(origin);
+        unsigned int j = existingIndex(destination);
+        _words[static_cast<size_t>(i) * wordsPerRow + j / bitsPerWord] |= mask(j);
+    };
+
+    /**
+     * @brief Rimuove l'arco origin -> destination
+     *
+     * Lancia un errore se uno dei nodi non esiste
+     */
+    STATIC_GRAPH_CONSTEXPR_WRITE void removeEdge(Id origin, Id destination)
+    {
+        unsigned int i = existingIndex(origin);
+        unsigned int j = existingIndex(destination);
+        _words[static_cast<size_t>(i) * wordsPerRow + j / bitsPerWord] &= ~mask(j);
+    };
+
+    /**
+     * @brief Chiama f(Id) per ogni nodo, in ordine crescente
+     */
+    template <typename F>
+    void forEachNode(F f) const
+    {
+        for (unsigned int w = 0; w < wordsPerRow; w++)
+        {
+            for (word_type bits = _alive[w]; bits != 0; bits &= bits - 1)
+            {
+                f(traits::fromIndex(w * bitsPerWord + dense_bitset::countTrailingZeros(bits)));
+            }
+        }
+    };
+
+    /**
+     * @brief Chiama f(Id) per ogni successore del nodo id, in ordine crescente
+     */
+    template <typename F>
+    void forEachSuccessor(Id id, F f) const
+    {
+        const word_type *words = row(existingIndex(id));
+        for (unsigned int w = 0; w < wordsPerRow; w++)
+        {
+            for (word_type bits = words[w]; bits != 0; bits &= bits - 1)
+            {
+                f(traits::fromIndex(w * bitsPerWord + dense_bitset::countTrailingZeros(bits)));
+            }
+        }
+    };
+
+private:
+    /**
+     * @brief Parola con il solo bit della colonna index
+     */
+    static constexpr word_type mask(unsigned int index)
+    {
+        return word_type(1) << (index % bitsPerWord);
+    };
+
+    /**
+     * @brief true se word ha a 1 il bit della colonna index
+     */
+    static constexpr bool bit(word_type word, unsigned int index)
+    {
+        return ((word >> (index % bitsPerWord)) & 1) != 0;
+    };
+
+    /**
+     * @brief Indice di id, lancia un errore se il nodo non esiste
+     */
+    STATIC_GRAPH_CONSTEXPR_READ unsigned int existingIndex(Id id) const
+    {
+        if (!exists(id))
+        {
+            throw 1;
+        }
+        return traits::toIndex(id);
+    };
+};
+
+template <unsigned int N, typename Id>
+const unsigned int static_graph<N, Id>::bitsPerWord;
+
+template <unsigned int N, typename Id>
+const unsigned int static_graph<N, Id>::wordsPerRow;
+
+#endif
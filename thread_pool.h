@@ -0,0 +1,217 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception> // std::exception_ptr
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stddef.h> // size_t
+
+/**
+ * @file thread_pool.h
+ * @brief Dichiarazione della classe thread_pool
+ */
+
+/**
+ * @brief Insieme fisso di thread per eseguire cicli in parallelo
+ *
+ * I thread vengono creati una volta sola nel costruttore e riusati da ogni
+ * chiamata a parallelFor. Il thread chiamante partecipa al lavoro, quindi
+ * un thread_pool di dimensione 1 non crea thread aggiuntivi.
+ *
+ * parallelFor non è rientrante: non va chiamato dall'interno di un corpo
+ * eseguito dallo stesso thread_pool.
+ */
+class thread_pool
+{
+    std::vector<std::thread> _workers;   ///< Thread aggiuntivi
+    std::mutex _mutex;                   ///< Protegge lo stato del lavoro corrente
+    std::condition_variable _wake;       ///< Segnala un nuovo lavoro o la chiusura
+    std::condition_variable _done;       ///< Segnala la fine di un lavoro
+    std::function<void(size_t)> _body;   ///< Corpo del ciclo corrente
+    size_t _count;                       ///< Numero di iterazioni del ciclo corrente
+    std::atomic<size_t> _next;           ///< Prossima iterazione da assegnare
+    unsigned int _generation;            ///< Numero del lavoro corrente
+    unsigned int _active;                ///< Thread aggiuntivi ancora al lavoro
+    std::exception_ptr _error;           ///< Prima eccezione lanciata dal corpo
+    bool _stop;                          ///< true durante la distruzione
+
+public:
+    /**
+     * @brief Costruttore
+     *
+     * @param threads Numero totale di thread, compreso il chiamante
+     *        (0 indica std::thread::hardware_concurrency())
+     */
+    explicit thread_pool(unsigned int threads = 0)
+        : _workers(), _mutex(), _wake(), _done(), _body(), _count(0), _next(0), _generation(0), _active(0),
+          _error(), _stop(false)
+    {
+        if (threads == 0)
+        {
+            threads = std::thread::hardware_concurrency();
+        }
+        for (unsigned int i = 1; i < threads; i++)
+        {
+            _workers.push_back(std::thread(&thread_pool::workerLoop, this));
+        }
+    };
+
+    /**
+     * @brief Distruttore della classe
+     *
+     * Attende la terminazione di tutti i thread
+     */
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (size_t i = 0; i < _workers.size(); i++)
+        {
+            _workers[i].join();
+        }
+    };
+
+    /**
+     * @brief Numero totale di thread, compreso il chiamante
+     */
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(_workers.size()) + 1;
+    };
+
+    /**
+     * @brief Esegue body(i) per ogni i in [0, count)
+     *
+     * Le iterazioni vengono distribuite dinamicamente tra i thread. La
+     * funzione ritorna quando tutte le iterazioni sono terminate; se il
+     * corpo lancia un'eccezione, la prima viene rilanciata al chiamante.
+     *
+     * @param count Numero di iterazioni
+     * @param body Corpo del ciclo
+     */
+    template <typename F>
+    void parallelFor(size_t count, F body)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        if (_workers.empty() || count == 1)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                body(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _body = body;
+            _count = count;
+            _next.store(0);
+            _error = std::exception_ptr();
+            _active = static_cast<unsigned int>(_workers.size());
+            _generation++;
+        }
+        _wake.notify_all();
+
+        runIterations();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _active == 0; });
+        _body = std::function<void(size_t)>();
+        if (_error)
+        {
+            std::exception_ptr error = _error;
+            _error = std::exception_ptr();
+            std::rethrow_exception(error);
+        }
+    };
+
+private:
+    thread_pool(const thread_pool &);
+    thread_pool &operator=(const thread_pool &);
+
+    /**
+     * @brief Esegue iterazioni finché ce ne sono da assegnare
+     */
+    void runIterations()
+    {
+        for (size_t i = _next.fetch_add(1); i < _count; i = _next.fetch_add(1))
+        {
+            try
+            {
+                _body(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_error)
+                {
+                    _error = std::current_exception();
+                }
+                // Salto le iterazioni rimaste
+                _next.store(_count);
+            }
+        }
+    };
+
+    /**
+     * @brief Ciclo dei thread aggiuntivi
+     */
+    void workerLoop()
+    {
+        unsigned int seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this, seen] { return _stop || _generation != seen; });
+                if (_stop)
+                {
+                    return;
+                }
+                seen = _generation;
+            }
+
+            runIterations();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_active == 0)
+            {
+                _done.notify_all();
+            }
+        }
+    };
+};
+
+/**
+ * @brief Esegue body(i) per ogni i in [0, count), in parallelo se pool non è nullo
+ *
+ * @param pool thread_pool da usare, nullptr per eseguire nel thread chiamante
+ * @param count Numero di iterazioni
+ * @param body Corpo del ciclo
+ */
+template <typename F>
+void parallelFor(thread_pool *pool, size_t count, F body)
+{
+    if (pool == nullptr)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            body(i);
+        }
+        return;
+    }
+    pool->parallelFor(count, body);
+}
+
+#endif
@@ -0,0 +1,449 @@
+#ifndef VERSIONED_GRAPH_H
+#define VERSIONED_GRAPH_H
+
+#include <functional> // std::hash, std::equal_to
+#include <utility> // std::swap
+#include <vector>
+#include <stddef.h> // size_t
+#include "cow_array.h"
+#include "dense_bitset.h"
+#include "node_index.h"
+
+/**
+ * @file versioned_graph.h
+ * @brief Dichiarazione della classe versioned_graph
+ */
+
+template <typename T, typename Storage, typename Hash, typename KeyEqual, typename Allocator>
+class graph;
+
+/**
+ * @brief Graph con fotografie in O(1) e copia alla scrittura per blocchi
+ *
+ * Nomi, flag di vita, indice hash e matrice di adiacenza sono cow_array:
+ * snapshot() (come il copy constructor) costa O(1) e condivide tutti i
+ * blocchi con il graph. Una modifica successiva copia solo i blocchi che
+ * tocca (4 KiB di matrice, 512 nomi o bucket), quindi il graph e le sue
+ * fotografie occupano la memoria dei soli blocchi diversi. I blocchi di una
+ * versione vecchia vengono liberati quando l'ultima fotografia che li usa
+ * viene distrutta.
+ *
+ * Come in concurrent_graph, le posizioni dei nodi rimossi vengono
+ * recuperate quando la capacità è esaurita (o con compact()), copiando i
+ * nodi vivi in strutture nuove.
+ *
+ * Una fotografia si può leggere da un altro thread mentre il graph viene
+ * modificato; la fotografia va presa dal thread che modifica il graph.
+ *
+ * @tparam T Tipo del nome dei nodi
+ * @tparam Hash Funtore di hash su T
+ * @tparam KeyEqual Funtore di uguaglianza su T
+ */
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T> >
+class versioned_graph
+{
+public:
+    typedef dense_bitset::word_type word_type;
+
+private:
+    typedef node_index<T, Hash, KeyEqual> index_type;
+
+    cow_array<T> _names;               ///< Nome di ogni posizione
+    cow_array<unsigned char> _alive;   ///< 1 se la posizione contiene un nodo
+    cow_array<unsigned int> _buckets;  ///< Indice dei nomi (posizione + 1, 0 se vuoto)
+    cow_array<word_type> _words;       ///< Matrice di adiacenza, riga per riga
+    unsigned int _capacity;            ///< Posizioni disponibili
+    unsigned int _wordsPerRow;         ///< Parole per riga della matrice
+    unsigned int _slots;               ///< Posizioni usate
+    unsigned int _size;                ///< Nodi vivi
+    Hash _hash;                        ///< Funtore di hash
+    KeyEqual _equal;                   ///< Funtore di uguaglianza
+
+public:
+    /**
+     * @brief Costruttore di default
+     *
+     * @param hash Funtore di hash
+     * @param equal Funtore di uguaglianza
+     */
+    explicit versioned_graph(const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual())
+        : _names(), _alive(), _buckets(), _words(), _capacity(0), _wordsPerRow(0), _slots(0), _size(0), _hash(hash),
+          _equal(equal)
+    {
+        allocate(16);
+    };
+
+    /**
+     * @brief Costruttore da graph
+     *
+     * Copia i nodi vivi e gli archi di gr, in O(N^2 / 64 + E)
+     *
+     * @param gr graph da copiare
+     */
+    template <typename Storage, typename Allocator>
+    explicit versioned_graph(const graph<T, Storage, Hash, KeyEqual, Allocator> &gr)
+        : _names(), _alive(), _buckets(), _words(), _capacity(0), _wordsPerRow(0), _slots(0), _size(0),
+          _hash(gr.hashFunction()), _equal(gr.keyEqual())
+    {
+        allocate(index_type::capacityFor(gr.size()));
+        std::vector<unsigned int> remap(gr.slots(), dense_bitset::discarded);
+        for (unsigned int i = 0; i < gr.slots(); i++)
+        {
+            if (gr.isAlive(i))
+            {
+                remap[i] = publish(gr.nodeFromIndex(i).name);
+            }
+        }
+        for (unsigned int i = 0; i < gr.slots(); i++)
+        {
+            if (remap[i] != dense_bitset::discarded)
+            {
+                gr.adjacency().forEachSuccessor(i, [&](unsigned int j) { setBit(remap[i], remap[j]); });
+            }
+        }
+    };
+
+    /**
+     * @brief Fotografia del graph in questo momento
+     *
+     * Costa O(1): la fotografia condivide tutti i blocchi con il graph e le
+     * modifiche successive del graph non la toccano
+     */
+    versioned_graph snapshot() const
+    {
+        return *this;
+    };
+
+    /**
+     * @brief Scambia lo stato interno con un altro versioned_graph
+     */
+    void swap(versioned_graph &other) noexcept
+    {
+        _names.swap(other._names);
+        _alive.swap(other._alive);
+        _buckets.swap(other._buckets);
+        _words.swap(other._words);
+        std::swap(_capacity, other._capacity);
+        std::swap(_wordsPerRow, other._wordsPerRow);
+        std::swap(_slots, other._slots);
+        std::swap(_size, other._size);
+        std::swap(_hash, other._hash);
+        std::swap(_equal, other._equal);
+    };
+
+    /**
+     * @brief Getter del numero di nodi
+     */
+    unsigned int size() const
+    {
+        return _size;
+    };
+
+    /**
+     * @brief Funzione per aggiungere un nodo
+     *
+     * Lancia un errore se il nodo esiste già. Se la capacità è esaurita i
+     * nodi vivi vengono copiati in strutture nuove.
+     *
+     * @param node_name Nodo da aggiungere
+     */
+    void addNode(const T &node_name)
+    {
+        if (exists(node_name))
+        {
+            throw 1;
+        }
+        if (_slots == _capacity)
+        {
+            rebuild(index_type::capacityFor(_size + 1));
+        }
+        publish(node_name);
+    };
+
+    /**
+     * @brief Funzione per rimuovere un nodo
+     *
+     * Azzera la riga e la colonna del nodo copiando solo i blocchi che
+     * contengono archi. Lancia un errore se il nodo non esiste.
+     *
+     * @param node_name Nodo da rimuovere
+     */
+    void removeNode(const T &node_name)
+    {
+        int i = indexOf(node_name);
+        if (i == -1)
+        {
+            throw 1;
+        }
+        for (unsigned int w = 0; w < _wordsPerRow; w++)
+        {
+            if (_words[wordIndex(i, w * dense_bitset::bitsPerWord)] != 0)
+            {
+                _words.mutate(wordIndex(i, w * dense_bitset::bitsPerWord)) = 0;
+            }
+        }
+        for (unsigned int r = 0; r < _slots; r++)
+        {
+            if (test(r, i))
+            {
+                _words.mutate(wordIndex(r, i)) &= ~bitFor(i);
+            }
+        }
+        _alive.mutate(i) = 0;
+        _size--;
+    };
+
+    /**
+     * @brief Funzione per aggiungere archi
+     *
+     * Lancia un errore se uno dei due nodi non esiste
+     */
+    void addEdge(const T &origin_node, const T &destination_node)
+    {
+        int i = indexOf(origin_node);
+        int j = indexOf(destination_node);
+        if (i == -1 || j == -1)
+        {
+            throw 1;
+        }
+        if (!test(i, j))
+        {
+            setBit(i, j);
+        }
+    };
+
+    /**
+     * @brief Funzione per rimuovere archi
+     *
+     * Lancia un errore se uno dei due nodi non esiste
+     */
+    void removeEdge(const T &origin_node, const T &destination_node)
+    {
+        int i = indexOf(origin_node);
+        int j = indexOf(destination_node);
+        if (i == -1 || j == -1)
+        {
+            throw 1;
+        }
+        if (test(i, j))
+        {
+            _words.mutate(wordIndex(i, j)) &= ~bitFor(j);
+        }
+    };
+
+    /**
+     * @brief Funzione per verificare l'esistenza di un nodo
+     */
+    bool exists(const T &node_name) const
+    {
+        return indexOf(node_name) != -1;
+    };
+
+    /**
+     * @brief Funzione per verificare l'esistenza di un arco
+     *
+     * Lancia un errore se uno dei due nodi non esiste
+     */
+    bool hasEdge(const T &origin_node, const T &destination_node) const
+    {
+        int i = indexOf(origin_node);
+        int j = indexOf(destination_node);
+        if (i == -1 || j == -1)
+        {
+            throw 1;
+        }
+        return test(i, j);
+    };
+
+    /**
+     * @brief Chiama f(nome) per ogni nodo, in ordine di posizione
+     */
+    template <typename F>
+    void forEachNode(F f) const
+    {
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            if (_alive[i])
+            {
+                f(_names[i]);
+            }
+        }
+    };
+
+    /**
+     * @brief Chiama f(nome) per ogni successore di un nodo
+     *
+     * Lancia un errore se il nodo non esiste
+     */
+    template <typename F>
+    void forEachSuccessor(const T &node_name, F f) const
+    {
+        int i = indexOf(node_name);
+        if (i == -1)
+        {
+            throw 1;
+        }
+        for (unsigned int w = 0; w < _wordsPerRow; w++)
+        {
+            word_type bits = _words[wordIndex(i, w * dense_bitset::bitsPerWord)];
+            while (bits != 0)
+            {
+                f(_names[w * dense_bitset::bitsPerWord + dense_bitset::countTrailingZeros(bits)]);
+                bits &= bits - 1;
+            }
+        }
+    };
+
+    /**
+     * @brief Garantisce spazio per count nodi senza ricostruire le strutture
+     */
+    void reserve(unsigned int count)
+    {
+        if (count > _size && _capacity - _slots < count - _size)
+        {
+            rebuild(index_type::capacityFor(count));
+        }
+    };
+
+    /**
+     * @brief Recupera le posizioni dei nodi rimossi
+     *
+     * Le fotografie prese prima continuano a usare le strutture vecchie
+     */
+    void compact()
+    {
+        if (_slots != _size)
+        {
+            rebuild(_capacity);
+        }
+    };
+
+    /**
+     * @brief Numero di blocchi della matrice condivisi con altre fotografie
+     */
+    size_t sharedMatrixBlocks() const
+    {
+        return _words.sharedBlocks();
+    };
+
+private:
+    /**
+     * @brief Posizione di un nodo vivo, -1 se non esiste
+     *
+     * I bucket dei nodi rimossi restano nell'indice e vengono saltati
+     */
+    int indexOf(const T &node_name) const
+    {
+        return index_type::probe(node_name, static_cast<unsigned int>(_buckets.size()), _hash,
+                                 [this](unsigned int b) { return _buckets[b]; },
+                                 [&](unsigned int p) { return _alive[p] && _equal(_names[p], node_name); });
+    };
+
+    size_t wordIndex(unsigned int i, unsigned int j) const
+    {
+        return static_cast<size_t>(i) * _wordsPerRow + j / dense_bitset::bitsPerWord;
+    };
+
+    static word_type bitFor(unsigned int j)
+    {
+        return word_type(1) << (j % dense_bitset::bitsPerWord);
+    };
+
+    bool test(unsigned int i, unsigned int j) const
+    {
+        return (_words[wordIndex(i, j)] & bitFor(j)) != 0;
+    };
+
+    void setBit(unsigned int i, unsigned int j)
+    {
+        _words.mutate(wordIndex(i, j)) |= bitFor(j);
+    };
+
+    /**
+     * @brief Sostituisce le strutture con strutture vuote di capacity posizioni
+     */
+    void allocate(unsigned int capacity)
+    {
+        cow_array<T> names(capacity);
+        cow_array<unsigned char> alive(capacity, 0);
+        cow_array<unsigned int> buckets(index_type::capacityFor(capacity), 0);
+        cow_array<word_type> words(static_cast<size_t>(capacity) * dense_bitset::wordsFor(capacity), 0);
+
+        _names.swap(names);
+        _alive.swap(alive);
+        _buckets.swap(buckets);
+        _words.swap(words);
+        _capacity = capacity;
+        _wordsPerRow = dense_bitset::wordsFor(capacity);
+        _slots = 0;
+        _size = 0;
+    };
+
+    /**
+     * @brief Scrive un nodo nella prima posizione libera
+     *
+     * @pre _slots < _capacity
+     *
+     * @return Posizione del nodo
+     */
+    unsigned int publish(const T &node_name)
+    {
+        unsigned int pos = _slots;
+        _names.mutate(pos) = node_name;
+        _alive.mutate(pos) = 1;
+        unsigned int b = index_type::freeBucket(node_name, static_cast<unsigned int>(_buckets.size()), _hash,
+                                                [this](unsigned int b) { return _buckets[b]; });
+        _buckets.mutate(b) = pos + 1;
+        _slots++;
+        _size++;
+        return pos;
+    };
+
+    /**
+     * @brief Copia i nodi vivi in strutture nuove di capacity posizioni
+     *
+     * In caso di eccezione il graph resta invariato
+     */
+    void rebuild(unsigned int capacity)
+    {
+        versioned_graph fresh(_hash, _equal);
+        fresh.allocate(capacity);
+        std::vector<unsigned int> remap(_slots, dense_bitset::discarded);
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            if (_alive[i])
+            {
+                remap[i] = fresh.publish(_names[i]);
+            }
+        }
+        for (unsigned int i = 0; i < _slots; i++)
+        {
+            if (remap[i] == dense_bitset::discarded)
+            {
+                continue;
+            }
+            for (unsigned int w = 0; w < _wordsPerRow; w++)
+            {
+                word_type bits = _words[wordIndex(i, w * dense_bitset::bitsPerWord)];
+                while (bits != 0)
+                {
+                    unsigned int j = w * dense_bitset::bitsPerWord + dense_bitset::countTrailingZeros(bits);
+                    bits &= bits - 1;
+                    fresh.setBit(remap[i], remap[j]);
+                }
+            }
+        }
+        swap(fresh);
+    };
+};
+
+/**
+ * @brief Scambia due versioned_graph
+ */
+template <typename T, typename Hash, typename KeyEqual>
+void swap(versioned_graph<T, Hash, KeyEqual> &first, versioned_graph<T, Hash, KeyEqual> &second) noexcept
+{
+    first.swap(second);
+}
+
+#endif
@@ -0,0 +1,817 @@
+#ifndef WEIGHTED_ADJACENCY_H
+#define WEIGHTED_ADJACENCY_H
+
+#include <algorithm> // std::lower_bound, std::max, std::min
+#include <memory>    // std::allocator, std::allocator_traits
+#include <vector>
+#include <type_traits> // std::integral_constant
+#include <utility>     // std::move, std::swap
+#include <stddef.h>    // size_t
+#include "dense_bitset.h"
+#include "sparse_adjacency.h"
+
+/**
+ * @file weighted_adjacency.h
+ * @brief Politiche di memorizzazione con un peso per arco
+ *
+ * dense_weights e sparse_weights offrono l'interfaccia di dense_bitset e
+ * sparse_adjacency usata da graph, più un valore di tipo W per ogni arco:
+ *
+ *     graph<std::string, dense_weights<double> > rete;
+ *     rete.addEdge("a", "b", 2.5);
+ *
+ * Un arco aggiunto senza peso vale W(1), quindi le distanze sui graph senza
+ * pesi contano gli archi. Gli operatori |=, &= e -= di graph non sono
+ * disponibili: non saprebbero che peso dare agli archi uniti.
+ */
+
+/**
+ * @brief Pesi in una matrice contigua accanto alla matrice di bit
+ *
+ * Gli archi restano in un dense_bitset, che risponde a test, successori e
+ * predecessori come nel graph senza pesi; i pesi stanno in una matrice di
+ * W con una riga per nodo, lunga quanto la capacità, così weightRow(i) è
+ * un array contiguo su cui lavorano direttamente gli algoritmi (vedi
+ * shortest_paths.h). Il peso di una coppia senza arco non è definito.
+ * Occupa capacity()^2 valori W oltre ai bit.
+ *
+ * @tparam W Tipo del peso
+ * @tparam Allocator Allocatore per pesi e bit
+ */
+template <typename W, typename Allocator = std::allocator<W> >
+class dense_weights
+{
+public:
+    typedef W weight_type;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<W> allocator_type;
+    typedef basic_dense_bitset<typename std::allocator_traits<Allocator>::template rebind_alloc<uint64_t> > bits_type;
+    typedef typename bits_type::word_type word_type;
+    typedef typename bits_type::row_type row_type;
+    typedef typename bits_type::successor_range successor_range;
+    typedef typename bits_type::predecessor_range predecessor_range;
+
+    /**
+     * @brief La stessa politica con un altro allocatore
+     */
+    template <typename OtherAllocator>
+    struct rebind
+    {
+        typedef dense_weights<W, OtherAllocator> other;
+    };
+
+    static const unsigned int bitsPerWord = bits_type::bitsPerWord; ///< Bit contenuti in una parola
+    static const unsigned int discarded = bits_type::discarded;     ///< Valore di remap per le righe da togliere
+
+private:
+    typedef std::vector<W, allocator_type> value_type;
+
+    bits_type _bits;    ///< Archi
+    value_type _values; ///< Pesi, capacity() x capacity()
+
+public:
+    /**
+     * @brief Costruttore di default
+     */
+    dense_weights() : _bits(), _values(){};
+
+    /**
+     * @brief Costruttore con allocatore
+     */
+    explicit dense_weights(const allocator_type &alloc)
+        : _bits(typename bits_type::allocator_type(alloc)), _values(alloc){};
+
+    /**
+     * @brief Costruttore secondario
+     *
+     * Crea size nodi senza archi
+     *
+     * @param size Numero di nodi
+     * @param capacity Numero di nodi per cui allocare spazio (almeno size)
+     * @param alloc Allocatore da usare
+     */
+    explicit dense_weights(unsigned int size, unsigned int capacity = 0, const allocator_type &alloc = allocator_type())
+        : _bits(size, capacity, typename bits_type::allocator_type(alloc)),
+          _values(static_cast<size_t>(_bits.capacity()) * _bits.capacity(), W(), alloc){};
+
+    /**
+     * @brief Copy constructor con allocatore
+     *
+     * Come per dense_bitset la copia ha capacità pari alla dimensione
+     */
+    dense_weights(const dense_weights &other, const allocator_type &alloc)
+        : _bits(other._bits, typename bits_type::allocator_type(alloc)),
+          _values(static_cast<size_t>(other.size()) * other.size(), W(), alloc)
+    {
+        copyValues(other, other.size());
+    };
+
+    dense_weights(const dense_weights &other)
+        : dense_weights(other, std::allocator_traits<allocator_type>::select_on_container_copy_construction(
+                                   other._values.get_allocator())){};
+
+    /**
+     * @brief Operatore di assegnamento
+     */
+    dense_weights &operator=(const dense_weights &other)
+    {
+        if (this != &other)
+        {
+            dense_weights tmp(other, get_allocator());
+            tmp.swap(*this);
+        }
+        return *this;
+    };
+
+    /**
+     * @brief Scambia lo stato interno con un altro dense_weights
+     */
+    void swap(dense_weights &other) noexcept
+    {
+        _bits.swap(other._bits);
+        _values.swap(other._values);
+    };
+
+    allocator_type get_allocator() const
+    {
+        return _values.get_allocator();
+    };
+
+    unsigned int size() const
+    {
+        return _bits.size();
+    };
+
+    unsigned int capacity() const
+    {
+        return _bits.capacity();
+    };
+
+    unsigned int wordsPerRow() const
+    {
+        return _bits.wordsPerRow();
+    };
+
+    /**
+     * @brief Matrice di bit degli archi
+     */
+    const bits_type &bits() const
+    {
+        return _bits;
+    };
+
+    const word_type *row(unsigned int index) const
+    {
+        return _bits.row(index);
+    };
+
+    bool test(unsigned int i, unsigned int j) const
+    {
+        return _bits.test(i, j);
+    };
+
+    /**
+     * @brief Aggiunge l'arco (i, j) con peso W(1), se non c'è già
+     *
+     * @pre i < size() && j < size()
+     */
+    void set(unsigned int i, unsigned int j)
+    {
+        if (!_bits.test(i, j))
+        {
+            set(i, j, W(1));
+        }
+    };
+
+    /**
+     * @brief Aggiunge l'arco (i, j) o ne cambia il peso
+     *
+     * @pre i < size() && j < size()
+     */
+    void set(unsigned int i, unsigned int j, const W &weight)
+    {
+        _values[position(i, j)] = weight;
+        _bits.set(i, j);
+    };
+
+    void reset(unsigned int i, unsigned int j)
+    {
+        _bits.reset(i, j);
+    };
+
+    /**
+     * @brief Peso dell'arco (i, j)
+     *
+     * @pre test(i, j)
+     */
+    const W &weight(unsigned int i, unsigned int j) const
+    {
+        return _values[position(i, j)];
+    };
+
+    /**
+     * @brief Pesi della riga index, validi dove row(index) ha un bit a 1
+     *
+     * @pre index < size()
+     */
+    const W *weightRow(unsigned int index) const
+    {
+        return _values.data() + static_cast<size_t>(index) * capacity();
+    };
+
+    /**
+     * @brief Chiama f(j, peso) per ogni successore j di index, in ordine
+     *
+     * @pre index < size()
+     */
+    template <typename F>
+    void forEachWeightedSuccessor(unsigned int index, F f) const
+    {
+        const W *weights = weightRow(index);
+        _bits.forEachSuccessor(index, [&f, weights](unsigned int j) { f(j, weights[j]); });
+    };
+
+    /**
+     * @brief Alloca spazio per almeno capacity nodi
+     *
+     * In caso di eccezione gli archi restano invariati
+     */
+    void reserve(unsigned int capacity)
+    {
+        if (capacity <= this->capacity())
+        {
+            return;
+        }
+        value_type values(static_cast<size_t>(capacity) * capacity, W(), _values.get_allocator());
+        copyValuesTo(values, capacity);
+        _bits.reserve(capacity);
+        _values.swap(values);
+    };
+
+    /**
+     * @brief Riduce la capacità al numero di nodi
+     *
+     * In caso di eccezione gli archi restano invariati
+     */
+    void shrink_to_fit()
+    {
+        if (capacity() == size())
+        {
+            _bits.shrink_to_fit();
+            return;
+        }
+        value_type values(static_cast<size_t>(size()) * size(), W(), _values.get_allocator());
+        copyValuesTo(values, size());
+        _bits.shrink_to_fit();
+        _values.swap(values);
+    };
+
+    /**
+     * @brief Ridimensiona il numero di nodi, vedi dense_bitset::resize
+     */
+    void resize(unsigned int newSize)
+    {
+        if (newSize > capacity())
+        {
+            reserve(std::max(newSize, capacity() * 2));
+        }
+        _bits.resize(newSize);
+    };
+
+    void clear(unsigned int index)
+    {
+        _bits.clear(index);
+    };
+
+    /**
+     * @brief Compatta i nodi, vedi dense_bitset::compact
+     *
+     * I pesi si spostano sul posto: ogni valore va in una posizione non
+     * successiva, quindi scorrendo in ordine non si sovrascrive niente che
+     * debba ancora essere letto.
+     */
+    void compact(const unsigned int *remap, unsigned int newSize)
+    {
+        const unsigned int oldSize = size();
+        _bits.compact(remap, newSize);
+        for (unsigned int i = 0; i < oldSize; i++)
+        {
+            if (remap[i] == discarded)
+            {
+                continue;
+            }
+            W *to = _values.data() + static_cast<size_t>(remap[i]) * capacity();
+            W *from = _values.data() + static_cast<size_t>(i) * capacity();
+            for (unsigned int j = 0; j < oldSize; j++)
+            {
+                if (remap[j] != discarded && (remap[i] != i || remap[j] != j))
+                {
+                    to[remap[j]] = std::move(from[j]);
+                }
+            }
+        }
+    };
+
+    template <typename F>
+    void forEachSuccessor(unsigned int index, F f) const
+    {
+        _bits.forEachSuccessor(index, f);
+    };
+
+    successor_range successors(unsigned int index) const
+    {
+        return _bits.successors(index);
+    };
+
+    predecessor_range predecessors(unsigned int index) const
+    {
+        return _bits.predecessors(index);
+    };
+
+    /**
+     * @brief Archi invertiti, ognuno con il suo peso
+     *
+     * I pesi vengono trasposti per blocchi di 32 x 32, come i bit
+     */
+    dense_weights transpose() const
+    {
+        const unsigned int block = 32;
+        dense_weights result(get_allocator());
+        bits_type bits = _bits.transpose();
+        value_type values(_values.size(), W(), _values.get_allocator());
+        const unsigned int n = size();
+        const size_t stride = capacity();
+        for (unsigned int ib = 0; ib < n; ib += block)
+        {
+            for (unsigned int jb = 0; jb < n; jb += block)
+            {
+                for (unsigned int i = ib; i < std::min(n, ib + block); i++)
+                {
+                    for (unsigned int j = jb; j < std::min(n, jb + block); j++)
+                    {
+                        values[j * stride + i] = _values[i * stride + j];
+                    }
+                }
+            }
+        }
+        result._bits.swap(bits);
+        result._values.swap(values);
+        return result;
+    };
+
+    unsigned int outDegree(unsigned int index) const
+    {
+        return _bits.outDegree(index);
+    };
+
+    unsigned int inDegree(unsigned int index) const
+    {
+        return _bits.inDegree(index);
+    };
+
+    void commonSuccessors(unsigned int i, unsigned int j, std::vector<unsigned int> &out) const
+    {
+        _bits.commonSuccessors(i, j, out);
+    };
+
+private:
+    size_t position(unsigned int i, unsigned int j) const
+    {
+        return static_cast<size_t>(i) * capacity() + j;
+    };
+
+    /**
+     * @brief Copia i primi count x count pesi di other in righe lunghe count
+     */
+    void copyValues(const dense_weights &other, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            std::copy(other.weightRow(i), other.weightRow(i) + count, _values.begin() + static_cast<size_t>(i) * count);
+        }
+    };
+
+    /**
+     * @brief Copia i pesi dei nodi presenti in values, con righe lunghe stride
+     */
+    void copyValuesTo(value_type &values, unsigned int stride) const
+    {
+        for (unsigned int i = 0; i < size(); i++)
+        {
+            std::copy(weightRow(i), weightRow(i) + size(), values.begin() + static_cast<size_t>(i) * stride);
+        }
+    };
+};
+
+template <typename W, typename Allocator>
+const unsigned int dense_weights<W, Allocator>::bitsPerWord;
+
+template <typename W, typename Allocator>
+const unsigned int dense_weights<W, Allocator>::discarded;
+
+/**
+ * @brief Pesi accanto alle liste ordinate dei successori
+ *
+ * Gli archi restano in uno sparse_adjacency; per ogni nodo un array di W
+ * lungo quanto la lista dei successori contiene, nella stessa posizione,
+ * il peso dell'arco verso ciascuno, così successors(i) e weightRow(i) si
+ * scorrono insieme. Memoria O(N + E).
+ *
+ * @tparam W Tipo del peso
+ * @tparam Allocator Allocatore per pesi e liste
+ */
+template <typename W, typename Allocator = std::allocator<W> >
+class sparse_weights
+{
+public:
+    typedef W weight_type;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<W> allocator_type;
+    typedef basic_sparse_adjacency<typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned int> >
+        lists_type;
+    typedef typename lists_type::row_type row_type;
+    typedef typename lists_type::successor_range successor_range;
+    typedef typename lists_type::predecessor_range predecessor_range;
+
+    /**
+     * @brief La stessa politica con un altro allocatore
+     */
+    template <typename OtherAllocator>
+    struct rebind
+    {
+        typedef sparse_weights<W, OtherAllocator> other;
+    };
+
+    static const unsigned int discarded = lists_type::discarded; ///< Valore di remap per le righe da togliere
+
+private:
+    typedef std::vector<W, allocator_type> weight_row;
+    typedef std::vector<weight_row, typename std::allocator_traits<Allocator>::template rebind_alloc<weight_row> >
+        weight_list;
+
+    lists_type _lists;    ///< Archi
+    weight_list _weights; ///< Pesi, allineati ai successori
+
+public:
+    sparse_weights() : _lists(), _weights(){};
+
+    explicit sparse_weights(const allocator_type &alloc)
+        : _lists(typename lists_type::allocator_type(alloc)), _weights(typename weight_list::allocator_type(alloc)){};
+
+    /**
+     * @brief Costruttore secondario
+     *
+     * Crea size nodi senza archi
+     */
+    explicit sparse_weights(unsigned int size, unsigned int capacity = 0, const allocator_type &alloc = allocator_type())
+        : _lists(size, capacity, typename lists_type::allocator_type(alloc)),
+          _weights(typename weight_list::allocator_type(alloc))
+    {
+        _weights.reserve(std::max(size, capacity));
+        _weights.resize(size, weight_row(alloc));
+    };
+
+    sparse_weights(const sparse_weights &other, const allocator_type &alloc)
+        : _lists(other._lists, typename lists_type::allocator_type(alloc)),
+          _weights(typename weight_list::allocator_type(alloc))
+    {
+        _weights.reserve(other._weights.capacity());
+        for (size_t i = 0; i < other._weights.size(); i++)
+        {
+            _weights.push_back(weight_row(other._weights[i], alloc));
+        }
+    };
+
+    sparse_weights(const sparse_weights &other)
+        : sparse_weights(other, std::allocator_traits<allocator_type>::select_on_container_copy_construction(
+                                    other.get_allocator())){};
+
+    sparse_weights &operator=(const sparse_weights &other)
+    {
+        if (this != &other)
+        {
+            sparse_weights tmp(other, get_allocator());
+            tmp.swap(*this);
+        }
+        return *this;
+    };
+
+    void swap(sparse_weights &other) noexcept
+    {
+        _lists.swap(other._lists);
+        _weights.swap(other._weights);
+    };
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(_lists.get_allocator());
+    };
+
+    unsigned int size() const
+    {
+        return _lists.size();
+    };
+
+    unsigned int capacity() const
+    {
+        return _lists.capacity();
+    };
+
+    size_t edges() const
+    {
+        return _lists.edges();
+    };
+
+    /**
+     * @brief Liste degli archi
+     */
+    const lists_type &lists() const
+    {
+        return _lists;
+    };
+
+    const row_type *row(unsigned int index) const
+    {
+        return _lists.row(index);
+    };
+
+    const row_type *column(unsigned int index) const
+    {
+        return _lists.column(index);
+    };
+
+    bool test(unsigned int i, unsigned int j) const
+    {
+        return _lists.test(i, j);
+    };
+
+    /**
+     * @brief Aggiunge l'arco (i, j) con peso W(1), se non c'è già
+     */
+    void set(unsigned int i, unsigned int j)
+    {
+        if (!_lists.test(i, j))
+        {
+            set(i, j, W(1));
+        }
+    };
+
+    /**
+     * @brief Aggiunge l'arco (i, j) o ne cambia il peso
+     *
+     * In caso di eccezione gli archi restano invariati
+     */
+    void set(unsigned int i, unsigned int j, const W &weight)
+    {
+        size_t k = find(i, j);
+        if (k < _lists.row(i)->size() && (*_lists.row(i))[k] == j)
+        {
+            _weights[i][k] = weight;
+            return;
+        }
+        typename weight_row::iterator inserted = _weights[i].insert(_weights[i].begin() + k, weight);
+        try
+        {
+            _lists.set(i, j);
+        }
+        catch (...)
+        {
+            _weights[i].erase(inserted);
+            throw;
+        }
+    };
+
+    void reset(unsigned int i, unsigned int j)
+    {
+        size_t k = find(i, j);
+        if (k < _lists.row(i)->size() && (*_lists.row(i))[k] == j)
+        {
+            _lists.reset(i, j);
+            _weights[i].erase(_weights[i].begin() + k);
+        }
+    };
+
+    /**
+     * @brief Peso dell'arco (i, j)
+     *
+     * @pre test(i, j)
+     */
+    const W &weight(unsigned int i, unsigned int j) const
+    {
+        return _weights[i][find(i, j)];
+    };
+
+    /**
+     * @brief Pesi dei successori di index, nell'ordine di successors(index)
+     */
+    const W *weightRow(unsigned int index) const
+    {
+        return _weights[index].data();
+    };
+
+    /**
+     * @brief Chiama f(j, peso) per ogni successore j di index, in ordine
+     */
+    template <typename F>
+    void forEachWeightedSuccessor(unsigned int index, F f) const
+    {
+        const row_type &targets = *_lists.row(index);
+        const weight_row &weights = _weights[index];
+        for (size_t k = 0; k < targets.size(); k++)
+        {
+            f(targets[k], weights[k]);
+        }
+    };
+
+    void reserve(unsigned int capacity)
+    {
+        _weights.reserve(capacity);
+        _lists.reserve(capacity);
+    };
+
+    void shrink_to_fit()
+    {
+        _lists.shrink_to_fit();
+        _weights.shrink_to_fit();
+        for (size_t i = 0; i < _weights.size(); i++)
+        {
+            _weights[i].shrink_to_fit();
+        }
+    };
+
+    /**
+     * @brief Ridimensiona il numero di nodi, vedi sparse_adjacency::resize
+     */
+    void resize(unsigned int newSize)
+    {
+        for (unsigned int i = newSize; i < size(); i++)
+        {
+            clear(i);
+        }
+        _weights.resize(newSize, weight_row(get_allocator()));
+        _lists.resize(newSize);
+    };
+
+    /**
+     * @brief Toglie tutti gli archi entranti e uscenti da un nodo
+     *
+     * Non lancia eccezioni
+     */
+    void clear(unsigned int index)
+    {
+        // Tolgo i pesi degli archi entranti finché le liste li contengono
+        predecessor_range in = _lists.predecessors(index);
+        for (typename predecessor_range::iterator it = in.begin(); it != in.end(); ++it)
+        {
+            if (*it != index)
+            {
+                _weights[*it].erase(_weights[*it].begin() + find(*it, index));
+            }
+        }
+        weight_row(_weights[index].get_allocator()).swap(_weights[index]);
+        _lists.clear(index);
+    };
+
+    /**
+     * @brief Compatta i nodi, vedi sparse_adjacency::compact
+     *
+     * La rinumerazione conserva l'ordine dei successori, quindi i pesi
+     * seguono le righe senza cambiare posizione al loro interno
+     */
+    void compact(const unsigned int *remap, unsigned int newSize)
+    {
+        for (unsigned int i = 0; i < size(); i++)
+        {
+            if (remap[i] != discarded && remap[i] != i)
+            {
+                _weights[remap[i]].swap(_weights[i]);
+            }
+        }
+        _lists.compact(remap, newSize);
+        _weights.resize(newSize, weight_row(get_allocator()));
+    };
+
+    template <typename F>
+    void forEachSuccessor(unsigned int index, F f) const
+    {
+        _lists.forEachSuccessor(index, f);
+    };
+
+    successor_range successors(unsigned int index) const
+    {
+        return _lists.successors(index);
+    };
+
+    predecessor_range predecessors(unsigned int index) const
+    {
+        return _lists.predecessors(index);
+    };
+
+    /**
+     * @brief Archi invertiti, ognuno con il suo peso
+     *
+     * Scorrendo le origini in ordine i pesi di ogni nuova riga restano
+     * allineati ai predecessori, che sono ordinati. Costa O(N + E)
+     */
+    sparse_weights transpose() const
+    {
+        sparse_weights result(get_allocator());
+        lists_type lists = _lists.transpose();
+        weight_list weights(_weights.get_allocator());
+        weights.reserve(_weights.capacity());
+        weights.resize(size(), weight_row(get_allocator()));
+        for (unsigned int j = 0; j < size(); j++)
+        {
+            weights[j].reserve(_lists.inDegree(j));
+        }
+        for (unsigned int i = 0; i < size(); i++)
+        {
+            forEachWeightedSuccessor(i, [&weights](unsigned int j, const W &w) { weights[j].push_back(w); });
+        }
+        result._lists.swap(lists);
+        result._weights.swap(weights);
+        return result;
+    };
+
+    unsigned int outDegree(unsigned int index) const
+    {
+        return _lists.outDegree(index);
+    };
+
+    unsigned int inDegree(unsigned int index) const
+    {
+        return _lists.inDegree(index);
+    };
+
+    void commonSuccessors(unsigned int i, unsigned int j, std::vector<unsigned int> &out) const
+    {
+        _lists.commonSuccessors(i, j, out);
+    };
+
+private:
+    /**
+     * @brief Posizione di j tra i successori di i, o dove andrebbe inserito
+     */
+    size_t find(unsigned int i, unsigned int j) const
+    {
+        const row_type &targets = *_lists.row(i);
+        return std::lower_bound(targets.begin(), targets.end(), j) - targets.begin();
+    };
+};
+
+template <typename W, typename Allocator>
+const unsigned int sparse_weights<W, Allocator>::discarded;
+
+/**
+ * @brief true se la politica Storage ha un peso per arco
+ */
+template <typename Storage, typename Enable = void>
+struct has_edge_weights : std::false_type
+{
+};
+
+template <typename Storage>
+struct has_edge_weights<Storage, typename std::conditional<true, void, typename Storage::weight_type>::type>
+    : std::true_type
+{
+};
+
+/**
+ * @brief Tipo del peso degli archi di Storage, void se non ha pesi
+ *
+ * Usato da graph per scegliere il graph_journal
+ */
+template <typename Storage, typename Enable = void>
+struct edge_weight_of
+{
+    typedef void type;
+};
+
+template <typename Storage>
+struct edge_weight_of<Storage, typename std::conditional<true, void, typename Storage::weight_type>::type>
+{
+    typedef typename Storage::weight_type type;
+};
+
+template <typename To, typename From>
+void copyEdge(To &to, const From &from, unsigned int i, unsigned int j, std::true_type)
+{
+    to.set(i, j, static_cast<typename To::weight_type>(from.weight(i, j)));
+}
+
+template <typename To, typename From>
+void copyEdge(To &to, const From &, unsigned int i, unsigned int j, std::false_type)
+{
+    to.set(i, j);
+}
+
+/**
+ * @brief Copia l'arco (i, j) da from a to, con il peso se entrambe lo hanno
+ *
+ * Usata da graph per convertire gli archi tra politiche diverse
+ */
+template <typename To, typename From>
+void copyEdge(To &to, const From &from, unsigned int i, unsigned int j)
+{
+    copyEdge(to, from, i, j, std::integral_constant<bool, has_edge_weights<To>::value && has_edge_weights<From>::value>());
+}
+
+#endif